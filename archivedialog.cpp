@@ -0,0 +1,97 @@
+#include "archivedialog.h"
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QVBoxLayout>
+
+namespace {
+const int SearchDelay = 200; //ms after the last key before the file is scanned again
+}
+
+ArchiveDialog::ArchiveDialog(const QString &fileName, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Archive");
+    resize(640, 480);
+
+    m_model = new ArchiveModel(fileName, this);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search the archive");
+    m_searchEdit->setClearButtonEnabled(true);
+    layout->addWidget(m_searchEdit);
+
+    m_view = new QTableView(this);
+    m_view->setModel(m_model);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setWordWrap(false);
+    m_view->verticalHeader()->hide();
+    //fixed row heights, so scrolling never measures rows that are not shown
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->horizontalHeader()->setSectionResizeMode(ArchiveModel::TextColumn, QHeaderView::Stretch);
+    m_view->horizontalHeader()->setSectionResizeMode(ArchiveModel::BoardColumnColumn, QHeaderView::Interactive);
+    m_view->horizontalHeader()->setSectionResizeMode(ArchiveModel::ArchivedColumn, QHeaderView::ResizeToContents);
+    layout->addWidget(m_view, 1);
+
+    m_countLabel = new QLabel(this);
+    m_countLabel->setForegroundRole(QPalette::PlaceholderText);
+    layout->addWidget(m_countLabel);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_restoreButton = buttons->addButton("&Restore", QDialogButtonBox::ActionRole);
+    layout->addWidget(buttons);
+
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(SearchDelay);
+    connect(m_searchEdit, &QLineEdit::textChanged, &m_searchTimer, qOverload<>(&QTimer::start));
+    connect(&m_searchTimer, &QTimer::timeout, this, [this]() {
+        m_countLabel->setText("Searching...");
+        m_model->setSearchText(m_searchEdit->text());
+    });
+    connect(m_model, &ArchiveModel::scanned, this, &ArchiveDialog::onScanned);
+    connect(m_view->selectionModel(), &QItemSelectionModel::selectionChanged, this, &ArchiveDialog::updateButtons);
+    connect(m_model, &ArchiveModel::modelReset, this, &ArchiveDialog::updateButtons);
+    connect(m_view, &QTableView::doubleClicked, this, &ArchiveDialog::onRestore);
+    connect(m_restoreButton, &QPushButton::clicked, this, &ArchiveDialog::onRestore);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::close);
+
+    m_countLabel->setText("Reading the archive...");
+    updateButtons();
+}
+
+void ArchiveDialog::refresh()
+{
+    m_model->refresh();
+}
+
+void ArchiveDialog::onScanned()
+{
+    const int count = m_model->totalCount();
+    if (count == 0) {
+        m_countLabel->setText(m_searchEdit->text().isEmpty() ? QString("Nothing archived yet") : QString("No archived todo matches"));
+    } else {
+        m_countLabel->setText(QString("%1 archived todos").arg(count));
+    }
+}
+
+void ArchiveDialog::onRestore()
+{
+    QList<int> rows;
+    for (const QModelIndex &index : m_view->selectionModel()->selectedRows()) {
+        rows.append(index.row());
+    }
+    std::sort(rows.begin(), rows.end());
+    const QList<ArchivedTodo> todos = m_model->todos(rows);
+    if (!todos.isEmpty()) {
+        emit restoreRequested(todos);
+    }
+}
+
+void ArchiveDialog::updateButtons()
+{
+    m_restoreButton->setEnabled(m_view->selectionModel()->hasSelection());
+}
@@ -0,0 +1,41 @@
+#ifndef ARCHIVEDIALOG_H
+#define ARCHIVEDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableView>
+#include <QTimer>
+#include "archivemodel.h"
+
+//browses the archive of the open board and hands selected todos back to it;
+//not modal, the board stays usable while it is open
+class ArchiveDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ArchiveDialog(const QString &fileName, QWidget *parent = nullptr);
+
+    //after todos were archived or restored
+    void refresh();
+
+signals:
+    void restoreRequested(const QList<ArchivedTodo> &todos);
+
+private slots:
+    void onScanned();
+    void onRestore();
+    void updateButtons();
+
+private:
+    ArchiveModel *m_model;
+    QLineEdit *m_searchEdit;
+    QTableView *m_view;
+    QLabel *m_countLabel;
+    QPushButton *m_restoreButton;
+    QTimer m_searchTimer;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "archivemodel.h"
+#include <QDateTime>
+#include <QLocale>
+#include "tracer.h"
+
+namespace {
+const int PageSize = 200; //read per fetchMore, a few screens of rows
+}
+
+ArchiveModel::ArchiveModel(const QString &fileName, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_archive(fileName)
+{
+    scan();
+}
+
+ArchiveModel::~ArchiveModel()
+{
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+int ArchiveModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_todos.size();
+}
+
+int ArchiveModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ArchiveModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_todos.size()) {
+        return QVariant();
+    }
+
+    const ArchivedTodo &todo = m_todos.at(index.row());
+    switch (index.column()) {
+    case TextColumn:
+        if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
+            return todo.item.text;
+        }
+        if (role == Qt::CheckStateRole) {
+            return todo.item.checked ? Qt::Checked : Qt::Unchecked;
+        }
+        break;
+    case BoardColumnColumn:
+        if (role == Qt::DisplayRole) {
+            return todo.column;
+        }
+        break;
+    case ArchivedColumn:
+        if (role == Qt::DisplayRole) {
+            return QLocale().toString(QDateTime::fromMSecsSinceEpoch(todo.archivedAt), QLocale::ShortFormat);
+        }
+        break;
+    }
+    return QVariant();
+}
+
+QVariant ArchiveModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case TextColumn:
+        return QString("Todo");
+    case BoardColumnColumn:
+        return QString("Column");
+    case ArchivedColumn:
+        return QString("Archived");
+    }
+    return QVariant();
+}
+
+bool ArchiveModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_todos.size() < m_offsets.size();
+}
+
+void ArchiveModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    TRACE_SPAN("read archive page");
+    //seeks straight to each record, the rest of the file is not touched
+    const QList<ArchivedTodo> page = m_archive.read(m_offsets.mid(m_todos.size(), PageSize));
+    if (page.isEmpty()) {
+        m_offsets.resize(m_todos.size()); //the file changed under us, wait for the next scan
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_todos.size(), m_todos.size() + page.size() - 1);
+    m_todos.append(page);
+    endInsertRows();
+}
+
+void ArchiveModel::setSearchText(const QString &text)
+{
+    if (text == m_searchText) {
+        return;
+    }
+    m_searchText = text;
+    scan();
+}
+
+void ArchiveModel::refresh()
+{
+    scan();
+}
+
+int ArchiveModel::totalCount() const
+{
+    return m_offsets.size();
+}
+
+bool ArchiveModel::isScanning() const
+{
+    return m_thread != nullptr;
+}
+
+QList<ArchivedTodo> ArchiveModel::todos(const QList<int> &rows) const
+{
+    QList<ArchivedTodo> result;
+    for (int row : rows) {
+        if (row >= 0 && row < m_todos.size()) {
+            result.append(m_todos.at(row));
+        }
+    }
+    return result;
+}
+
+void ArchiveModel::scan()
+{
+    if (m_thread) {
+        m_rescan = true; //the search changed while reading, the result is outdated already
+        return;
+    }
+    m_rescan = false;
+
+    const BoardArchive archive = m_archive;
+    const QString search = m_searchText;
+    m_thread = QThread::create([this, archive, search]() {
+        TRACE_SPAN("scan archive");
+        m_scanned = archive.entries(search);
+    });
+    m_thread->setObjectName("ArchiveScan");
+    connect(m_thread, &QThread::finished, this, &ArchiveModel::onScanned);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+    m_thread->start();
+}
+
+void ArchiveModel::onScanned()
+{
+    m_thread = nullptr;
+    if (m_rescan) {
+        scan();
+        return;
+    }
+
+    beginResetModel();
+    m_offsets = m_scanned;
+    m_scanned.clear();
+    m_todos.clear();
+    endResetModel();
+    fetchMore(QModelIndex()); //the first page, the view asks for more as it scrolls
+    emit scanned();
+}
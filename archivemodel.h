@@ -0,0 +1,62 @@
+#ifndef ARCHIVEMODEL_H
+#define ARCHIVEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QThread>
+#include "boardarchive.h"
+
+//the archive of one board as a table; the file is scanned off the GUI thread and
+//todos are read a page at a time as the view scrolls, so a big archive costs
+//nothing until somebody looks at it
+class ArchiveModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Columns
+    {
+        TextColumn,
+        BoardColumnColumn, //the board column it was in
+        ArchivedColumn,
+        ColumnCount
+    };
+
+    explicit ArchiveModel(const QString &fileName, QObject *parent = nullptr);
+    ~ArchiveModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    //only todos whose text contains text, rescans the file
+    void setSearchText(const QString &text);
+    //scans again after the archive was written
+    void refresh();
+
+    //todos matching the search, fetched or not
+    int totalCount() const;
+    bool isScanning() const;
+    QList<ArchivedTodo> todos(const QList<int> &rows) const;
+
+signals:
+    void scanned();
+
+private slots:
+    void onScanned();
+
+private:
+    void scan();
+
+    BoardArchive m_archive;
+    QString m_searchText;
+    QList<qint64> m_offsets; //every match, newest first
+    QList<ArchivedTodo> m_todos; //the ones read so far
+    QThread *m_thread = nullptr;
+    QList<qint64> m_scanned; //written by the thread
+    bool m_rescan = false;
+};
+
+#endif
@@ -0,0 +1,14 @@
+QT += widgets testlib
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = benchmarks
+TEMPLATE = app
+
+include(../frostwilldo.pri)
+
+SOURCES += boardbenchmark.cpp \
+           boardgenerator.cpp
+
+HEADERS += boardgenerator.h
@@ -0,0 +1,387 @@
+#include <QtTest>
+#include <QApplication>
+#include <QTemporaryDir>
+#include "boardgenerator.h"
+#include "boardmodel.h"
+#include "boardstorage.h"
+#include "binaryboardformat.h"
+#include "todocolumn.h"
+#include "todoitemdelegate.h"
+#include "todolistview.h"
+#include "timerwheel.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+//timings of the paths users feel on big boards, run it with -o results.xml,xml
+//(or csv, junitxml) and compare the files between commits
+class BoardBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void load_data();
+    void load();
+    void save_data();
+    void save();
+
+    void insertItems_data();
+    void insertItems();
+    void insertItemsBatch_data();
+    void insertItemsBatch();
+    void removeItems_data();
+    void removeItems();
+    void moveItems_data();
+    void moveItems();
+
+    void dropIndex_data();
+    void dropIndex();
+    void relayout_data();
+    void relayout();
+
+    void scheduleReminders_data();
+    void scheduleReminders();
+
+    //runs last so it reports the peak of the whole suite
+    void peakRss();
+
+private:
+    QString boardFile(int columns, int items, const char *suffix);
+
+    QTemporaryDir m_dir;
+};
+
+namespace {
+BoardGeneratorOptions optionsFor(int columns, int items)
+{
+    BoardGeneratorOptions options;
+    options.columns = columns;
+    options.itemsPerColumn = items;
+    return options;
+}
+
+//columns x items of the boards loaded and saved
+QList<QPair<int, int>> boardSizes()
+{
+    QList<QPair<int, int>> sizes = {{3, 100}, {5, 2000}, {10, 10000}};
+
+    //FWD_BENCH_BOARD=20x50000 adds a board of your own
+    const QList<QByteArray> custom = qgetenv("FWD_BENCH_BOARD").split('x');
+    if (custom.size() == 2 && custom.at(0).toInt() > 0 && custom.at(1).toInt() > 0) {
+        sizes.append({custom.at(0).toInt(), custom.at(1).toInt()});
+    }
+    return sizes;
+}
+
+QList<TodoItem> makeItems(int count)
+{
+    return BoardGenerator::generate(optionsFor(1, count)).columns.first().items;
+}
+
+//board with a shown column widget on it, the way the window has it
+struct ShownColumn
+{
+    explicit ShownColumn(int items)
+    {
+        BoardData data = BoardGenerator::generate(optionsFor(2, items));
+        model.setBoardData(data);
+        column = new TodoColumn(&filter, model.boardColumnIndex(0));
+        column->resize(300, 800);
+        column->show();
+    }
+    ~ShownColumn()
+    {
+        delete column;
+    }
+
+    BoardModel model;
+    BoardFilterModel filter{&model};
+    TodoColumn *column;
+};
+}
+
+void BoardBenchmark::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+QString BoardBenchmark::boardFile(int columns, int items, const char *suffix)
+{
+    QString fileName = m_dir.filePath(QString("board-%1x%2.%3").arg(columns).arg(items).arg(suffix));
+    if (!QFile::exists(fileName)) {
+        BoardStorage::writeSnapshotFile(fileName, BoardGenerator::generate(optionsFor(columns, items)));
+    }
+    return fileName;
+}
+
+void BoardBenchmark::load_data()
+{
+    QTest::addColumn<int>("columns");
+    QTest::addColumn<int>("items");
+    QTest::addColumn<QString>("suffix");
+
+    const char *const suffixes[] = {"json", BinaryBoardFormat::fileSuffix()};
+    for (const QPair<int, int> &size : boardSizes()) {
+        for (const char *suffix : suffixes) {
+            QTest::addRow("%dx%d-%s", size.first, size.second, suffix) << size.first << size.second << QString(suffix);
+        }
+    }
+}
+
+void BoardBenchmark::load()
+{
+    QFETCH(int, columns);
+    QFETCH(int, items);
+    QFETCH(QString, suffix);
+
+    BoardStorage storage(boardFile(columns, items, qPrintable(suffix)));
+    QBENCHMARK {
+        BoardModel model;
+        model.setBoardData(storage.load());
+    }
+}
+
+void BoardBenchmark::save_data()
+{
+    load_data();
+}
+
+void BoardBenchmark::save()
+{
+    QFETCH(int, columns);
+    QFETCH(int, items);
+    QFETCH(QString, suffix);
+
+    BoardModel model;
+    model.setBoardData(BoardGenerator::generate(optionsFor(columns, items)));
+    const QString fileName = m_dir.filePath("save." + suffix);
+    QBENCHMARK {
+        QVERIFY(BoardStorage::writeSnapshotFile(fileName, model.boardData()) > 0);
+    }
+}
+
+void BoardBenchmark::insertItems_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void BoardBenchmark::insertItems()
+{
+    QFETCH(int, count);
+
+    ShownColumn board(0);
+    const QList<TodoItem> items = makeItems(count);
+    QBENCHMARK_ONCE {
+        for (const TodoItem &item : items) {
+            board.column->addTodoItem(item);
+        }
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(board.column->todoCount(), count);
+}
+
+void BoardBenchmark::insertItemsBatch_data()
+{
+    insertItems_data();
+}
+
+void BoardBenchmark::insertItemsBatch()
+{
+    QFETCH(int, count);
+
+    ShownColumn board(0);
+    const QList<TodoItem> items = makeItems(count);
+    QBENCHMARK_ONCE {
+        //one rowsInserted for the whole batch, the way imports and restores go in
+        board.model.insertItems(0, board.model.itemCount(0), items);
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(board.column->todoCount(), count);
+}
+
+void BoardBenchmark::removeItems_data()
+{
+    insertItems_data();
+}
+
+void BoardBenchmark::removeItems()
+{
+    QFETCH(int, count);
+
+    ShownColumn board(count);
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < count; ++i) {
+            board.column->removeTodoItem(0);
+        }
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(board.column->todoCount(), 0);
+}
+
+void BoardBenchmark::moveItems_data()
+{
+    insertItems_data();
+}
+
+void BoardBenchmark::moveItems()
+{
+    QFETCH(int, count);
+
+    ShownColumn board(count);
+    QBENCHMARK_ONCE {
+        //one at a time, the way drag and drop does it
+        for (int i = 0; i < count; ++i) {
+            board.model.moveItem(0, 0, 1, board.model.itemCount(1));
+        }
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(board.model.itemCount(1), 2 * count);
+}
+
+void BoardBenchmark::dropIndex_data()
+{
+    insertItems_data();
+}
+
+void BoardBenchmark::dropIndex()
+{
+    QFETCH(int, count);
+
+    ShownColumn board(count);
+    QCoreApplication::processEvents();
+
+    //a drag sweeping over the whole column
+    int sum = 0;
+    QBENCHMARK {
+        for (int y = 0; y < board.column->height(); y += 4) {
+            sum += board.column->getDropIndex(QPoint(150, y));
+        }
+    }
+    QVERIFY(sum >= 0);
+}
+
+void BoardBenchmark::relayout_data()
+{
+    insertItems_data();
+}
+
+void BoardBenchmark::relayout()
+{
+    QFETCH(int, count);
+
+    BoardModel model;
+    model.setBoardData(BoardGenerator::generate(optionsFor(1, count)));
+    TodoListView view;
+    TodoItemDelegate delegate(&view);
+    view.setItemDelegate(&delegate);
+    view.setModel(&model);
+    view.setRootIndex(model.boardColumnIndex(0));
+    view.setLayoutMode(QListView::SinglePass); //measure the full pass, not the first batch
+    view.resize(284, 800);
+    view.show();
+    QCoreApplication::processEvents();
+
+    //every width change rewraps every todo
+    int width = 284;
+    QBENCHMARK {
+        width = width == 284 ? 260 : 284;
+        view.resize(width, 800);
+        view.doItemsLayout();
+    }
+}
+
+void BoardBenchmark::scheduleReminders_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void BoardBenchmark::scheduleReminders()
+{
+    QFETCH(int, count);
+
+    //reminders spread over a year, half of them cancelled, then the year goes by a day at a time
+    const qint64 day = 24 * 3600 * 1000;
+    int fired = 0;
+    QBENCHMARK {
+        TimerWheel wheel(0);
+        for (int i = 0; i < count; ++i) {
+            wheel.schedule(quint64(i), (qint64(i) * 7919 % 365) * day + i % 86400 * 1000);
+        }
+        for (int i = 0; i < count; i += 2) {
+            wheel.cancel(quint64(i));
+        }
+        fired = 0;
+        for (qint64 now = 0; now <= 366 * day; now += day) {
+            fired += wheel.advance(now).size();
+        }
+    }
+    QCOMPARE(fired, count / 2);
+}
+
+void BoardBenchmark::peakRss()
+{
+#ifdef Q_OS_UNIX
+    rusage usage;
+    QCOMPARE(getrusage(RUSAGE_SELF, &usage), 0);
+#ifdef Q_OS_MACOS
+    const qreal bytes = usage.ru_maxrss;
+#else
+    const qreal bytes = usage.ru_maxrss * 1024.0;
+#endif
+    QTest::setBenchmarkResult(bytes, QTest::BytesAllocated);
+#else
+    QSKIP("peak RSS is only read on unix");
+#endif
+}
+
+//"benchmarks --generate <file> [columns] [items] [min length] [max length] [seed]"
+//writes a synthetic board, in binary when the file ends in .fwdb
+static int generate(const QStringList &args)
+{
+    if (args.size() < 3) {
+        qWarning("usage: %s --generate <file> [columns] [items] [min length] [max length] [seed]", qPrintable(args.value(0)));
+        return 2;
+    }
+
+    BoardGeneratorOptions options;
+    options.columns = args.value(3, "3").toInt();
+    options.itemsPerColumn = args.value(4, "100").toInt();
+    options.minTextLength = args.value(5, QString::number(options.minTextLength)).toInt();
+    options.maxTextLength = args.value(6, QString::number(options.maxTextLength)).toInt();
+    options.seed = args.value(7, "1").toUInt();
+
+    QString error;
+    if (BoardStorage::writeSnapshotFile(args.at(2), BoardGenerator::generate(options), &error) < 0) {
+        qWarning("%s", qPrintable(error));
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    //no window system needed, widgets render into memory
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.value(1) == "--generate") {
+        return generate(args);
+    }
+
+    BoardBenchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "boardbenchmark.moc"
@@ -0,0 +1,50 @@
+#include "boardgenerator.h"
+#include <QRandomGenerator>
+
+namespace {
+const char *const Words[] = {
+    "fix", "the", "login", "page", "review", "pull", "request", "for", "storage",
+    "write", "release", "notes", "call", "about", "invoice", "buy", "milk", "and",
+    "update", "dependencies", "check", "crash", "report", "on", "startup", "plan",
+    "sprint", "meeting", "refactor", "column", "drag", "drop", "handling"
+};
+const int WordCount = sizeof(Words) / sizeof(Words[0]);
+
+QString makeText(QRandomGenerator &random, int length)
+{
+    QString text;
+    text.reserve(length + 16);
+    while (text.size() < length) {
+        if (!text.isEmpty()) {
+            text += QLatin1Char(' ');
+        }
+        text += QLatin1String(Words[random.bounded(WordCount)]);
+    }
+    text.truncate(length);
+    return text;
+}
+}
+
+BoardData BoardGenerator::generate(const BoardGeneratorOptions &options)
+{
+    QRandomGenerator random(options.seed);
+
+    BoardData data;
+    data.columns.reserve(options.columns);
+    for (int c = 0; c < options.columns; ++c) {
+        BoardColumnData column;
+        column.title = QString("Column %1").arg(c + 1);
+        column.items.reserve(options.itemsPerColumn);
+        for (int i = 0; i < options.itemsPerColumn; ++i) {
+            int length = random.generateDouble() < options.longTextRatio
+                ? options.longTextLength
+                : options.minTextLength + random.bounded(qMax(1, options.maxTextLength - options.minTextLength + 1));
+            TodoItem item;
+            item.text = makeText(random, qMax(1, length));
+            item.checked = random.generateDouble() < options.checkedRatio;
+            column.items.append(item);
+        }
+        data.columns.append(column);
+    }
+    return data;
+}
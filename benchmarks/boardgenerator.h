@@ -0,0 +1,25 @@
+#ifndef BOARDGENERATOR_H
+#define BOARDGENERATOR_H
+
+#include "boarddata.h"
+
+//shape of a synthetic board, the same options and seed always give the same board
+struct BoardGeneratorOptions
+{
+    int columns = 3;
+    int itemsPerColumn = 100;
+    int minTextLength = 8;   //most todos are short one liners...
+    int maxTextLength = 60;
+    double longTextRatio = 0.05; //...a few are notes several lines long
+    int longTextLength = 600;
+    double checkedRatio = 0.3;
+    quint32 seed = 1;
+};
+
+class BoardGenerator
+{
+public:
+    static BoardData generate(const BoardGeneratorOptions &options);
+};
+
+#endif
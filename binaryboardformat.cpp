@@ -0,0 +1,286 @@
+#include "binaryboardformat.h"
+#include <QHash>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const char Magic[4] = {'F', 'W', 'D', 'B'};
+const quint32 FormatVersion = 1;
+const int HeaderSize = 48;
+const int ColumnEntrySize = 16;
+const int ItemEntrySize = 48;
+const quint32 CheckedFlag = 0x1;
+
+quint32 readU32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+//appends text to the pool and returns its offset in code units
+quint32 appendString(QByteArray &pool, const QString &text)
+{
+    quint32 offset = quint32(pool.size() / 2);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    pool.append(reinterpret_cast<const char*>(text.constData()), text.size() * 2);
+#else
+    for (QChar c : text) {
+        char unit[2];
+        qToLittleEndian<quint16>(c.unicode(), unit);
+        pool.append(unit, 2);
+    }
+#endif
+    return offset;
+}
+}
+
+const char *BinaryBoardFormat::fileSuffix()
+{
+    return "fwdb";
+}
+
+QByteArray BinaryBoardFormat::serialize(const BoardData &data)
+{
+    quint32 itemTotal = 0;
+    for (const BoardColumnData &column : data.columns) {
+        itemTotal += column.items.size();
+    }
+
+    const quint32 columnTableOffset = HeaderSize;
+    const quint32 itemTableOffset = columnTableOffset + data.columns.size() * ColumnEntrySize;
+    const quint32 poolOffset = itemTableOffset + itemTotal * ItemEntrySize;
+
+    QByteArray out(poolOffset, '\0');
+    QByteArray pool;
+    //repeated todos point at the same code units, the entries carry their own length
+    QHash<QString, quint32> pooled;
+    uchar *base = reinterpret_cast<uchar*>(out.data());
+
+    quint32 firstItem = 0;
+    uchar *itemEntry = base + itemTableOffset;
+    for (int c = 0; c < data.columns.size(); ++c) {
+        const BoardColumnData &column = data.columns.at(c);
+        uchar *columnEntry = base + columnTableOffset + c * ColumnEntrySize;
+        qToLittleEndian<quint32>(appendString(pool, column.title), columnEntry);
+        qToLittleEndian<quint32>(column.title.size(), columnEntry + 4);
+        qToLittleEndian<quint32>(firstItem, columnEntry + 8);
+        qToLittleEndian<quint32>(column.items.size(), columnEntry + 12);
+
+        for (const TodoItem &item : column.items) {
+            auto it = pooled.constFind(item.text);
+            if (it == pooled.constEnd()) {
+                it = pooled.insert(item.text, appendString(pool, item.text));
+            }
+            qToLittleEndian<quint32>(*it, itemEntry);
+            qToLittleEndian<quint32>(item.text.size(), itemEntry + 4);
+            qToLittleEndian<quint32>(item.checked ? CheckedFlag : 0, itemEntry + 8);
+            qToLittleEndian<quint64>(item.id, itemEntry + 12);
+            qToLittleEndian<qint64>(item.checkedAt, itemEntry + 20);
+            qToLittleEndian<qint64>(item.dueAt, itemEntry + 28);
+            qToLittleEndian<qint64>(item.remindAt, itemEntry + 36);
+            qToLittleEndian<qint32>(item.repeatMinutes, itemEntry + 44);
+            itemEntry += ItemEntrySize;
+        }
+        firstItem += column.items.size();
+    }
+
+    std::memcpy(base, Magic, sizeof(Magic));
+    qToLittleEndian<quint32>(FormatVersion, base + 4);
+    qToLittleEndian<quint64>(data.sequence, base + 8);
+    qToLittleEndian<quint32>(data.columns.size(), base + 16);
+    qToLittleEndian<quint32>(itemTotal, base + 20);
+    qToLittleEndian<quint32>(columnTableOffset, base + 24);
+    qToLittleEndian<quint32>(itemTableOffset, base + 28);
+    qToLittleEndian<quint32>(poolOffset, base + 32);
+    qToLittleEndian<quint32>(pool.size(), base + 36);
+    qToLittleEndian<quint64>(data.stamp, base + 40);
+
+    out.append(pool);
+    return out;
+}
+
+bool BinaryBoardReader::open(const QString &fileName)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size < HeaderSize) {
+        m_errorString = "File is too small to be a board";
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    //a mapped file can not be replaced on Windows, which would block saving
+    m_buffer = m_file.readAll();
+    m_data = reinterpret_cast<const uchar*>(m_buffer.constData());
+    m_file.close();
+#else
+    //the mapping goes away together with m_file
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+#endif
+
+    if (std::memcmp(m_data, Magic, sizeof(Magic)) != 0) {
+        m_errorString = "Not a FrostWillDo board";
+        return false;
+    }
+    const quint32 version = readU32(m_data + 4);
+    if (version != FormatVersion) {
+        m_errorString = QString("Unsupported board version %1").arg(version);
+        return false;
+    }
+
+    m_sequence = qFromLittleEndian<quint64>(m_data + 8);
+    m_columnCount = readU32(m_data + 16);
+    m_itemCount = readU32(m_data + 20);
+    m_columnTableOffset = readU32(m_data + 24);
+    m_itemTableOffset = readU32(m_data + 28);
+    m_poolOffset = readU32(m_data + 32);
+    m_poolSize = readU32(m_data + 36);
+    m_stamp = qFromLittleEndian<quint64>(m_data + 40);
+
+    if (qint64(m_columnTableOffset) + qint64(m_columnCount) * ColumnEntrySize > m_size
+        || qint64(m_itemTableOffset) + qint64(m_itemCount) * ItemEntrySize > m_size
+        || qint64(m_poolOffset) + m_poolSize > m_size) {
+        m_errorString = "Board file is truncated";
+        return false;
+    }
+    for (quint32 c = 0; c < m_columnCount; ++c) {
+        const uchar *entry = columnEntry(c);
+        if (qint64(readU32(entry + 8)) + readU32(entry + 12) > m_itemCount) {
+            m_errorString = "Board file is corrupt";
+            return false;
+        }
+    }
+    return true;
+}
+
+QString BinaryBoardReader::errorString() const
+{
+    return m_errorString;
+}
+
+quint64 BinaryBoardReader::sequence() const
+{
+    return m_sequence;
+}
+
+quint64 BinaryBoardReader::stamp() const
+{
+    return m_stamp;
+}
+
+int BinaryBoardReader::columnCount() const
+{
+    return m_columnCount;
+}
+
+QString BinaryBoardReader::columnTitle(int column) const
+{
+    return string(columnEntry(column));
+}
+
+int BinaryBoardReader::itemCount(int column) const
+{
+    return readU32(columnEntry(column) + 12);
+}
+
+QString BinaryBoardReader::itemText(int column, int row) const
+{
+    return string(itemEntry(column, row));
+}
+
+bool BinaryBoardReader::isItemChecked(int column, int row) const
+{
+    return readU32(itemEntry(column, row) + 8) & CheckedFlag;
+}
+
+quint64 BinaryBoardReader::itemId(int column, int row) const
+{
+    return qFromLittleEndian<quint64>(itemEntry(column, row) + 12);
+}
+
+qint64 BinaryBoardReader::itemCheckedAt(int column, int row) const
+{
+    return qFromLittleEndian<qint64>(itemEntry(column, row) + 20);
+}
+
+qint64 BinaryBoardReader::itemDueAt(int column, int row) const
+{
+    return qFromLittleEndian<qint64>(itemEntry(column, row) + 28);
+}
+
+qint64 BinaryBoardReader::itemRemindAt(int column, int row) const
+{
+    return qFromLittleEndian<qint64>(itemEntry(column, row) + 36);
+}
+
+int BinaryBoardReader::itemRepeatMinutes(int column, int row) const
+{
+    return qFromLittleEndian<qint32>(itemEntry(column, row) + 44);
+}
+
+const uchar *BinaryBoardReader::columnEntry(int column) const
+{
+    return m_data + m_columnTableOffset + column * ColumnEntrySize;
+}
+
+const uchar *BinaryBoardReader::itemEntry(int column, int row) const
+{
+    quint32 firstItem = readU32(columnEntry(column) + 8);
+    return m_data + m_itemTableOffset + qint64(firstItem + row) * ItemEntrySize;
+}
+
+QString BinaryBoardReader::string(const uchar *entry) const
+{
+    quint32 offset = readU32(entry);
+    quint32 length = readU32(entry + 4);
+    if (qint64(offset) + length > m_poolSize / 2) {
+        return QString();
+    }
+
+    const uchar *units = m_data + m_poolOffset + qint64(offset) * 2;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    return QString(reinterpret_cast<const QChar*>(units), length);
+#else
+    QString text(length, Qt::Uninitialized);
+    for (quint32 i = 0; i < length; ++i) {
+        text[i] = QChar(qFromLittleEndian<quint16>(units + i * 2));
+    }
+    return text;
+#endif
+}
+
+BoardData BinaryBoardReader::toBoardData() const
+{
+    BoardData data;
+    data.sequence = sequence();
+    data.stamp = stamp();
+    data.columns.reserve(columnCount());
+
+    for (int c = 0; c < columnCount(); ++c) {
+        BoardColumnData column;
+        column.title = columnTitle(c);
+        int count = itemCount(c);
+        column.items.reserve(count);
+        for (int row = 0; row < count; ++row) {
+            TodoItem item;
+            item.text = itemText(c, row);
+            item.checked = isItemChecked(c, row);
+            item.id = itemId(c, row);
+            item.checkedAt = itemCheckedAt(c, row);
+            item.dueAt = itemDueAt(c, row);
+            item.remindAt = itemRemindAt(c, row);
+            item.repeatMinutes = itemRepeatMinutes(c, row);
+            column.items.append(item);
+        }
+        data.columns.append(column);
+    }
+    return data;
+}
@@ -0,0 +1,69 @@
+#ifndef BINARYBOARDFORMAT_H
+#define BINARYBOARDFORMAT_H
+
+#include <QFile>
+#include "boarddata.h"
+
+//versioned binary board file, all integers little endian:
+//
+//  header        magic "FWDB", version, sequence, column count, item count,
+//                offsets of the column table, item table and string pool, pool size,
+//                stamp
+//  column table  per column: title offset, title length, first item, item count
+//  item table    per item: text offset, text length, flags, id, time it was checked,
+//                due time, time of the next reminder, minutes between reminders
+//  string pool   UTF-16 code units, offsets and lengths above count code units,
+//                todos with the same text point at the same units
+class BinaryBoardFormat
+{
+public:
+    static const char *fileSuffix();
+    static QByteArray serialize(const BoardData &data);
+};
+
+//reads a binary board through a memory map, only the pages of the header and
+//tables are touched on open and text is decoded when somebody asks for it
+class BinaryBoardReader
+{
+public:
+    bool open(const QString &fileName);
+    QString errorString() const;
+
+    quint64 sequence() const;
+    quint64 stamp() const;
+    int columnCount() const;
+    QString columnTitle(int column) const;
+    int itemCount(int column) const;
+    QString itemText(int column, int row) const;
+    bool isItemChecked(int column, int row) const;
+    quint64 itemId(int column, int row) const;
+    qint64 itemCheckedAt(int column, int row) const;
+    qint64 itemDueAt(int column, int row) const;
+    qint64 itemRemindAt(int column, int row) const;
+    int itemRepeatMinutes(int column, int row) const;
+
+    //the texts are copied, the result outlives the reader
+    BoardData toBoardData() const;
+
+private:
+    const uchar *columnEntry(int column) const;
+    const uchar *itemEntry(int column, int row) const;
+    QString string(const uchar *entry) const;
+
+    QFile m_file;
+    QByteArray m_buffer; //used instead of a mapping where the file has to stay replaceable
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    QString m_errorString;
+
+    quint64 m_sequence = 0;
+    quint64 m_stamp = 0;
+    quint32 m_columnCount = 0;
+    quint32 m_itemCount = 0;
+    quint32 m_columnTableOffset = 0;
+    quint32 m_itemTableOffset = 0;
+    quint32 m_poolOffset = 0;
+    quint32 m_poolSize = 0;
+};
+
+#endif
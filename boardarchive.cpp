@@ -0,0 +1,270 @@
+#include "boardarchive.h"
+#include "boardmodel.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QSet>
+
+namespace {
+const char ArchiveMagic[4] = {'F', 'W', 'D', 'A'};
+const quint32 ArchiveVersion = 1;
+const int HeaderSize = 8;       //magic + version
+const int RecordHeaderSize = 6; //payload size + checksum
+
+enum Kind : quint8 {
+    Archived = 1,
+    Restored
+};
+
+QByteArray fileHeader()
+{
+    QByteArray header(ArchiveMagic, sizeof(ArchiveMagic));
+    QDataStream out(&header, QIODevice::Append);
+    out << ArchiveVersion;
+    return header;
+}
+
+//record at the current position of file, false at the end or at a damaged tail
+bool readRecord(QFile &file, QByteArray *payload)
+{
+    const QByteArray head = file.read(RecordHeaderSize);
+    if (head.size() < RecordHeaderSize) {
+        return false;
+    }
+    quint32 size;
+    quint16 checksum;
+    QDataStream(head) >> size >> checksum;
+    *payload = file.read(size);
+    return payload->size() == qint64(size) && qChecksum(*payload) == checksum;
+}
+
+//end of the last complete record, only the record headers are read
+qint64 validSize(QFile &file)
+{
+    qint64 offset = HeaderSize;
+    while (file.seek(offset)) {
+        const QByteArray head = file.read(RecordHeaderSize);
+        if (head.size() < RecordHeaderSize) {
+            break;
+        }
+        quint32 size;
+        QDataStream(head) >> size;
+        if (offset + RecordHeaderSize + qint64(size) > file.size()) {
+            break; //torn write at the end of the file
+        }
+        offset += RecordHeaderSize + size;
+    }
+    return offset;
+}
+}
+
+BoardArchive::BoardArchive(const QString &fileName)
+    : m_fileName(fileName)
+{
+}
+
+QString BoardArchive::fileName() const
+{
+    return m_fileName;
+}
+
+QString BoardArchive::errorString() const
+{
+    return m_errorString;
+}
+
+int BoardArchive::archive(BoardModel *model, const std::function<bool(int column, int row, const TodoItem &item)> &pick)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<QByteArray> payloads;
+    QList<QList<int>> picked(model->boardColumnCount());
+    for (int c = 0; c < model->boardColumnCount(); ++c) {
+        const QString title = model->boardColumnTitle(c);
+        const QList<TodoItem> items = model->items(c);
+        for (int row = 0; row < items.size(); ++row) {
+            const TodoItem &item = items.at(row);
+            if (!pick(c, row, item)) {
+                continue;
+            }
+            QByteArray payload;
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_0);
+            out << quint8(Archived) << now << title << item.text << item.checked << item.id << item.checkedAt
+                << item.dueAt << item.repeatMinutes;
+            payloads.append(payload);
+            picked[c].append(row);
+        }
+    }
+    if (payloads.isEmpty()) {
+        return 0;
+    }
+    if (!append(payloads)) {
+        return -1;
+    }
+
+    //one notification per run of todos, and one journal write for all of them
+    model->beginBatch();
+    for (int c = 0; c < picked.size(); ++c) {
+        if (!picked.at(c).isEmpty()) {
+            model->removeItems(c, picked.at(c));
+        }
+    }
+    model->endBatch();
+    return payloads.size();
+}
+
+bool BoardArchive::restore(BoardModel *model, const QList<ArchivedTodo> &todos)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    //one insert per column, in the order they were given
+    QStringList titles;
+    QHash<QString, QList<TodoItem>> items;
+    for (const ArchivedTodo &todo : todos) {
+        if (!items.contains(todo.column)) {
+            titles.append(todo.column);
+        }
+        TodoItem item = todo.item;
+        item.id = 0; //a new todo may have taken the old id meanwhile
+        item.checkedAt = item.checked ? now : 0; //not straight back into the archive
+        item.remindAt = item.dueAt > now ? item.dueAt : 0; //reminders missed meanwhile stay missed
+        items[todo.column].append(item);
+    }
+    for (const QString &title : titles) {
+        int column = -1;
+        for (int c = 0; c < model->boardColumnCount() && column < 0; ++c) {
+            if (model->boardColumnTitle(c) == title) {
+                column = c;
+            }
+        }
+        if (column < 0) {
+            column = model->boardColumnCount();
+            model->insertBoardColumn(column, title);
+        }
+        model->insertItems(column, model->itemCount(column), items.value(title));
+    }
+
+    //on the board first, a crash in between leaves a duplicate instead of a loss
+    QList<QByteArray> payloads;
+    for (const ArchivedTodo &todo : todos) {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << quint8(Restored) << now << todo.offset;
+        payloads.append(payload);
+    }
+    return append(payloads);
+}
+
+QList<qint64> BoardArchive::entries(const QString &search) const
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly) || file.read(HeaderSize) != fileHeader()) {
+        return QList<qint64>();
+    }
+
+    QList<qint64> archived;
+    QSet<qint64> restored;
+    QByteArray payload;
+    qint64 offset = file.pos();
+    while (readRecord(file, &payload)) {
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_6_0);
+        quint8 kind;
+        qint64 time;
+        in >> kind >> time;
+        if (kind == Restored) {
+            qint64 target;
+            in >> target;
+            restored.insert(target);
+        } else if (kind == Archived) {
+            QString column;
+            QString text;
+            if (search.isEmpty() || ((in >> column >> text), text.contains(search, Qt::CaseInsensitive))) {
+                archived.append(offset);
+            }
+        }
+        offset = file.pos();
+    }
+
+    QList<qint64> result;
+    result.reserve(archived.size() - restored.size());
+    for (auto it = archived.crbegin(); it != archived.crend(); ++it) {
+        if (!restored.contains(*it)) {
+            result.append(*it);
+        }
+    }
+    return result;
+}
+
+QList<ArchivedTodo> BoardArchive::read(const QList<qint64> &offsets) const
+{
+    QList<ArchivedTodo> todos;
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return todos;
+    }
+
+    QByteArray payload;
+    for (qint64 offset : offsets) {
+        if (!file.seek(offset) || !readRecord(file, &payload)) {
+            continue;
+        }
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_6_0);
+        quint8 kind;
+        ArchivedTodo todo;
+        todo.offset = offset;
+        in >> kind >> todo.archivedAt >> todo.column >> todo.item.text >> todo.item.checked >> todo.item.id
+           >> todo.item.checkedAt >> todo.item.dueAt >> todo.item.repeatMinutes;
+        if (kind == Archived) {
+            todos.append(todo);
+        }
+    }
+    return todos;
+}
+
+bool BoardArchive::append(const QList<QByteArray> &payloads)
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadWrite)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+
+    //anything but an archive of this version is left alone, it may be a newer
+    //version's or hold todos that can still be recovered by hand
+    if (file.size() == 0) {
+        if (file.write(fileHeader()) != HeaderSize) {
+            m_errorString = file.errorString();
+            return false;
+        }
+        m_validSize = HeaderSize;
+    } else if (file.read(HeaderSize) != fileHeader()) {
+        m_errorString = QString("%1 is not an archive this version can write to").arg(m_fileName);
+        return false;
+    } else if (file.size() != m_validSize) {
+        //a torn record left by a crash would hide every record written after it
+        m_validSize = validSize(file);
+        if (m_validSize < file.size() && !file.resize(m_validSize)) {
+            m_errorString = file.errorString();
+            m_validSize = -1;
+            return false;
+        }
+    }
+    file.seek(m_validSize);
+
+    QByteArray records;
+    QDataStream out(&records, QIODevice::WriteOnly);
+    for (const QByteArray &payload : payloads) {
+        out << quint32(payload.size()) << qChecksum(payload);
+        out.writeRawData(payload.constData(), payload.size());
+    }
+    if (file.write(records) != records.size() || !file.flush()) {
+        m_errorString = file.errorString();
+        m_validSize = -1; //whatever made it to the disk gets checked next time
+        return false;
+    }
+    m_validSize += records.size();
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef BOARDARCHIVE_H
+#define BOARDARCHIVE_H
+
+#include <QList>
+#include <QString>
+#include <functional>
+#include "todoitem.h"
+
+class BoardModel;
+
+//a todo taken off the board, with the column it was in
+struct ArchivedTodo
+{
+    qint64 offset = 0; //where its record starts, identifies it inside the archive
+    QString column;
+    TodoItem item;
+    qint64 archivedAt = 0; //msecs since epoch
+};
+
+Q_DECLARE_TYPEINFO(ArchivedTodo, Q_RELOCATABLE_TYPE);
+
+//done todos moved off the board for good: an append-only file next to the board
+//that is never read when the board opens, only when somebody browses it; restoring
+//appends a record that cancels the entry, so nothing in the file is ever rewritten
+//
+//  header   magic "FWDA", version
+//  record   payload size, checksum, payload (QDataStream):
+//           kind, time, then the column and the todo for an archived todo,
+//           or the offset of the archived record for a restored one
+class BoardArchive
+{
+public:
+    explicit BoardArchive(const QString &fileName = QString());
+
+    QString fileName() const;
+    //why the last archive() or restore() could not write the file
+    QString errorString() const;
+
+    //moves the todos pick returns true for from model into the archive, written before
+    //they are removed so a crash in between leaves a duplicate instead of a loss;
+    //returns how many were archived or -1 when the archive could not be written
+    int archive(BoardModel *model, const std::function<bool(int column, int row, const TodoItem &item)> &pick);
+    //puts todos back at the end of the column they came from, created again if it is gone
+    bool restore(BoardModel *model, const QList<ArchivedTodo> &todos);
+
+    //offsets of the todos still in the archive, the most recently archived first;
+    //with search only those whose text contains it. Reads the whole file, the
+    //archive view calls it off the GUI thread
+    QList<qint64> entries(const QString &search = QString()) const;
+    //the todos at offsets entries() returned
+    QList<ArchivedTodo> read(const QList<qint64> &offsets) const;
+
+private:
+    bool append(const QList<QByteArray> &payloads);
+
+    QString m_fileName;
+    QString m_errorString;
+    //end of the last complete record as this object left the file, -1 until it
+    //checked the file once; the walk over the records is only needed again when
+    //the file no longer ends there, e.g. after a torn write
+    qint64 m_validSize = -1;
+};
+
+#endif
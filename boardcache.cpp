@@ -0,0 +1,67 @@
+#include "boardcache.h"
+
+BoardCache::BoardCache(int capacity, qint64 maxBytes)
+    : m_capacity(capacity)
+    , m_maxBytes(maxBytes)
+{
+}
+
+void BoardCache::setLimits(int capacity, qint64 maxBytes)
+{
+    m_capacity = capacity;
+    m_maxBytes = maxBytes;
+    evict();
+}
+
+bool BoardCache::contains(const QString &id) const
+{
+    for (const Entry &entry : m_entries) {
+        if (entry.id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BoardSnapshot BoardCache::take(const QString &id, MergeBase *base)
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).id == id) {
+            Entry entry = m_entries.takeAt(i);
+            m_bytes -= entry.bytes;
+            if (base) {
+                *base = entry.base;
+            }
+            return entry.snapshot;
+        }
+    }
+    return BoardSnapshot();
+}
+
+void BoardCache::insert(const QString &id, const BoardSnapshot &snapshot, const MergeBase &base)
+{
+    remove(id);
+
+    Entry entry;
+    entry.id = id;
+    entry.snapshot = snapshot;
+    entry.base = base;
+    entry.bytes = snapshot.byteSize() + base.byteSize();
+    m_bytes += entry.bytes;
+    m_entries.prepend(entry);
+    evict();
+}
+
+void BoardCache::remove(const QString &id)
+{
+    take(id);
+}
+
+void BoardCache::evict()
+{
+    //the snapshot is the last thing holding on to the board's lists and text buffer
+    while (!m_entries.isEmpty() && (m_entries.size() > m_capacity || m_bytes > m_maxBytes)) {
+        m_bytes -= m_entries.last().bytes;
+        m_entries.removeLast();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef BOARDCACHE_H
+#define BOARDCACHE_H
+
+#include <QList>
+#include <QString>
+#include "boardmerge.h"
+#include "boardmodel.h"
+
+//boards used recently, kept as the snapshot the model gave when they were closed,
+//so switching back to one is a single model reset instead of a trip to the disk and
+//the texts are never copied on the way in or out; the least recently used ones are
+//dropped once there are too many or they take up too much memory
+class BoardCache
+{
+public:
+    explicit BoardCache(int capacity = 3, qint64 maxBytes = 32 * 1024 * 1024);
+    void setLimits(int capacity, qint64 maxBytes);
+
+    bool contains(const QString &id) const;
+    //hands the board back and forgets it, it is live again from now on; base is the
+    //file as it was known when the board was put away, changes made to it since get merged
+    BoardSnapshot take(const QString &id, MergeBase *base = nullptr);
+    void insert(const QString &id, const BoardSnapshot &snapshot, const MergeBase &base);
+    void remove(const QString &id);
+
+private:
+    struct Entry
+    {
+        QString id;
+        BoardSnapshot snapshot;
+        MergeBase base;
+        qint64 bytes = 0; //of both
+    };
+
+    void evict();
+
+    QList<Entry> m_entries; //most recently used first
+    int m_capacity;
+    qint64 m_maxBytes;
+    qint64 m_bytes = 0;
+};
+
+#endif
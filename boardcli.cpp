@@ -0,0 +1,358 @@
+#include "boardcli.h"
+#include "boardmodel.h"
+#include "boardstorage.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTextStream>
+
+namespace {
+const char Usage[] =
+    "usage: frostwilldo [--board <name|id>] <command> [arguments]\n"
+    "\n"
+    "commands:\n"
+    "  boards                              list the boards\n"
+    "  list [column] [--open]              list todos as column, row, [ ] or [x] and text\n"
+    "  add <column> <text>...              add todos at the end of a column, - reads lines from stdin\n"
+    "  check <column> <row>...             mark todos as done\n"
+    "  uncheck <column> <row>...           mark todos as not done\n"
+    "  move <column> <row> <to> [toRow]    move a todo, to the end of the column without toRow\n"
+    "  remove <column> <row>...            delete todos\n"
+    "  export [file]                       write the board as json to stdout or to file (.json or .fwdb)\n"
+    "\n"
+    "columns are given by title or number, rows by the number list shows, both start at 1\n";
+
+//one todo per line, whatever its text contains
+QString escaped(QString text)
+{
+    return text.replace('\\', "\\\\").replace('\t', "\\t").replace('\n', "\\n");
+}
+
+}
+
+BoardCli::BoardCli()
+    : m_dataPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation))
+    , m_ownBoards(m_dataPath)
+    , m_boards(&m_ownBoards)
+    , m_standalone(true)
+{
+}
+
+BoardCli::BoardCli(const QString &dataPath, BoardIndex *boards)
+    : m_dataPath(dataPath)
+    , m_ownBoards(dataPath)
+    , m_boards(boards)
+    , m_standalone(false)
+{
+}
+
+bool BoardCli::isCommand(const QString &name)
+{
+    static const QStringList commands = {"boards", "list", "add", "check", "uncheck", "move", "remove", "export", "help"};
+    return commands.contains(name);
+}
+
+bool BoardCli::isCommandLine(const QStringList &arguments)
+{
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString &arg = arguments.at(i);
+        if (arg == "-b" || arg == "--board") {
+            ++i; //skip the board name
+        } else if (!arg.startsWith("--board=") && arg != "--open") {
+            return isCommand(arg);
+        }
+    }
+    return false;
+}
+
+bool BoardCli::readsInput(const QStringList &arguments)
+{
+    return isCommandLine(arguments) && arguments.contains("-");
+}
+
+void BoardCli::setOpenBoard(const QString &id, BoardModel *model)
+{
+    m_openBoard = id;
+    m_openModel = model;
+}
+
+void BoardCli::setWorkingDirectory(const QString &directory)
+{
+    m_workingDirectory = directory;
+}
+
+QString BoardCli::editedBoard() const
+{
+    return m_editedBoard;
+}
+
+int BoardCli::run(const QStringList &arguments, const QByteArray &input, QTextStream &out, QTextStream &err)
+{
+    m_editedBoard.clear();
+
+    QCommandLineParser parser;
+    QCommandLineOption boardOption({"b", "board"}, "Board to work on.", "board");
+    QCommandLineOption openOption("open", "Only list todos that are not done.");
+    parser.addOptions({boardOption, openOption});
+    if (!parser.parse(arguments)) {
+        err << "frostwilldo: " << parser.errorText() << "\n" << Usage;
+        return 2;
+    }
+
+    QStringList args = parser.positionalArguments();
+    const QString command = args.isEmpty() ? QString() : args.takeFirst();
+    if (command == "help" || !isCommand(command)) {
+        (command == "help" ? out : err) << Usage;
+        return command == "help" ? 0 : 2;
+    }
+
+    if (m_standalone) {
+        QDir().mkpath(m_dataPath);
+        m_boards->loadOrCreate();
+    }
+    if (command == "boards") {
+        return listBoards(out);
+    }
+
+    //--board takes a name or an id, without it the board opened last is used
+    BoardInfo info;
+    const QString wanted = parser.isSet(boardOption) ? parser.value(boardOption) : m_boards->currentBoard();
+    for (const BoardInfo &board : m_boards->boards()) {
+        if (board.id == wanted || board.name.compare(wanted, Qt::CaseInsensitive) == 0) {
+            info = board;
+            break;
+        }
+    }
+    if (info.id.isEmpty()) {
+        if (parser.isSet(boardOption)) {
+            err << "frostwilldo: no board '" << wanted << "'\n";
+            return 1;
+        }
+        info = m_boards->boards().first();
+    }
+
+    QSettings settings(m_dataPath + "/frostwilldo.ini", QSettings::IniFormat);
+    BoardFormat format = settings.value("storage/format", "json").toString() == "binary" ? BoardFormat::Binary : BoardFormat::Json;
+    const QString file = BoardStorage::boardFile(*m_boards, info, format);
+
+    if (command == "list") {
+        return list(readBoard(info, file), args, parser.isSet(openOption), out, err);
+    }
+    if (command == "export") {
+        return exportBoard(readBoard(info, file), args, out, err);
+    }
+    return edit(info, file, command, args, input, err);
+}
+
+BoardData BoardCli::readBoard(const BoardInfo &info, const QString &file) const
+{
+    if (m_openModel && info.id == m_openBoard) {
+        return m_openModel->boardData();
+    }
+
+    //snapshot plus journal without a BoardStorage, reading needs no writer thread
+    BoardData data;
+    BoardStorage::readSnapshot(file, &data);
+    BoardJournal(file + ".journal").replay(&data);
+    return data;
+}
+
+int BoardCli::listBoards(QTextStream &out)
+{
+    for (const BoardInfo &info : m_boards->boards()) {
+        out << info.name << "\t" << info.itemCount << " todos\t" << info.doneCount << " done"
+            << (info.id == m_boards->currentBoard() ? "\tcurrent" : "") << "\t" << info.id << "\n";
+    }
+    return 0;
+}
+
+int BoardCli::list(const BoardData &data, const QStringList &args, bool openOnly, QTextStream &out, QTextStream &err)
+{
+    QStringList titles;
+    for (const BoardColumnData &column : data.columns) {
+        titles.append(column.title);
+    }
+    int only = -1;
+    if (!args.isEmpty()) {
+        only = findColumn(titles, args.first());
+        if (only < 0) {
+            err << "frostwilldo: no column '" << args.first() << "'\n";
+            return 1;
+        }
+    }
+
+    //written as it goes, a big board never sits in memory as text
+    for (int c = 0; c < data.columns.size(); ++c) {
+        if (only >= 0 && c != only) {
+            continue;
+        }
+        const BoardColumnData &column = data.columns.at(c);
+        const QString title = escaped(column.title);
+        for (int row = 0; row < column.items.size(); ++row) {
+            const TodoItem &item = column.items.at(row);
+            if (openOnly && item.checked) {
+                continue;
+            }
+            out << title << "\t" << row + 1 << "\t" << (item.checked ? "[x]" : "[ ]") << "\t" << escaped(item.text) << "\n";
+        }
+    }
+    return 0;
+}
+
+int BoardCli::exportBoard(BoardData data, const QStringList &args, QTextStream &out, QTextStream &err)
+{
+    data.sequence = 0; //the copy has no journal of its own
+
+    if (args.isEmpty()) {
+        out.flush();
+        out.device()->write(BoardStorage::serializeSnapshot(data, BoardFormat::Json));
+        return 0;
+    }
+
+    QString error;
+    const QString fileName = QDir(m_workingDirectory).absoluteFilePath(args.first());
+    if (BoardStorage::writeSnapshotFile(fileName, data, &error) < 0) {
+        err << "frostwilldo: " << error << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int BoardCli::edit(const BoardInfo &info, const QString &file, const QString &command, const QStringList &args,
+                   const QByteArray &input, QTextStream &err)
+{
+    const int minArgs = command == "move" ? 3 : 2;
+    if (args.size() < minArgs) {
+        err << "frostwilldo: " << command << " needs more arguments\n" << Usage;
+        return 2;
+    }
+
+    if (m_openModel && info.id == m_openBoard) {
+        //open in the app, whose storage journals the edit like any made in the window
+        const int result = editModel(m_openModel, command, args, input, err);
+        if (result == 0) {
+            m_boards->updateCounts(info.id, m_openModel->boardData());
+            m_boards->save();
+            m_editedBoard = info.id;
+        }
+        return result;
+    }
+
+    //the same path the app takes: load, attach, and every change below is journaled
+    BoardModel model;
+    BoardStorage storage(file);
+    const bool fresh = !storage.exists();
+    BoardData data = storage.load();
+    model.setBoardData(data);
+    storage.attach(&model, data.sequence, data.stamp);
+    if (fresh) {
+        model.addDefaultColumns();
+    }
+
+    const int result = editModel(&model, command, args, input, err);
+    if (result != 0) {
+        return result;
+    }
+
+    //no journal is left behind, the file may be replaced before the board is opened again
+    if (!storage.fold()) {
+        err << "frostwilldo: could not write " << file << "\n";
+        return 1;
+    }
+
+    m_boards->updateCounts(info.id, model.boardData());
+    m_boards->save();
+    m_editedBoard = info.id;
+    return 0;
+}
+
+int BoardCli::editModel(BoardModel *model, const QString &command, const QStringList &args, const QByteArray &input,
+                        QTextStream &err)
+{
+    QStringList titles;
+    for (int c = 0; c < model->boardColumnCount(); ++c) {
+        titles.append(model->boardColumnTitle(c));
+    }
+
+    const int column = findColumn(titles, args.at(0));
+    if (column < 0) {
+        err << "frostwilldo: no column '" << args.at(0) << "'\n";
+        return 1;
+    }
+
+    if (command == "add") {
+        QList<TodoItem> items;
+        for (const QString &text : args.mid(1)) {
+            if (text == "-") {
+                QTextStream in(input);
+                QString line;
+                while (in.readLineInto(&line)) {
+                    if (!line.isEmpty()) {
+                        items.append(TodoItem{line});
+                    }
+                }
+            } else if (!text.isEmpty()) {
+                items.append(TodoItem{text});
+            }
+        }
+        model->insertItems(column, model->itemCount(column), items); //a single journal record
+    } else if (command == "move") {
+        const int row = findRow(model->itemCount(column), args.at(1));
+        const int toColumn = findColumn(titles, args.at(2));
+        if (row < 0) {
+            err << "frostwilldo: no todo " << args.at(1) << " in '" << args.at(0) << "'\n";
+            return 1;
+        }
+        if (toColumn < 0) {
+            err << "frostwilldo: no column '" << args.at(2) << "'\n";
+            return 1;
+        }
+        //toRow is where the todo ends up, moveItems wants the row it goes before
+        int toRow = model->itemCount(toColumn);
+        if (args.size() > 3) {
+            const int last = model->itemCount(toColumn) - (toColumn == column ? 1 : 0);
+            toRow = qBound(0, args.at(3).toInt() - 1, last);
+            if (toColumn == column && toRow > row) {
+                ++toRow;
+            }
+        }
+        model->moveItem(column, row, toColumn, toRow);
+    } else {
+        QList<int> rows;
+        for (const QString &arg : args.mid(1)) {
+            const int row = findRow(model->itemCount(column), arg);
+            if (row < 0) {
+                err << "frostwilldo: no todo " << arg << " in '" << args.at(0) << "'\n";
+                return 1;
+            }
+            rows.append(row);
+        }
+        //one batch, so the journal takes all of them in a single write
+        if (command == "remove") {
+            model->removeItems(column, rows);
+        } else {
+            model->setItemsChecked(column, rows, command == "check");
+        }
+    }
+    return 0;
+}
+
+int BoardCli::findColumn(const QStringList &titles, const QString &name)
+{
+    for (int c = 0; c < titles.size(); ++c) {
+        if (titles.at(c).compare(name, Qt::CaseInsensitive) == 0) {
+            return c;
+        }
+    }
+    bool ok;
+    const int number = name.toInt(&ok);
+    return ok && number >= 1 && number <= titles.size() ? number - 1 : -1;
+}
+
+int BoardCli::findRow(int count, const QString &row)
+{
+    bool ok;
+    const int number = row.toInt(&ok);
+    return ok && number >= 1 && number <= count ? number - 1 : -1;
+}
@@ -0,0 +1,66 @@
+#ifndef BOARDCLI_H
+#define BOARDCLI_H
+
+#include <QStringList>
+#include "boardindex.h"
+
+class BoardModel;
+class QTextStream;
+
+//frostwilldo <command> [arguments], runs under a QCoreApplication and never
+//creates a widget; boards are read through BoardStorage like in the app and
+//edits are appended to the board's journal, so a command is done in milliseconds.
+//While the app runs, commands are handed over to it and run there instead, on the
+//app's board index and, for the open board, on its model
+class BoardCli
+{
+public:
+    BoardCli();
+    //inside the app, boards is the app's own index
+    BoardCli(const QString &dataPath, BoardIndex *boards);
+
+    static bool isCommand(const QString &name);
+    //true when the first argument after the options is a command
+    static bool isCommandLine(const QStringList &arguments);
+    //true when todos are read from stdin
+    static bool readsInput(const QStringList &arguments);
+
+    //the board open in the app, edited through its model instead of its files
+    void setOpenBoard(const QString &id, BoardModel *model);
+    //relative file names are taken from here
+    void setWorkingDirectory(const QString &directory);
+
+    //arguments as the application got them, input is what stdin held,
+    //returns the exit code
+    int run(const QStringList &arguments, const QByteArray &input, QTextStream &out, QTextStream &err);
+
+    //id of the board the last run changed, empty if it changed none
+    QString editedBoard() const;
+
+private:
+    int listBoards(QTextStream &out);
+    int list(const BoardData &data, const QStringList &args, bool openOnly, QTextStream &out, QTextStream &err);
+    int exportBoard(BoardData data, const QStringList &args, QTextStream &out, QTextStream &err);
+    int edit(const BoardInfo &info, const QString &file, const QString &command, const QStringList &args,
+             const QByteArray &input, QTextStream &err);
+    int editModel(BoardModel *model, const QString &command, const QStringList &args, const QByteArray &input,
+                  QTextStream &err);
+    //the open board from the model, any other from its files
+    BoardData readBoard(const BoardInfo &info, const QString &file) const;
+
+    //column by title or 1-based number, -1 if there is none
+    static int findColumn(const QStringList &titles, const QString &name);
+    //1-based row as shown by list, -1 if it is out of range
+    static int findRow(int count, const QString &row);
+
+    QString m_dataPath;
+    BoardIndex m_ownBoards;
+    BoardIndex *m_boards;
+    bool m_standalone;
+    QString m_openBoard;
+    BoardModel *m_openModel = nullptr;
+    QString m_workingDirectory;
+    QString m_editedBoard;
+};
+
+#endif
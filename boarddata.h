@@ -0,0 +1,45 @@
+#ifndef BOARDDATA_H
+#define BOARDDATA_H
+
+#include <QList>
+#include <QString>
+#include <QDataStream>
+#include "todoitem.h"
+
+//a whole board as plain values, what the file formats and the journal read and write
+struct BoardColumnData
+{
+    QString title;
+    QList<TodoItem> items;
+};
+
+Q_DECLARE_TYPEINFO(BoardColumnData, Q_RELOCATABLE_TYPE);
+
+//text handed out without a copy, e.g. straight from the model's text buffer, owns no
+//memory (QString::fromRawData, capacity 0); whatever holds on to it keeps a copy instead
+inline QString ownedText(const QString &text)
+{
+    return text.capacity() == 0 && !text.isEmpty() ? QString(text.constData(), text.size()) : text;
+}
+
+//the whole todo including its id, so a replayed journal gives back the same todos
+inline QDataStream &operator<<(QDataStream &out, const TodoItem &item)
+{
+    return out << item.text << item.checked << item.id << item.checkedAt
+               << item.dueAt << item.remindAt << item.repeatMinutes;
+}
+
+inline QDataStream &operator>>(QDataStream &in, TodoItem &item)
+{
+    return in >> item.text >> item.checked >> item.id >> item.checkedAt
+              >> item.dueAt >> item.remindAt >> item.repeatMinutes;
+}
+
+struct BoardData
+{
+    QList<BoardColumnData> columns;
+    quint64 sequence = 0; //last journal record already contained in this data
+    quint64 stamp = 0;    //set anew on every snapshot the app writes, names the one a journal continues
+};
+
+#endif
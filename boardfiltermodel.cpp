@@ -0,0 +1,146 @@
+#include "boardfiltermodel.h"
+#include "tracer.h"
+
+BoardFilterModel::BoardFilterModel(BoardModel *model, QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_model(model)
+    , m_index(new SearchIndex(model, this))
+{
+    //connected before the proxy hooks itself up, so the match set is current
+    //by the time new or edited rows get filtered
+    connect(m_model, &BoardModel::rowsInserted, this, &BoardFilterModel::onRowsInserted);
+    connect(m_model, &BoardModel::rowsAboutToBeRemoved, this, &BoardFilterModel::onRowsAboutToBeRemoved);
+    connect(m_model, &BoardModel::dataChanged, this, &BoardFilterModel::onDataChanged);
+    connect(m_model, &BoardModel::modelReset, this, &BoardFilterModel::onModelReset);
+    setSourceModel(m_model);
+}
+
+BoardModel *BoardFilterModel::boardModel() const
+{
+    return m_model;
+}
+
+QString BoardFilterModel::searchText() const
+{
+    return m_searchText;
+}
+
+void BoardFilterModel::setSearchText(const QString &text)
+{
+    if (text == m_searchText) {
+        return;
+    }
+
+    TRACE_SPAN("search");
+    const QString previous = m_searchText;
+    m_searchText = text;
+    if (text.isEmpty()) {
+        m_matches.clear();
+    } else if (!previous.isEmpty() && text.contains(previous, Qt::CaseInsensitive)) {
+        //typing on only ever narrows the result, no need to go back to the index
+        m_matches = m_index->refine(m_matches, text);
+    } else {
+        m_matches = m_index->search(text);
+    }
+
+    invalidateRowsFilter();
+    emit searchTextChanged(text);
+}
+
+int BoardFilterModel::matchCount() const
+{
+    return m_matches.size();
+}
+
+int BoardFilterModel::sourceRow(int column, int row) const
+{
+    const QModelIndex parent = index(column, 0);
+    const int rows = rowCount(parent);
+    if (rows == 0) {
+        return m_model->itemCount(column);
+    }
+    if (row < rows) {
+        return mapToSource(index(qMax(0, row), 0, parent)).row();
+    }
+    return mapToSource(index(rows - 1, 0, parent)).row() + 1;
+}
+
+bool BoardFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!sourceParent.isValid() || m_searchText.isEmpty()) {
+        return true;
+    }
+    return m_matches.contains(m_model->itemId(sourceParent.row(), sourceRow));
+}
+
+void BoardFilterModel::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (m_searchText.isEmpty()) {
+        return;
+    }
+
+    auto check = [this](int column, int row) {
+        const quint64 id = m_model->itemId(column, row);
+        if (m_index->matches(id, m_searchText)) {
+            m_matches.insert(id);
+        }
+    };
+    if (!parent.isValid()) {
+        for (int column = first; column <= last; ++column) {
+            for (int row = 0; row < m_model->itemCount(column); ++row) {
+                check(column, row);
+            }
+        }
+        return;
+    }
+    for (int row = first; row <= last; ++row) {
+        check(parent.row(), row);
+    }
+}
+
+void BoardFilterModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    //looked up while the rows are still there, or matchCount() keeps counting todos
+    //that are gone
+    if (m_searchText.isEmpty()) {
+        return;
+    }
+    if (!parent.isValid()) {
+        for (int column = first; column <= last; ++column) {
+            for (int row = 0; row < m_model->itemCount(column); ++row) {
+                m_matches.remove(m_model->itemId(column, row));
+            }
+        }
+        return;
+    }
+    for (int row = first; row <= last; ++row) {
+        m_matches.remove(m_model->itemId(parent.row(), row));
+    }
+}
+
+void BoardFilterModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    const QModelIndex parent = topLeft.parent();
+    if (m_searchText.isEmpty() || !parent.isValid()) {
+        return;
+    }
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole)) {
+        return;
+    }
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const quint64 id = m_model->itemId(parent.row(), row);
+        if (m_index->matches(id, m_searchText)) {
+            m_matches.insert(id);
+        } else {
+            m_matches.remove(id);
+        }
+    }
+}
+
+void BoardFilterModel::onModelReset()
+{
+    if (!m_searchText.isEmpty()) {
+        m_matches = m_index->search(m_searchText);
+    }
+}
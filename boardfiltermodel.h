@@ -0,0 +1,47 @@
+#ifndef BOARDFILTERMODEL_H
+#define BOARDFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QSet>
+#include "boardmodel.h"
+#include "searchindex.h"
+
+//what the column views show: the board with the todos that do not match the
+//search taken out, columns always stay; without a search everything passes
+class BoardFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit BoardFilterModel(BoardModel *model, QObject *parent = nullptr);
+
+    BoardModel *boardModel() const;
+
+    QString searchText() const;
+    void setSearchText(const QString &text);
+    int matchCount() const;
+
+    //board model row that row of column in this model stands for, one past the
+    //last shown todo maps right behind it so drops land where they were aimed
+    int sourceRow(int column, int row) const;
+
+signals:
+    void searchTextChanged(const QString &text);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void onModelReset();
+
+private:
+    BoardModel *m_model;
+    SearchIndex *m_index;
+    QString m_searchText;
+    QSet<quint64> m_matches;
+};
+
+#endif
@@ -0,0 +1,456 @@
+#include "boardimporter.h"
+#include "boardmodel.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include "tracer.h"
+
+namespace {
+const int BatchSize = 2000;        //todos handed to the GUI thread at once
+const qint64 BatchIntervalMs = 50; //a slowly read file still shows up as it goes
+const int MaxBatchesInFlight = 4;  //the worker waits while the GUI thread catches up
+
+bool isDone(const QString &value)
+{
+    static const QStringList doneValues = {"1", "true", "yes", "x", "[x]", "done", "completed", "closed"};
+    return doneValues.contains(value.trimmed(), Qt::CaseInsensitive);
+}
+
+int indexOfAny(const QStringList &fields, const QStringList &names)
+{
+    for (int i = 0; i < fields.size(); ++i) {
+        if (names.contains(fields.at(i).trimmed(), Qt::CaseInsensitive)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//whichever of , ; and tab the header line uses most
+QChar csvDelimiter(const QString &line)
+{
+    QChar delimiter = ',';
+    int most = line.count(',');
+    for (QChar candidate : {QChar(';'), QChar('\t')}) {
+        if (line.count(candidate) > most) {
+            delimiter = candidate;
+            most = line.count(candidate);
+        }
+    }
+    return delimiter;
+}
+
+//one record, quoted fields may contain the delimiter, "" and line breaks
+bool readCsvRecord(QTextStream &in, QChar delimiter, QStringList *fields)
+{
+    fields->clear();
+    QString field;
+    QString line;
+    bool quoted = false;
+    bool read = false;
+    while (in.readLineInto(&line)) {
+        read = true;
+        for (int i = 0; i < line.size(); ++i) {
+            const QChar c = line.at(i);
+            if (quoted) {
+                if (c != '"') {
+                    field += c;
+                } else if (i + 1 < line.size() && line.at(i + 1) == '"') {
+                    field += c;
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == delimiter) {
+                fields->append(field);
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+        if (!quoted) {
+            break;
+        }
+        field += '\n';
+    }
+    if (read) {
+        fields->append(field);
+    }
+    return read;
+}
+
+//"- [ ] text", "- [x] text", "- text" or "1. text"
+bool readListItem(const QString &line, TodoItem *item)
+{
+    int start = -1;
+    if (line.size() > 1 && (line.at(0) == '-' || line.at(0) == '*' || line.at(0) == '+') && line.at(1) == ' ') {
+        start = 2;
+    } else {
+        int digits = 0;
+        while (digits < line.size() && line.at(digits).isDigit()) {
+            ++digits;
+        }
+        if (digits > 0 && digits + 1 < line.size() && (line.at(digits) == '.' || line.at(digits) == ')')
+            && line.at(digits + 1) == ' ') {
+            start = digits + 2;
+        }
+    }
+    if (start < 0) {
+        return false;
+    }
+
+    QString text = line.mid(start).trimmed();
+    if (text.size() >= 3 && text.at(0) == '[' && text.at(2) == ']' && QStringLiteral(" xX").contains(text.at(1))) {
+        item->checked = text.at(1) != ' ';
+        text = text.mid(3).trimmed();
+    }
+    item->text = text;
+    return !text.isEmpty();
+}
+}
+
+BoardImporter::BoardImporter(BoardModel *model, int defaultColumn, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_defaultColumn(model->boardColumnIndex(defaultColumn))
+    , m_inFlight(MaxBatchesInFlight)
+{
+}
+
+BoardImporter::~BoardImporter()
+{
+    //whatever got in stays, the model may already be gone so nothing is taken back here
+    m_cancelled = true;
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+BoardImporter::Format BoardImporter::formatForFile(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "csv" || suffix == "tsv") {
+        return Csv;
+    }
+    if (suffix == "md" || suffix == "markdown") {
+        return Markdown;
+    }
+    return PlainText;
+}
+
+bool BoardImporter::canImport(const QString &fileName)
+{
+    static const QStringList suffixes = {"csv", "tsv", "md", "markdown", "txt"};
+    return suffixes.contains(QFileInfo(fileName).suffix().toLower());
+}
+
+QString BoardImporter::fileFilter()
+{
+    return "Todo lists (*.csv *.tsv *.md *.markdown *.txt);;All files (*)";
+}
+
+void BoardImporter::start(const QString &fileName)
+{
+    m_importing = true;
+    m_totalBytes = QFileInfo(fileName).size();
+
+    m_thread = QThread::create([this, fileName]() {
+        parse(fileName);
+    });
+    m_thread->setObjectName("BoardImporter");
+    connect(m_thread, &QThread::finished, this, &BoardImporter::onParsed);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+    m_thread->start();
+}
+
+void BoardImporter::cancel()
+{
+    if (!m_importing || m_cancelled) {
+        return;
+    }
+    m_cancelled = true; //the worker stops at the next line
+    rollback();
+    emit failed(QString());
+}
+
+bool BoardImporter::isImporting() const
+{
+    return m_importing;
+}
+
+int BoardImporter::importedCount() const
+{
+    return m_imported;
+}
+
+void BoardImporter::parse(const QString &fileName)
+{
+    TRACE_SPAN("import file");
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_error = file.errorString();
+        return;
+    }
+
+    m_device = &file;
+    m_flushTimer.start();
+    QTextStream in(&file);
+    switch (formatForFile(fileName)) {
+    case Csv:
+        parseCsv(in);
+        break;
+    case Markdown:
+        parseMarkdown(in);
+        break;
+    case PlainText:
+        parsePlainText(in);
+        break;
+    }
+
+    if (file.error() != QFileDevice::NoError) {
+        m_error = file.errorString();
+    } else {
+        flush(true);
+    }
+    m_device = nullptr;
+}
+
+void BoardImporter::parseCsv(QTextStream &in)
+{
+    QString firstLine;
+    if (!in.readLineInto(&firstLine)) {
+        return;
+    }
+    const QChar delimiter = csvDelimiter(firstLine);
+    in.seek(0);
+
+    int textField = 0;
+    int columnField = -1;
+    int doneField = -1;
+    bool header = true;
+    QStringList fields;
+    while (!m_cancelled && readCsvRecord(in, delimiter, &fields)) {
+        if (header) {
+            //a header row names the fields, without one every row is a todo
+            header = false;
+            fields.first().remove(QChar(0xFEFF));
+            const int text = indexOfAny(fields, {"text", "title", "task", "todo", "summary", "name"});
+            const int column = indexOfAny(fields, {"column", "list", "status", "state", "stage"});
+            const int done = indexOfAny(fields, {"done", "checked", "completed", "complete"});
+            if (text >= 0 || column >= 0 || done >= 0) {
+                textField = qMax(text, 0);
+                columnField = column;
+                doneField = done;
+                continue;
+            }
+        }
+
+        TodoItem item;
+        item.text = fields.value(textField).trimmed();
+        if (item.text.isEmpty()) {
+            continue;
+        }
+        item.checked = doneField >= 0 && isDone(fields.value(doneField));
+        add(columnField >= 0 ? fields.value(columnField).trimmed() : QString(), item);
+    }
+}
+
+void BoardImporter::parseMarkdown(QTextStream &in)
+{
+    QString column; //the last heading, todos above the first one go to the default column
+    QString line;
+    bool code = false;
+    while (!m_cancelled && in.readLineInto(&line)) {
+        const QString trimmed = line.trimmed();
+        if (trimmed.startsWith("```") || trimmed.startsWith("~~~")) {
+            code = !code;
+            continue;
+        }
+        if (code || trimmed.isEmpty()) {
+            continue;
+        }
+
+        if (trimmed.startsWith('#')) {
+            int level = 0;
+            while (level < trimmed.size() && trimmed.at(level) == '#') {
+                ++level;
+            }
+            if (level <= 6 && (level == trimmed.size() || trimmed.at(level).isSpace())) {
+                column = trimmed.mid(level);
+                while (column.endsWith('#')) {
+                    column.chop(1);
+                }
+                column = column.trimmed();
+                continue;
+            }
+        }
+
+        //prose between the lists is skipped
+        TodoItem item;
+        if (readListItem(trimmed, &item)) {
+            add(column, item);
+        }
+    }
+}
+
+void BoardImporter::parsePlainText(QTextStream &in)
+{
+    QString line;
+    while (!m_cancelled && in.readLineInto(&line)) {
+        TodoItem item;
+        item.text = line.trimmed();
+        if (!item.text.isEmpty()) {
+            add(QString(), item);
+        }
+    }
+}
+
+void BoardImporter::add(const QString &column, const TodoItem &item)
+{
+    //todos of one column usually come in runs, so the last batch is nearly always the one
+    if (m_batches.isEmpty() || m_batches.last().column != column) {
+        auto it = std::find_if(m_batches.begin(), m_batches.end(), [&column](const Batch &batch) {
+            return batch.column == column;
+        });
+        if (it == m_batches.end()) {
+            m_batches.append(Batch{column, {}});
+        } else {
+            std::rotate(it, it + 1, m_batches.end());
+        }
+    }
+    m_batches.last().items.append(item);
+    ++m_batchSize;
+    flush();
+}
+
+void BoardImporter::flush(bool force)
+{
+    if (m_batches.isEmpty() || (!force && m_batchSize < BatchSize && m_flushTimer.elapsed() < BatchIntervalMs)) {
+        return;
+    }
+
+    //wait while the GUI thread is behind, it also caps what is read ahead
+    while (!m_inFlight.tryAcquire(1, 100)) {
+        if (m_cancelled) {
+            return;
+        }
+    }
+
+    const QList<Batch> batches = m_batches;
+    const qint64 bytesRead = m_device->pos();
+    m_batches.clear();
+    m_batchSize = 0;
+    m_flushTimer.restart();
+    QMetaObject::invokeMethod(this, [this, batches, bytesRead]() {
+        apply(batches, bytesRead);
+    }, Qt::QueuedConnection);
+}
+
+void BoardImporter::apply(const QList<Batch> &batches, qint64 bytesRead)
+{
+    m_inFlight.release();
+    if (m_cancelled) {
+        return;
+    }
+
+    TRACE_SPAN("import batch");
+    for (const Batch &batch : batches) {
+        Target &target = m_targets[columnFor(batch.column)];
+        if (!target.index.isValid()) { //column got deleted while importing
+            continue;
+        }
+        //one rowsInserted (and one journal record) for the whole run
+        const int column = target.index.row();
+        m_model->insertItems(column, m_model->itemCount(column), batch.items);
+        target.count += batch.items.size();
+        m_imported += batch.items.size();
+    }
+    emit progress(bytesRead, m_totalBytes);
+}
+
+void BoardImporter::onParsed()
+{
+    m_thread = nullptr;
+    m_importing = false;
+    if (m_cancelled) {
+        return; //cancel() already took it back
+    }
+
+    if (!m_error.isEmpty()) {
+        rollback();
+        emit failed(m_error);
+        return;
+    }
+    emit progress(m_totalBytes, m_totalBytes);
+    emit finished(m_imported);
+}
+
+int BoardImporter::columnFor(const QString &title)
+{
+    const QString key = title.toLower();
+    auto known = m_targetForTitle.constFind(key);
+    if (known != m_targetForTitle.constEnd()) {
+        return known.value();
+    }
+
+    //an existing column with that title, or a new one at the end of the board
+    QPersistentModelIndex index;
+    bool created = false;
+    if (title.isEmpty()) {
+        index = m_defaultColumn;
+    } else {
+        for (int c = 0; c < m_model->boardColumnCount(); ++c) {
+            if (m_model->boardColumnTitle(c).compare(title, Qt::CaseInsensitive) == 0) {
+                index = m_model->boardColumnIndex(c);
+                break;
+            }
+        }
+    }
+    if (!index.isValid()) {
+        const int column = m_model->boardColumnCount();
+        m_model->insertBoardColumn(column, title.isEmpty() ? QStringLiteral("Imported") : title);
+        index = m_model->boardColumnIndex(column);
+        created = true;
+    }
+
+    int target = -1;
+    for (int i = 0; i < m_targets.size(); ++i) {
+        if (m_targets.at(i).index == index) {
+            target = i;
+            break;
+        }
+    }
+    if (target < 0) {
+        Target added;
+        added.index = index;
+        added.start = m_model->itemCount(index.row());
+        added.created = created;
+        m_targets.append(added);
+        target = m_targets.size() - 1;
+        emit columnStarted(index.row());
+    }
+    m_targetForTitle.insert(key, target);
+    return target;
+}
+
+void BoardImporter::rollback()
+{
+    //the columns were locked, so the imported todos are still the last ones in each
+    for (int i = m_targets.size() - 1; i >= 0; --i) {
+        const Target &target = m_targets.at(i);
+        if (!target.index.isValid()) {
+            continue;
+        }
+        const int column = target.index.row();
+        m_model->removeItems(column, target.start, target.count);
+        if (target.created && m_model->itemCount(column) == 0) {
+            m_model->removeBoardColumn(column);
+        }
+    }
+    m_targets.clear();
+    m_targetForTitle.clear();
+    m_imported = 0;
+}
@@ -0,0 +1,102 @@
+#ifndef BOARDIMPORTER_H
+#define BOARDIMPORTER_H
+
+#include <QObject>
+#include <QThread>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPersistentModelIndex>
+#include <atomic>
+#include "todoitem.h"
+
+class BoardModel;
+class QTextStream;
+
+//imports todos from a CSV file, a Markdown checklist or plain text: the file is
+//read on a worker a few thousand todos at a time and each batch goes into the
+//board as one insert per column, so a file of any size never sits in memory
+//as a whole and the window keeps running while it comes in
+class BoardImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        Csv,      //a column field picks the column, a done field checks the todo
+        Markdown, //headings pick the column, - [ ] and - [x] items become todos
+        PlainText //one todo per line
+    };
+
+    //todos that name no column of their own go to defaultColumn
+    BoardImporter(BoardModel *model, int defaultColumn, QObject *parent = nullptr);
+    ~BoardImporter() override;
+
+    static Format formatForFile(const QString &fileName);
+    static bool canImport(const QString &fileName);
+    static QString fileFilter(); //for QFileDialog
+
+    void start(const QString &fileName);
+    //takes back everything imported so far
+    void cancel();
+
+    bool isImporting() const;
+    int importedCount() const;
+
+signals:
+    void columnStarted(int column); //todos are about to go into column, keep it locked
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void finished(int imported);
+    //nothing of the file stays on the board, error is empty after cancel()
+    void failed(const QString &error);
+
+private:
+    struct Batch
+    {
+        QString column; //empty for the default column
+        QList<TodoItem> items;
+    };
+
+    struct Target
+    {
+        QPersistentModelIndex index; //follows the column if it gets moved meanwhile
+        int start = 0;
+        int count = 0;
+        bool created = false;
+    };
+
+    //worker side
+    void parse(const QString &fileName);
+    void parseCsv(QTextStream &in);
+    void parseMarkdown(QTextStream &in);
+    void parsePlainText(QTextStream &in);
+    void add(const QString &column, const TodoItem &item);
+    void flush(bool force = false);
+
+    //GUI side
+    void apply(const QList<Batch> &batches, qint64 bytesRead);
+    void onParsed();
+    int columnFor(const QString &title);
+    void rollback();
+
+    BoardModel *m_model;
+    QPersistentModelIndex m_defaultColumn;
+    QThread *m_thread = nullptr;
+    QSemaphore m_inFlight; //batches handed to the GUI thread but not applied yet
+    std::atomic<bool> m_cancelled{false};
+
+    //touched by the worker only
+    QIODevice *m_device = nullptr;
+    QList<Batch> m_batches;
+    int m_batchSize = 0;
+    QElapsedTimer m_flushTimer;
+    QString m_error;
+
+    qint64 m_totalBytes = 0;
+    QList<Target> m_targets;
+    QHash<QString, int> m_targetForTitle; //lower case title to index into m_targets
+    int m_imported = 0;
+    bool m_importing = false;
+};
+
+#endif
@@ -0,0 +1,216 @@
+#include "boardindex.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUuid>
+#include <QThreadPool>
+
+namespace {
+//a single thread, so background writes of boards.json land in the order they were made
+QThreadPool *writerPool()
+{
+    static QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    return &pool;
+}
+
+bool writeFile(const QString &fileName, const QByteArray &content)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(content);
+    return file.commit();
+}
+}
+
+BoardIndex::BoardIndex(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+QString BoardIndex::fileName() const
+{
+    return m_directory + "/boards.json";
+}
+
+bool BoardIndex::load()
+{
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    m_boards.clear();
+    for (const QJsonValue &value : root["boards"].toArray()) {
+        QJsonObject object = value.toObject();
+        BoardInfo info;
+        info.id = object["id"].toString();
+        info.name = object["name"].toString();
+        info.baseName = object["file"].toString();
+        info.columnCount = object["columns"].toInt();
+        info.itemCount = object["todos"].toInt();
+        info.doneCount = object["done"].toInt();
+        for (const QJsonValue &title : object["columnTitles"].toArray()) {
+            info.columnTitles.append(title.toString());
+        }
+        info.lastOpened = QDateTime::fromString(object["lastOpened"].toString(), Qt::ISODate);
+        if (!info.id.isEmpty() && !info.baseName.isEmpty()) {
+            m_boards.append(info);
+        }
+    }
+    m_current = root["current"].toString();
+    return !m_boards.isEmpty();
+}
+
+bool BoardIndex::save() const
+{
+    //a write still queued would land after this one
+    writerPool()->waitForDone();
+    return writeFile(fileName(), toJson());
+}
+
+void BoardIndex::saveInBackground() const
+{
+    const QString fileName = this->fileName();
+    const QByteArray content = toJson();
+    writerPool()->start([fileName, content]() { writeFile(fileName, content); });
+}
+
+QByteArray BoardIndex::toJson() const
+{
+    QJsonArray boards;
+    for (const BoardInfo &info : m_boards) {
+        QJsonObject object;
+        object["id"] = info.id;
+        object["name"] = info.name;
+        object["file"] = info.baseName;
+        object["columns"] = info.columnCount;
+        object["todos"] = info.itemCount;
+        object["done"] = info.doneCount;
+        object["columnTitles"] = QJsonArray::fromStringList(info.columnTitles);
+        object["lastOpened"] = info.lastOpened.toString(Qt::ISODate);
+        boards.append(object);
+    }
+
+    QJsonObject root;
+    root["boards"] = boards;
+    root["current"] = m_current;
+    return QJsonDocument(root).toJson();
+}
+
+void BoardIndex::loadOrCreate()
+{
+    if (load()) {
+        return;
+    }
+    BoardInfo info = addBoard("My Board", "frostwilldo");
+    setCurrentBoard(info.id);
+    save();
+}
+
+QList<BoardInfo> BoardIndex::boards() const
+{
+    return m_boards;
+}
+
+bool BoardIndex::contains(const QString &id) const
+{
+    for (const BoardInfo &info : m_boards) {
+        if (info.id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BoardInfo BoardIndex::board(const QString &id) const
+{
+    for (const BoardInfo &info : m_boards) {
+        if (info.id == id) {
+            return info;
+        }
+    }
+    return BoardInfo();
+}
+
+BoardInfo BoardIndex::addBoard(const QString &name, const QString &baseName)
+{
+    BoardInfo info;
+    info.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    info.name = name;
+    info.baseName = baseName.isEmpty() ? "boards/" + info.id : baseName;
+    m_boards.append(info);
+    return info;
+}
+
+void BoardIndex::updateBoard(const BoardInfo &info)
+{
+    for (BoardInfo &board : m_boards) {
+        if (board.id == info.id) {
+            board = info;
+            return;
+        }
+    }
+}
+
+void BoardIndex::removeBoard(const QString &id)
+{
+    m_boards.removeIf([&id](const BoardInfo &info) { return info.id == id; });
+    if (m_current == id) {
+        m_current.clear();
+    }
+}
+
+bool BoardIndex::updateCounts(const QString &id, const BoardData &data)
+{
+    QStringList columnTitles;
+    int itemCount = 0;
+    int doneCount = 0;
+    for (const BoardColumnData &column : data.columns) {
+        columnTitles.append(column.title);
+        itemCount += column.items.size();
+        for (const TodoItem &item : column.items) {
+            doneCount += item.checked;
+        }
+    }
+    return updateCounts(id, columnTitles, itemCount, doneCount);
+}
+
+bool BoardIndex::updateCounts(const QString &id, const QStringList &columnTitles, int itemCount, int doneCount)
+{
+    for (BoardInfo &board : m_boards) {
+        if (board.id != id) {
+            continue;
+        }
+        if (board.columnTitles == columnTitles && board.columnCount == columnTitles.size()
+            && board.itemCount == itemCount && board.doneCount == doneCount) {
+            return false;
+        }
+        board.columnCount = columnTitles.size();
+        board.columnTitles = columnTitles;
+        board.itemCount = itemCount;
+        board.doneCount = doneCount;
+        return true;
+    }
+    return false;
+}
+
+QString BoardIndex::currentBoard() const
+{
+    return m_current;
+}
+
+void BoardIndex::setCurrentBoard(const QString &id)
+{
+    m_current = id;
+}
+
+QString BoardIndex::boardFile(const BoardInfo &info, const QString &suffix) const
+{
+    return m_directory + "/" + info.baseName + "." + suffix;
+}
@@ -0,0 +1,63 @@
+#ifndef BOARDINDEX_H
+#define BOARDINDEX_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "boarddata.h"
+
+//what the board switcher knows about a board without opening it
+struct BoardInfo
+{
+    QString id;
+    QString name;
+    QString baseName; //file name without suffix, relative to the data directory
+    int columnCount = 0;
+    int itemCount = 0;
+    int doneCount = 0;
+    QStringList columnTitles; //lets the window show the columns before the board is read
+    QDateTime lastOpened;
+};
+
+//boards.json in the data directory, lists every board and remembers the open one
+class BoardIndex
+{
+public:
+    explicit BoardIndex(const QString &directory);
+
+    QString fileName() const;
+    bool load();
+    bool save() const;
+    //the same on a worker thread, for saves that happen while the board is edited
+    void saveInBackground() const;
+    //without boards.json the single board from before keeps its file
+    void loadOrCreate();
+
+    QList<BoardInfo> boards() const;
+    bool contains(const QString &id) const;
+    BoardInfo board(const QString &id) const;
+
+    //new boards get their own file under boards/
+    BoardInfo addBoard(const QString &name, const QString &baseName = QString());
+    void updateBoard(const BoardInfo &info);
+    void removeBoard(const QString &id);
+    //column, todo and done counts shown in the switcher, true when they changed
+    bool updateCounts(const QString &id, const BoardData &data);
+    bool updateCounts(const QString &id, const QStringList &columnTitles, int itemCount, int doneCount);
+
+    QString currentBoard() const;
+    void setCurrentBoard(const QString &id);
+
+    //snapshot of a board in the format with the given suffix
+    QString boardFile(const BoardInfo &info, const QString &suffix) const;
+
+private:
+    QByteArray toJson() const;
+
+    QString m_directory;
+    QList<BoardInfo> m_boards;
+    QString m_current;
+};
+
+#endif
@@ -0,0 +1,604 @@
+#include "boardjournal.h"
+#include "boardmodel.h"
+#include <QDataStream>
+#include <QSaveFile>
+
+namespace {
+const char JournalMagic[4] = {'F', 'W', 'D', 'J'};
+const quint32 JournalVersion = 1;
+const int StampOffset = 8;       //after magic + version
+const int HeaderSize = 16;       //magic + version + stamp of the snapshot it continues
+const int RecordHeaderSize = 6;  //payload size + checksum
+
+QByteArray fileHeader(quint64 stamp)
+{
+    QByteArray header(JournalMagic, sizeof(JournalMagic));
+    QDataStream out(&header, QIODevice::Append);
+    out << JournalVersion << stamp;
+    return header;
+}
+
+bool hasHeader(const QByteArray &content)
+{
+    return content.size() >= HeaderSize && content.startsWith(fileHeader(0).left(StampOffset));
+}
+
+quint64 headerStamp(const QByteArray &content)
+{
+    quint64 stamp;
+    QDataStream(content.mid(StampOffset, sizeof(stamp))) >> stamp;
+    return stamp;
+}
+
+//moves count entries starting at from in src to the pre-move index to in dst
+template <typename T>
+bool moveRange(QList<T> &src, int from, int count, QList<T> &dst, int to)
+{
+    if (from < 0 || count <= 0 || from + count > src.size() || to < 0 || to > dst.size()) {
+        return false;
+    }
+    QList<T> moved = src.mid(from, count);
+    src.remove(from, count);
+    if (&src == &dst && to > from) {
+        to -= count;
+    }
+    for (int i = 0; i < moved.size(); ++i) {
+        dst.insert(to + i, moved.at(i));
+    }
+    return true;
+}
+}
+
+BoardJournal::BoardJournal(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+{
+}
+
+BoardJournal::~BoardJournal()
+{
+    close();
+}
+
+QString BoardJournal::fileName() const
+{
+    return m_fileName;
+}
+
+qint64 BoardJournal::scan(const QByteArray &content, quint64 *lastSequence, QList<QPair<quint64, QByteArray>> *records)
+{
+    if (!hasHeader(content)) {
+        return 0;
+    }
+
+    qint64 offset = HeaderSize;
+    while (content.size() - offset >= RecordHeaderSize) {
+        QDataStream in(content.mid(offset, RecordHeaderSize));
+        quint32 payloadSize;
+        quint16 checksum;
+        in >> payloadSize >> checksum;
+
+        if (payloadSize < sizeof(quint64) || content.size() - offset - RecordHeaderSize < qint64(payloadSize)) {
+            break; //torn write at the end of the file
+        }
+        QByteArray payload = content.mid(offset + RecordHeaderSize, payloadSize);
+        if (qChecksum(payload) != checksum) {
+            break;
+        }
+
+        quint64 sequence;
+        QDataStream(payload) >> sequence;
+        if (lastSequence) {
+            *lastSequence = sequence;
+        }
+        if (records) {
+            records->append(qMakePair(sequence, payload));
+        }
+        offset += RecordHeaderSize + payloadSize;
+    }
+    return offset;
+}
+
+bool BoardJournal::replay(BoardData *data) const
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return true; //no journal yet, nothing to replay
+    }
+    QByteArray content = file.readAll();
+    file.close();
+
+    //records address todos by position, on any other file than the one they
+    //continue they would hit the wrong todos; open() sets such a journal aside
+    if (hasHeader(content) && headerStamp(content) != data->stamp) {
+        return false;
+    }
+
+    QList<QPair<quint64, QByteArray>> records;
+    qint64 validSize = scan(content, nullptr, &records);
+
+    for (const auto &record : records) {
+        if (record.first <= data->sequence) {
+            continue; //already part of the snapshot
+        }
+        //every later record builds on this one, none of them applies anymore
+        if (!applyRecord(record.second, data)) {
+            return false;
+        }
+        data->sequence = record.first;
+    }
+    return validSize == content.size();
+}
+
+bool BoardJournal::applyRecord(const QByteArray &payload, BoardData *data)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint64 sequence;
+    quint8 operation;
+    in >> sequence >> operation;
+
+    QList<BoardColumnData> &columns = data->columns;
+    switch (operation) {
+    case AddColumns: {
+        qint32 column, count;
+        QList<BoardColumnData> added;
+        in >> column >> count;
+        for (int i = 0; i < count; ++i) {
+            BoardColumnData col;
+            in >> col.title >> col.items;
+            added.append(col);
+        }
+        if (column < 0 || column > columns.size()) {
+            return false;
+        }
+        for (int i = 0; i < added.size(); ++i) {
+            columns.insert(column + i, added.at(i));
+        }
+        return true;
+    }
+    case RemoveColumns: {
+        qint32 column, count;
+        in >> column >> count;
+        if (column < 0 || count <= 0 || column + count > columns.size()) {
+            return false;
+        }
+        columns.remove(column, count);
+        return true;
+    }
+    case MoveColumns: {
+        qint32 from, count, to;
+        in >> from >> count >> to;
+        return moveRange(columns, from, count, columns, to);
+    }
+    case RenameColumn: {
+        qint32 column;
+        QString title;
+        in >> column >> title;
+        if (column < 0 || column >= columns.size()) {
+            return false;
+        }
+        columns[column].title = title;
+        return true;
+    }
+    case AddItems: {
+        qint32 column, row;
+        QList<TodoItem> items;
+        in >> column >> row >> items;
+        if (column < 0 || column >= columns.size() || row < 0 || row > columns.at(column).items.size()) {
+            return false;
+        }
+        QList<TodoItem> &target = columns[column].items;
+        for (int i = 0; i < items.size(); ++i) {
+            target.insert(row + i, items.at(i));
+        }
+        return true;
+    }
+    case RemoveItems: {
+        qint32 column, row, count;
+        in >> column >> row >> count;
+        if (column < 0 || column >= columns.size() || row < 0 || count <= 0
+            || row + count > columns.at(column).items.size()) {
+            return false;
+        }
+        columns[column].items.remove(row, count);
+        return true;
+    }
+    case MoveItems: {
+        qint32 fromColumn, fromRow, count, toColumn, toRow;
+        in >> fromColumn >> fromRow >> count >> toColumn >> toRow;
+        if (fromColumn < 0 || fromColumn >= columns.size() || toColumn < 0 || toColumn >= columns.size()) {
+            return false;
+        }
+        return moveRange(columns[fromColumn].items, fromRow, count, columns[toColumn].items, toRow);
+    }
+    case SetItemText:
+    case SetItemChecked: {
+        qint32 column, row;
+        in >> column >> row;
+        if (column < 0 || column >= columns.size() || row < 0 || row >= columns.at(column).items.size()) {
+            return false;
+        }
+        TodoItem &item = columns[column].items[row];
+        if (operation == SetItemText) {
+            in >> item.text;
+        } else {
+            in >> item.checked >> item.checkedAt;
+        }
+        return true;
+    }
+    case ReorderItems: {
+        qint32 column;
+        QList<qint32> order;
+        in >> column >> order;
+        if (column < 0 || column >= columns.size() || order.size() != columns.at(column).items.size()) {
+            return false;
+        }
+        const QList<TodoItem> &items = columns.at(column).items;
+        QList<TodoItem> reordered;
+        reordered.reserve(order.size());
+        for (qint32 row : order) {
+            if (row < 0 || row >= items.size()) {
+                return false;
+            }
+            reordered.append(items.at(row));
+        }
+        columns[column].items = reordered;
+        return true;
+    }
+    case SetItemSchedule: {
+        qint32 column, row, repeatMinutes;
+        qint64 dueAt, remindAt;
+        in >> column >> row >> dueAt >> remindAt >> repeatMinutes;
+        if (column < 0 || column >= columns.size() || row < 0 || row >= columns.at(column).items.size()) {
+            return false;
+        }
+        TodoItem &item = columns[column].items[row];
+        item.dueAt = dueAt;
+        item.remindAt = remindAt;
+        item.repeatMinutes = repeatMinutes;
+        return true;
+    }
+    case ResetBoard: {
+        qint32 count;
+        in >> count;
+        columns.clear();
+        for (int i = 0; i < count; ++i) {
+            BoardColumnData col;
+            in >> col.title >> col.items;
+            columns.append(col);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool BoardJournal::open(quint64 sequence, quint64 stamp)
+{
+    close();
+
+    m_file.setFileName(m_fileName);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    //the edits of a journal left next to a file that was replaced meanwhile, e.g. by a
+    //sync client after a crash, are kept aside for recovery instead of being replayed
+    QByteArray content = m_file.readAll();
+    if (hasHeader(content) && headerStamp(content) != stamp) {
+        if (content.size() > HeaderSize) {
+            m_file.close();
+            const QString staleFileName = m_fileName + ".stale";
+            QFile::remove(staleFileName);
+            if (!QFile::rename(m_fileName, staleFileName) || !m_file.open(QIODevice::ReadWrite)) {
+                return false;
+            }
+            qWarning("The board file changed under its journal, the edits were kept in %s", qPrintable(staleFileName));
+        }
+        content.clear();
+    }
+    m_stamp = stamp;
+
+    //drop a torn record left behind by a crash so new records stay readable
+    quint64 lastSequence = 0;
+    qint64 validSize = scan(content, &lastSequence, nullptr);
+    if (validSize == 0) {
+        m_file.resize(0);
+        m_file.seek(0);
+        m_file.write(fileHeader(stamp));
+    } else if (validSize < content.size()) {
+        m_file.resize(validSize);
+    }
+    m_file.seek(m_file.size());
+    m_file.flush();
+
+    m_sequence = qMax(sequence, lastSequence);
+    return true;
+}
+
+void BoardJournal::close()
+{
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+void BoardJournal::attach(BoardModel *model)
+{
+    detach();
+    m_model = model;
+    connect(m_model, &BoardModel::rowsInserted, this, &BoardJournal::onRowsInserted);
+    connect(m_model, &BoardModel::rowsRemoved, this, &BoardJournal::onRowsRemoved);
+    connect(m_model, &BoardModel::rowsMoved, this, &BoardJournal::onRowsMoved);
+    connect(m_model, &BoardModel::dataChanged, this, &BoardJournal::onDataChanged);
+    connect(m_model, &BoardModel::modelReset, this, &BoardJournal::onModelReset);
+    connect(m_model, &BoardModel::itemsReordered, this, &BoardJournal::onItemsReordered);
+    connect(m_model, &BoardModel::batchStarted, this, &BoardJournal::onBatchStarted);
+    connect(m_model, &BoardModel::batchFinished, this, &BoardJournal::onBatchFinished);
+}
+
+void BoardJournal::detach()
+{
+    if (m_batched) {
+        onBatchFinished(); //nothing recorded is left behind in memory
+    }
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
+        m_model = nullptr;
+    }
+}
+
+void BoardJournal::setPaused(bool paused)
+{
+    m_paused = paused;
+}
+
+quint64 BoardJournal::sequence() const
+{
+    return m_sequence;
+}
+
+quint64 BoardJournal::stamp() const
+{
+    return m_stamp;
+}
+
+qint64 BoardJournal::size() const
+{
+    return m_file.isOpen() ? m_file.size() : 0;
+}
+
+bool BoardJournal::isEmpty() const
+{
+    return size() <= HeaderSize && m_batch.isEmpty();
+}
+
+bool BoardJournal::discardUpTo(quint64 sequence, quint64 stamp)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    m_file.seek(0);
+    QList<QPair<quint64, QByteArray>> records;
+    scan(m_file.readAll(), nullptr, &records);
+
+    QByteArray content = fileHeader(stamp);
+    for (const auto &record : records) {
+        if (record.first <= sequence) {
+            continue;
+        }
+        QDataStream out(&content, QIODevice::Append);
+        out << quint32(record.second.size()) << qChecksum(record.second);
+        content.append(record.second);
+    }
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_file.seek(m_file.size());
+        return false;
+    }
+    file.write(content);
+    m_file.close();
+    bool ok = file.commit();
+    if (ok) {
+        m_stamp = stamp;
+    }
+
+    //keep appending to whichever file is now in place
+    m_file.open(QIODevice::ReadWrite);
+    m_file.seek(m_file.size());
+    return ok;
+}
+
+void BoardJournal::writeRecord(const QByteArray &payload)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out << quint32(payload.size()) << qChecksum(payload);
+    record.append(payload);
+    if (m_batched) {
+        m_batch.append(record);
+        return;
+    }
+
+    m_file.write(record);
+    m_file.flush(); //hand it to the OS now, a crash of the app must not lose it
+    emit recordWritten();
+}
+
+void BoardJournal::onBatchStarted()
+{
+    m_batched = true;
+}
+
+void BoardJournal::onBatchFinished()
+{
+    //a bulk edit of thousands of todos is one write and one flush, not one per todo
+    m_batched = false;
+    if (m_batch.isEmpty() || !m_file.isOpen()) {
+        m_batch.clear();
+        return;
+    }
+    m_file.write(m_batch);
+    m_file.flush();
+    m_batch.clear();
+    emit recordWritten();
+}
+
+void BoardJournal::startRecord(QDataStream &out, quint8 operation)
+{
+    out.setVersion(QDataStream::Qt_6_0);
+    out << ++m_sequence << operation;
+}
+
+void BoardJournal::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (m_paused) {
+        return;
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+
+    if (!parent.isValid()) {
+        startRecord(out, AddColumns);
+        out << qint32(first) << qint32(last - first + 1);
+        for (int column = first; column <= last; ++column) {
+            out << m_model->boardColumnTitle(column) << m_model->items(column);
+        }
+    } else {
+        QList<TodoItem> items;
+        for (int row = first; row <= last; ++row) {
+            items.append(m_model->item(parent.row(), row));
+        }
+        startRecord(out, AddItems);
+        out << qint32(parent.row()) << qint32(first) << items;
+    }
+    writeRecord(payload);
+}
+
+void BoardJournal::onRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (m_paused) {
+        return;
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+
+    if (!parent.isValid()) {
+        startRecord(out, RemoveColumns);
+        out << qint32(first) << qint32(last - first + 1);
+    } else {
+        startRecord(out, RemoveItems);
+        out << qint32(parent.row()) << qint32(first) << qint32(last - first + 1);
+    }
+    writeRecord(payload);
+}
+
+void BoardJournal::onRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row)
+{
+    if (m_paused) {
+        return;
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+
+    if (!parent.isValid()) {
+        startRecord(out, MoveColumns);
+        out << qint32(start) << qint32(end - start + 1) << qint32(row);
+    } else {
+        startRecord(out, MoveItems);
+        out << qint32(parent.row()) << qint32(start) << qint32(end - start + 1)
+            << qint32(destination.row()) << qint32(row);
+    }
+    writeRecord(payload);
+}
+
+void BoardJournal::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    if (m_paused) {
+        return;
+    }
+
+    const QModelIndex parent = topLeft.parent();
+    const bool textChanged = roles.isEmpty() || roles.contains(Qt::DisplayRole) || roles.contains(Qt::EditRole);
+    const bool checkChanged = roles.isEmpty() || roles.contains(Qt::CheckStateRole);
+    const bool scheduleChanged = roles.isEmpty() || roles.contains(BoardModel::DueAtRole);
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        if (!parent.isValid()) {
+            if (textChanged) {
+                QByteArray payload;
+                QDataStream out(&payload, QIODevice::WriteOnly);
+                startRecord(out, RenameColumn);
+                out << qint32(row) << m_model->boardColumnTitle(row);
+                writeRecord(payload);
+            }
+            continue;
+        }
+
+        const TodoItem item = m_model->item(parent.row(), row);
+        if (textChanged) {
+            QByteArray payload;
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            startRecord(out, SetItemText);
+            out << qint32(parent.row()) << qint32(row) << item.text;
+            writeRecord(payload);
+        }
+        if (checkChanged) {
+            QByteArray payload;
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            startRecord(out, SetItemChecked);
+            out << qint32(parent.row()) << qint32(row) << item.checked << item.checkedAt;
+            writeRecord(payload);
+        }
+        if (scheduleChanged) {
+            QByteArray payload;
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            startRecord(out, SetItemSchedule);
+            out << qint32(parent.row()) << qint32(row) << item.dueAt << item.remindAt << qint32(item.repeatMinutes);
+            writeRecord(payload);
+        }
+    }
+}
+
+void BoardJournal::onItemsReordered(int column, const QList<int> &order)
+{
+    if (m_paused) {
+        return;
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    startRecord(out, ReorderItems);
+    out << qint32(column) << order;
+    writeRecord(payload);
+}
+
+void BoardJournal::onModelReset()
+{
+    if (m_paused) {
+        return;
+    }
+
+    //no cheap delta for a reset, log the whole board once
+    BoardData data = m_model->boardData();
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    startRecord(out, ResetBoard);
+    out << qint32(data.columns.size());
+    for (const BoardColumnData &column : data.columns) {
+        out << column.title << column.items;
+    }
+    writeRecord(payload);
+}
@@ -0,0 +1,94 @@
+#ifndef BOARDJOURNAL_H
+#define BOARDJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QModelIndex>
+#include "boarddata.h"
+
+class BoardModel;
+
+//append-only log of board edits next to the snapshot file, every change made
+//to the attached model is written as a small checksummed record right away;
+//the records of a batch (BoardModel::beginBatch) go out in a single write
+class BoardJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BoardJournal(const QString &fileName, QObject *parent = nullptr);
+    ~BoardJournal() override;
+
+    QString fileName() const;
+
+    //applies every record newer than data->sequence, stops at a damaged tail or a
+    //record that does not fit; nothing is applied when the journal continues another
+    //snapshot than data->stamp
+    bool replay(BoardData *data) const;
+
+    //opens the file for appending, new records continue after sequence on the snapshot
+    //stamp; a journal of another snapshot is moved aside to fileName() + ".stale"
+    bool open(quint64 sequence, quint64 stamp);
+    void close();
+
+    void attach(BoardModel *model);
+    void detach();
+
+    //while paused, changes to the model are not recorded
+    void setPaused(bool paused);
+
+    quint64 sequence() const;
+    quint64 stamp() const;
+    qint64 size() const;
+    bool isEmpty() const; //no records since the last snapshot
+
+    //rewrites the file keeping only records newer than sequence, which now
+    //continue the snapshot stamp
+    bool discardUpTo(quint64 sequence, quint64 stamp);
+
+signals:
+    void recordWritten();
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void onModelReset();
+    void onItemsReordered(int column, const QList<int> &order);
+    void onBatchStarted();
+    void onBatchFinished();
+
+private:
+    enum Operation : quint8 {
+        AddColumns = 1,
+        RemoveColumns,
+        MoveColumns,
+        RenameColumn,
+        AddItems,
+        RemoveItems,
+        MoveItems,
+        SetItemText,
+        SetItemChecked,
+        ResetBoard,
+        ReorderItems,
+        SetItemSchedule
+    };
+
+    void startRecord(QDataStream &out, quint8 operation);
+    void writeRecord(const QByteArray &payload);
+    static bool applyRecord(const QByteArray &payload, BoardData *data);
+    //walks the records of a journal file, returns the offset after the last good one
+    static qint64 scan(const QByteArray &content, quint64 *lastSequence, QList<QPair<quint64, QByteArray>> *records);
+
+    QString m_fileName;
+    QFile m_file;
+    BoardModel *m_model = nullptr;
+    quint64 m_sequence = 0;
+    quint64 m_stamp = 0;
+    bool m_paused = false;
+    bool m_batched = false;
+    QByteArray m_batch; //records of the batch in progress, written when it ends
+};
+
+#endif
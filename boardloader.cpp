@@ -0,0 +1,162 @@
+#include "boardloader.h"
+#include "boardmodel.h"
+#include "boardstorage.h"
+#include <QElapsedTimer>
+#include "startupprofile.h"
+#include "tracer.h"
+
+namespace {
+const qint64 BatchBudgetNs = 4 * 1000 * 1000; //time spent inserting per event loop turn
+const int BatchSize = 64;                     //todos inserted between two clock checks
+}
+
+BoardLoader::BoardLoader(BoardStorage *storage, BoardModel *model, QObject *parent)
+    : QObject(parent)
+    , m_storage(storage)
+    , m_model(model)
+{
+    m_batchTimer.setInterval(0);
+    connect(&m_batchTimer, &QTimer::timeout, this, &BoardLoader::insertBatch);
+}
+
+BoardLoader::~BoardLoader()
+{
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+void BoardLoader::setVisibilityCheck(const std::function<bool(int column)> &check)
+{
+    m_isVisible = check;
+}
+
+void BoardLoader::start()
+{
+    m_loading = true;
+
+    //reading the snapshot and replaying the journal happen off the GUI thread
+    m_thread = QThread::create([this]() {
+        BoardData snapshot;
+        m_data = m_storage->load(&snapshot);
+        m_base = MergeBase(snapshot);
+    });
+    m_thread->setObjectName("BoardLoader");
+    connect(m_thread, &QThread::finished, this, &BoardLoader::onParsed);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+    m_thread->start();
+}
+
+bool BoardLoader::isLoading() const
+{
+    return m_loading;
+}
+
+bool BoardLoader::isColumnLoading(int column) const
+{
+    if (m_thread) {
+        return true; //the file is still being read, every column the window shows waits for it
+    }
+    for (const PendingColumn &pending : m_pending) {
+        if (pending.index.row() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+MergeBase BoardLoader::base() const
+{
+    return m_base;
+}
+
+void BoardLoader::onParsed()
+{
+    TRACE_SPAN("create columns");
+    StartupProfile::mark("board parsed");
+    m_thread = nullptr;
+
+    //headers first, every column shows up empty right away; the window may show
+    //them already from the titles the board index keeps, then they stay as they are
+    bool shown = m_model->boardColumnCount() == m_data.columns.size();
+    BoardData headers;
+    headers.sequence = m_data.sequence;
+    for (int c = 0; c < m_data.columns.size(); ++c) {
+        BoardColumnData header;
+        header.title = m_data.columns.at(c).title;
+        headers.columns.append(header);
+        shown = shown && m_model->boardColumnTitle(c) == header.title && m_model->itemCount(c) == 0;
+    }
+    if (!shown) {
+        m_model->setBoardData(headers);
+    }
+
+    //edits made from now on are journaled, the todos inserted below are not
+    m_storage->attach(m_model, m_data.sequence, m_data.stamp);
+    m_storage->setLoading(true);
+
+    for (int c = 0; c < m_data.columns.size(); ++c) {
+        if (m_data.columns.at(c).items.isEmpty()) {
+            continue;
+        }
+        PendingColumn pending;
+        pending.index = m_model->boardColumnIndex(c);
+        pending.items = m_data.columns.at(c).items;
+        m_pending.append(pending);
+    }
+    m_data = BoardData();
+
+    emit columnsReady();
+    insertBatch();
+    if (m_loading) {
+        m_batchTimer.start();
+    }
+}
+
+int BoardLoader::nextPendingColumn() const
+{
+    if (m_isVisible) {
+        for (int i = 0; i < m_pending.size(); ++i) {
+            if (m_isVisible(m_pending.at(i).index.row())) {
+                return i;
+            }
+        }
+    }
+    return 0; //nothing on screen left, fill the others in order
+}
+
+void BoardLoader::insertBatch()
+{
+    TRACE_SPAN("insert batch");
+    QElapsedTimer budget;
+    budget.start();
+
+    m_storage->setJournalPaused(true);
+    while (!m_pending.isEmpty() && budget.nsecsElapsed() < BatchBudgetNs) {
+        int i = nextPendingColumn();
+        PendingColumn &pending = m_pending[i];
+        if (!pending.index.isValid()) { //column got deleted while loading
+            m_pending.removeAt(i);
+            continue;
+        }
+
+        //the column stays locked until it is complete, so rows line up with the file
+        int column = pending.index.row();
+        int count = qMin(BatchSize, int(pending.items.size()) - pending.next);
+        m_model->insertItems(column, pending.next, pending.items.mid(pending.next, count));
+        pending.next += count;
+
+        if (pending.next == pending.items.size()) {
+            m_pending.removeAt(i);
+            emit columnLoaded(column);
+        }
+    }
+    m_storage->setJournalPaused(false);
+
+    if (m_pending.isEmpty()) {
+        m_batchTimer.stop();
+        m_loading = false;
+        m_storage->setLoading(false);
+        emit finished();
+    }
+}
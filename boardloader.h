@@ -0,0 +1,65 @@
+#ifndef BOARDLOADER_H
+#define BOARDLOADER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QPersistentModelIndex>
+#include <functional>
+#include "boarddata.h"
+#include "boardmerge.h"
+
+class BoardModel;
+class BoardStorage;
+
+//loads the board without blocking the window: the file is parsed on a worker,
+//then the column headers go in at once and the todos follow in small batches,
+//a few milliseconds per event loop turn, visible columns first
+class BoardLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    BoardLoader(BoardStorage *storage, BoardModel *model, QObject *parent = nullptr);
+    ~BoardLoader() override;
+
+    //tells the loader which columns the user can currently see
+    void setVisibilityCheck(const std::function<bool(int column)> &check);
+
+    void start();
+    bool isLoading() const;
+    bool isColumnLoading(int column) const; //true for all of them until the file is read
+    //the file as it was read, before the journal was replayed onto it
+    MergeBase base() const;
+
+signals:
+    void columnsReady();
+    void columnLoaded(int column);
+    void finished();
+
+private slots:
+    void onParsed();
+    void insertBatch();
+
+private:
+    struct PendingColumn
+    {
+        QPersistentModelIndex index; //follows the column if it gets moved meanwhile
+        QList<TodoItem> items;
+        int next = 0;
+    };
+
+    int nextPendingColumn() const;
+
+    BoardStorage *m_storage;
+    BoardModel *m_model;
+    QThread *m_thread = nullptr;
+    QTimer m_batchTimer;
+    BoardData m_data;
+    MergeBase m_base;
+    QList<PendingColumn> m_pending;
+    std::function<bool(int column)> m_isVisible;
+    bool m_loading = false;
+};
+
+#endif
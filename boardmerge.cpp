@@ -0,0 +1,384 @@
+#include "boardmerge.h"
+#include "boardmodel.h"
+#include <QSet>
+
+namespace {
+//what a todo says and where it sits, the todo above it stands for its place in the column
+struct Entry
+{
+    QString column;
+    quint64 previous = 0;
+    QString text;
+    bool checked = false;
+    qint64 dueAt = 0;
+    qint32 repeatMinutes = 0;
+};
+
+QHash<quint64, Entry> entries(const BoardData &data)
+{
+    QHash<quint64, Entry> result;
+    for (const BoardColumnData &column : data.columns) {
+        quint64 previous = 0;
+        for (const TodoItem &item : column.items) {
+            if (item.id != 0) {
+                result.insert(item.id, Entry{column.title, previous, item.text, item.checked, item.dueAt, item.repeatMinutes});
+            }
+            previous = item.id;
+        }
+    }
+    return result;
+}
+
+QSet<QString> titles(const BoardData &data)
+{
+    QSet<QString> result;
+    for (const BoardColumnData &column : data.columns) {
+        result.insert(column.title);
+    }
+    return result;
+}
+
+//a hash stands in for the text of the base, equal hashes are taken as the same text
+bool textChanged(const QString &text, size_t baseHash)
+{
+    return qHash(text) != baseHash;
+}
+
+//first line of a todo, short enough for a message
+QString label(const QString &text)
+{
+    QString line = text.section('\n', 0, 0).trimmed();
+    if (line.size() > 40) {
+        line = line.left(39) + QChar(0x2026);
+    }
+    return "'" + line + "'";
+}
+
+int findColumn(const BoardModel *model, const QString &title)
+{
+    for (int c = 0; c < model->boardColumnCount(); ++c) {
+        if (model->boardColumnTitle(c) == title) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+//where each todo of the model sits, kept up to date while the merge inserts and
+//moves todos, so finding one is a lookup instead of a walk over the board
+class Locations
+{
+public:
+    explicit Locations(const BoardModel *model)
+        : m_model(model)
+    {
+        for (int c = 0; c < model->boardColumnCount(); ++c) {
+            update(c, 0);
+        }
+    }
+
+    bool find(quint64 id, int *column, int *row) const
+    {
+        auto it = m_rows.constFind(id);
+        if (it == m_rows.cend()) {
+            return false;
+        }
+        *column = it->first;
+        *row = it->second;
+        return true;
+    }
+
+    int row(int column, quint64 id) const
+    {
+        auto it = m_rows.constFind(id);
+        return it != m_rows.cend() && it->first == column ? it->second : -1;
+    }
+
+    //the todos from row on shifted, e.g. after an insert or a move
+    void update(int column, int row)
+    {
+        const int count = m_model->itemCount(column);
+        for (; row < count; ++row) {
+            m_rows.insert(m_model->itemId(column, row), qMakePair(column, row));
+        }
+    }
+
+private:
+    const BoardModel *m_model;
+    QHash<quint64, QPair<int, int>> m_rows;
+};
+}
+
+MergeBase::MergeBase(const BoardData &data)
+{
+    for (const BoardColumnData &column : data.columns) {
+        addColumn(column.title);
+        for (const TodoItem &item : column.items) {
+            addItem(item.id, item.text, item.checked, item.dueAt, item.repeatMinutes);
+        }
+    }
+}
+
+MergeBase::MergeBase(const BoardSnapshot &snapshot)
+{
+    for (int c = 0; c < snapshot.columnCount(); ++c) {
+        addColumn(snapshot.columnTitle(c));
+        for (int row = 0; row < snapshot.itemCount(c); ++row) {
+            addItem(snapshot.itemId(c, row), snapshot.itemText(c, row), snapshot.isItemChecked(c, row),
+                    snapshot.itemDueAt(c, row), snapshot.itemRepeatMinutes(c, row));
+        }
+    }
+}
+
+qint64 MergeBase::byteSize() const
+{
+    qint64 bytes = m_entries.size() * qint64(sizeof(quint64) + sizeof(Entry) + sizeof(void*));
+    for (const QString &title : m_titles) {
+        bytes += title.size() * qint64(sizeof(QChar));
+    }
+    return bytes;
+}
+
+bool MergeBase::operator==(const MergeBase &other) const
+{
+    return m_todoCount == other.m_todoCount && m_titles == other.m_titles && m_entries == other.m_entries;
+}
+
+bool MergeBase::Entry::operator==(const Entry &other) const
+{
+    return column == other.column && previous == other.previous && textHash == other.textHash
+           && checked == other.checked && dueAt == other.dueAt && repeatMinutes == other.repeatMinutes;
+}
+
+void MergeBase::addColumn(const QString &title)
+{
+    m_titles.append(title);
+    m_previous = 0;
+}
+
+void MergeBase::addItem(quint64 id, QStringView text, bool checked, qint64 dueAt, qint32 repeatMinutes)
+{
+    if (id != 0) {
+        m_entries.insert(id, Entry{int(m_titles.size() - 1), m_previous, qHash(text), checked, dueAt, repeatMinutes});
+    }
+    m_previous = id;
+    ++m_todoCount;
+}
+
+MergeResult BoardMerge::apply(const MergeBase &base, const BoardData &theirs, BoardModel *model)
+{
+    MergeResult result;
+    const QHash<quint64, MergeBase::Entry> &baseEntries = base.m_entries;
+    const QHash<quint64, Entry> theirEntries = entries(theirs);
+    QHash<quint64, Entry> ourEntries = entries(model->boardData());
+    const QSet<QString> baseTitles(base.m_titles.cbegin(), base.m_titles.cend());
+    const QSet<QString> theirTitles = titles(theirs);
+
+    //one notification and one journal flush for the whole merge
+    model->beginBatch();
+
+    //columns new in the file, renamed ones show up as removed plus added
+    for (int c = 0; c < theirs.columns.size(); ++c) {
+        const QString &title = theirs.columns.at(c).title;
+        if (!baseTitles.contains(title) && findColumn(model, title) < 0) {
+            model->insertBoardColumn(qMin(c, model->boardColumnCount()), title);
+            ++result.changes;
+        }
+    }
+
+    //text, checkbox and due date, field by field; nothing moves here
+    Locations locations(model);
+    for (auto it = theirEntries.cbegin(); it != theirEntries.cend(); ++it) {
+        auto was = baseEntries.constFind(it.key());
+        if (was == baseEntries.cend()) {
+            continue; //new in the file, inserted further down
+        }
+        const Entry &their = it.value();
+        auto our = ourEntries.constFind(it.key());
+        if (our == ourEntries.cend()) {
+            if (textChanged(their.text, was->textHash) || their.checked != was->checked) {
+                result.conflicts.append(QString("%1 was changed in the file but deleted here").arg(label(their.text)));
+            }
+            continue;
+        }
+
+        int column = -1;
+        int row = -1;
+        locations.find(it.key(), &column, &row);
+        bool conflict = false;
+        if (textChanged(their.text, was->textHash) && their.text != our->text) {
+            if (!textChanged(our->text, was->textHash)) {
+                model->setItemText(column, row, their.text);
+                ++result.changes;
+            } else {
+                conflict = true;
+            }
+        }
+        if (their.checked != was->checked && their.checked != our->checked) {
+            model->setItemChecked(column, row, their.checked);
+            ++result.changes;
+        }
+        //due date and repeat go together, like the text only one side may have changed them
+        bool scheduleConflict = false;
+        if ((their.dueAt != was->dueAt || their.repeatMinutes != was->repeatMinutes)
+            && (their.dueAt != our->dueAt || their.repeatMinutes != our->repeatMinutes)) {
+            if (our->dueAt == was->dueAt && our->repeatMinutes == was->repeatMinutes) {
+                model->setItemSchedule(column, row, their.dueAt, their.repeatMinutes);
+                ++result.changes;
+            } else {
+                scheduleConflict = true;
+            }
+        }
+        if (conflict) {
+            result.conflicts.append(QString("%1 was edited here and in the file, kept the edit made here").arg(label(our->text)));
+        }
+        if (scheduleConflict) {
+            result.conflicts.append(QString("%1 was given a different due date here and in the file, kept the one set here")
+                                    .arg(label(our->text)));
+        }
+    }
+
+    //todos gone from the file, unless they were changed here meanwhile
+    QSet<quint64> removed;
+    for (auto it = baseEntries.cbegin(); it != baseEntries.cend(); ++it) {
+        auto our = ourEntries.constFind(it.key());
+        if (theirEntries.contains(it.key()) || our == ourEntries.cend()) {
+            continue;
+        }
+        if (textChanged(our->text, it->textHash) || our->checked != it->checked) {
+            result.conflicts.append(QString("%1 was deleted in the file but changed here, kept it").arg(label(our->text)));
+            continue;
+        }
+        removed.insert(it.key());
+        ourEntries.erase(our);
+    }
+    if (!removed.isEmpty()) {
+        //bottom up in runs, one notification per run instead of per todo
+        for (int c = 0; c < model->boardColumnCount(); ++c) {
+            int row = model->itemCount(c) - 1;
+            while (row >= 0) {
+                int end = row;
+                while (row >= 0 && removed.contains(model->itemId(c, row))) {
+                    --row;
+                }
+                if (row < end) {
+                    model->removeItems(c, row + 1, end - row);
+                    result.changes += end - row;
+                } else {
+                    --row;
+                }
+            }
+        }
+        locations = Locations(model);
+    }
+
+    //new todos and todos moved in the file, walking each of its columns top to bottom
+    QSet<quint64> seen;
+    for (const BoardColumnData &theirColumn : theirs.columns) {
+        const QString &title = theirColumn.title;
+        quint64 previous = 0; //last todo already in its place here, the next one goes below it
+        QList<TodoItem> run;  //new todos in a row, inserted together
+
+        auto insertRun = [&]() {
+            if (run.isEmpty()) {
+                return;
+            }
+            int column = findColumn(model, title);
+            if (column < 0) {
+                if (baseTitles.contains(title)) {
+                    result.conflicts.append(QString("%1 todos were added in the file to '%2', which was deleted here")
+                                            .arg(run.size()).arg(title));
+                    run.clear();
+                    return;
+                }
+                column = model->boardColumnCount();
+                model->insertBoardColumn(column, title);
+                ++result.changes;
+            }
+            const int row = previous ? locations.row(column, previous) + 1 : 0;
+            model->insertItems(column, row, run);
+            locations.update(column, row);
+            for (int i = 0; i < run.size(); ++i) {
+                ourEntries.insert(model->itemId(column, row + i),
+                                  Entry{title, 0, run.at(i).text, run.at(i).checked, run.at(i).dueAt, run.at(i).repeatMinutes});
+            }
+            previous = model->itemId(column, row + run.size() - 1);
+            result.changes += run.size();
+            run.clear();
+        };
+
+        for (const TodoItem &item : theirColumn.items) {
+            const bool duplicate = item.id != 0 && seen.contains(item.id);
+            seen.insert(item.id);
+            const bool isNew = !baseEntries.contains(item.id);
+            //both sides handed out the same id to a todo of their own
+            const bool clash = isNew && ourEntries.contains(item.id) && ourEntries.value(item.id).text != item.text;
+            if (item.id == 0 || duplicate || clash || (isNew && !ourEntries.contains(item.id))) {
+                TodoItem added = item;
+                if (duplicate || clash) {
+                    added.id = 0; //gets an id of its own
+                }
+                run.append(added);
+                continue;
+            }
+            insertRun(); //before looking up, it adds to ourEntries
+            auto our = ourEntries.find(item.id);
+            if (our == ourEntries.end()) {
+                continue; //deleted here
+            }
+
+            auto was = baseEntries.constFind(item.id);
+            if (was != baseEntries.cend()) {
+                const Entry &their = theirEntries.value(item.id);
+                const QString &baseColumn = base.m_titles.at(was->column);
+                const bool theyChangedColumn = their.column != baseColumn;
+                const bool weChangedColumn = our->column != baseColumn;
+                const bool theyReordered = their.previous != was->previous;
+                const bool weReordered = our->previous != was->previous;
+
+                if (theyChangedColumn && weChangedColumn && our->column != their.column) {
+                    result.conflicts.append(QString("%1 was moved to '%2' here and to '%3' in the file, kept it in '%2'")
+                                            .arg(label(our->text), our->column, their.column));
+                } else if ((theyChangedColumn && !weChangedColumn) || (theyReordered && !weChangedColumn && !weReordered)) {
+                    int fromColumn = -1;
+                    int fromRow = -1;
+                    const int toColumn = findColumn(model, title);
+                    if (toColumn >= 0 && locations.find(item.id, &fromColumn, &fromRow)) {
+                        const int toRow = previous ? locations.row(toColumn, previous) + 1 : 0;
+                        if (model->moveItem(fromColumn, fromRow, toColumn, toRow)) {
+                            if (fromColumn == toColumn) {
+                                locations.update(toColumn, qMin(fromRow, toRow));
+                            } else {
+                                locations.update(fromColumn, fromRow);
+                                locations.update(toColumn, toRow);
+                            }
+                            ++result.changes;
+                        }
+                        our->column = title;
+                    }
+                }
+            }
+            if (our->column == title) {
+                previous = item.id;
+            }
+        }
+        insertRun();
+    }
+
+    //columns gone from the file go once nothing is left in them
+    for (const QString &title : baseTitles) {
+        const int column = theirTitles.contains(title) ? -1 : findColumn(model, title);
+        if (column < 0) {
+            continue;
+        }
+        if (model->itemCount(column) == 0) {
+            model->removeBoardColumn(column);
+            ++result.changes;
+        } else {
+            result.conflicts.append(QString("Column '%1' was deleted in the file but still has todos here, kept it").arg(title));
+        }
+    }
+
+    model->endBatch();
+    return result;
+}
@@ -0,0 +1,66 @@
+#ifndef BOARDMERGE_H
+#define BOARDMERGE_H
+
+#include <QHash>
+#include <QStringList>
+#include "boarddata.h"
+
+class BoardModel;
+class BoardSnapshot;
+
+struct MergeResult
+{
+    int changes = 0;       //edits applied to the model
+    QStringList conflicts; //todos changed on both sides, the local version was kept
+};
+
+//the board a file held as far as a merge needs to know it: for every todo its
+//column, the todo above it and a hash of its text, never the text itself, so
+//keeping it around for the whole session costs a few words per todo
+class MergeBase
+{
+public:
+    MergeBase() = default;
+    explicit MergeBase(const BoardData &data);
+    explicit MergeBase(const BoardSnapshot &snapshot);
+
+    //memory it holds, roughly
+    qint64 byteSize() const;
+
+    bool operator==(const MergeBase &other) const;
+    bool operator!=(const MergeBase &other) const { return !(*this == other); }
+
+private:
+    friend class BoardMerge;
+
+    struct Entry
+    {
+        int column = 0; //in m_titles
+        quint64 previous = 0;
+        size_t textHash = 0;
+        bool checked = false;
+        qint64 dueAt = 0;
+        qint32 repeatMinutes = 0;
+
+        bool operator==(const Entry &other) const;
+    };
+
+    void addColumn(const QString &title);
+    void addItem(quint64 id, QStringView text, bool checked, qint64 dueAt, qint32 repeatMinutes);
+
+    QStringList m_titles;
+    QHash<quint64, Entry> m_entries;
+    int m_todoCount = 0;  //with the ones that have no id yet
+    quint64 m_previous = 0; //while adding
+};
+
+//three-way merge of a board changed outside the app into the open one: todos are
+//matched by id, and only what differs between base (the file as the app last knew
+//it) and theirs (the file now) is applied, through the usual model edits
+class BoardMerge
+{
+public:
+    static MergeResult apply(const MergeBase &base, const BoardData &theirs, BoardModel *model);
+};
+
+#endif
@@ -0,0 +1,967 @@
+#include "boardmodel.h"
+#include <QCollator>
+#include <QDateTime>
+#include <QLocale>
+#include <QSet>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+enum ItemFlag : quint8
+{
+    Checked = 0x1,
+    Scheduled = 0x2 //has an entry in m_schedules
+};
+
+template <typename T>
+void insertRange(QList<T> &list, int at, const QList<T> &values)
+{
+    if (at == list.size()) {
+        list.append(values);
+        return;
+    }
+    list.insert(at, values.size(), T());
+    std::copy(values.cbegin(), values.cend(), list.begin() + at);
+}
+
+template <typename T>
+QList<T> reordered(const QList<T> &list, const QList<int> &order)
+{
+    QList<T> result;
+    result.reserve(order.size());
+    for (int row : order) {
+        result.append(list.at(row));
+    }
+    return result;
+}
+}
+
+//the todos of a column as parallel arrays, row for row, so a todo costs its fields
+//and no padding: 8 bytes id, 4 text handle into m_texts, 8 time it was checked, 1 flags
+struct BoardModel::Column
+{
+    QString title;
+    QList<quint64> ids;
+    QList<quint32> texts;
+    QList<qint64> checkedAt;
+    QList<quint8> flags;
+
+    int size() const
+    {
+        return ids.size();
+    }
+
+    //count empty rows at row
+    void insert(int row, int count)
+    {
+        ids.insert(row, count, 0);
+        texts.insert(row, count, 0);
+        checkedAt.insert(row, count, 0);
+        flags.insert(row, count, 0);
+    }
+
+    void insert(int row, const Column &rows)
+    {
+        insertRange(ids, row, rows.ids);
+        insertRange(texts, row, rows.texts);
+        insertRange(checkedAt, row, rows.checkedAt);
+        insertRange(flags, row, rows.flags);
+    }
+
+    Column mid(int row, int count) const
+    {
+        Column rows;
+        rows.ids = ids.mid(row, count);
+        rows.texts = texts.mid(row, count);
+        rows.checkedAt = checkedAt.mid(row, count);
+        rows.flags = flags.mid(row, count);
+        return rows;
+    }
+
+    void remove(int row, int count)
+    {
+        ids.remove(row, count);
+        texts.remove(row, count);
+        checkedAt.remove(row, count);
+        flags.remove(row, count);
+    }
+
+    //order lists the old row of every new row
+    void reorder(const QList<int> &order)
+    {
+        ids = reordered(ids, order);
+        texts = reordered(texts, order);
+        checkedAt = reordered(checkedAt, order);
+        flags = reordered(flags, order);
+    }
+};
+
+struct BoardSnapshot::Data
+{
+    QList<BoardModel::Column> columns;
+    TextArena texts;
+    QHash<quint64, BoardModel::Schedule> schedules;
+};
+
+int BoardSnapshot::columnCount() const
+{
+    return d ? d->columns.size() : 0;
+}
+
+QString BoardSnapshot::columnTitle(int column) const
+{
+    return d->columns.at(column).title;
+}
+
+int BoardSnapshot::itemCount(int column) const
+{
+    return d->columns.at(column).size();
+}
+
+quint64 BoardSnapshot::itemId(int column, int row) const
+{
+    return d->columns.at(column).ids.at(row);
+}
+
+QStringView BoardSnapshot::itemText(int column, int row) const
+{
+    return d->texts.view(d->columns.at(column).texts.at(row));
+}
+
+bool BoardSnapshot::isItemChecked(int column, int row) const
+{
+    return d->columns.at(column).flags.at(row) & Checked;
+}
+
+qint64 BoardSnapshot::itemDueAt(int column, int row) const
+{
+    const BoardModel::Column &col = d->columns.at(column);
+    return col.flags.at(row) & Scheduled ? d->schedules.value(col.ids.at(row)).dueAt : 0;
+}
+
+int BoardSnapshot::itemRepeatMinutes(int column, int row) const
+{
+    const BoardModel::Column &col = d->columns.at(column);
+    return col.flags.at(row) & Scheduled ? d->schedules.value(col.ids.at(row)).repeatMinutes : 0;
+}
+
+BoardData BoardSnapshot::toBoardData() const
+{
+    BoardData data;
+    data.sequence = sequence;
+    data.stamp = stamp;
+    data.columns.reserve(columnCount());
+    for (int c = 0; c < columnCount(); ++c) {
+        const BoardModel::Column &col = d->columns.at(c);
+        BoardColumnData column;
+        column.title = col.title;
+        column.items.reserve(col.size());
+        for (int row = 0; row < col.size(); ++row) {
+            TodoItem item;
+            item.text = d->texts.text(col.texts.at(row));
+            item.checked = col.flags.at(row) & Checked;
+            item.id = col.ids.at(row);
+            item.checkedAt = col.checkedAt.at(row);
+            if (col.flags.at(row) & Scheduled) {
+                const BoardModel::Schedule schedule = d->schedules.value(item.id);
+                item.dueAt = schedule.dueAt;
+                item.remindAt = schedule.remindAt;
+                item.repeatMinutes = schedule.repeatMinutes;
+            }
+            column.items.append(item);
+        }
+        data.columns.append(column);
+    }
+    return data;
+}
+
+qint64 BoardSnapshot::byteSize() const
+{
+    if (!d) {
+        return 0;
+    }
+    //per todo its row in the column lists, per schedule a hash node
+    const qint64 rowBytes = sizeof(quint64) + sizeof(quint32) + sizeof(qint64) + sizeof(quint8);
+    const qint64 scheduleBytes = sizeof(quint64) + sizeof(BoardModel::Schedule) + sizeof(void*);
+    qint64 bytes = d->texts.byteSize() + d->schedules.size() * scheduleBytes;
+    for (const BoardModel::Column &col : d->columns) {
+        bytes += col.title.size() * qint64(sizeof(QChar)) + col.size() * rowBytes;
+    }
+    return bytes;
+}
+
+BoardModel::BoardModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+BoardModel::~BoardModel()
+{
+    qDeleteAll(m_columns);
+}
+
+QModelIndex BoardModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0) {
+        return QModelIndex();
+    }
+
+    if (!parent.isValid()) {
+        //column rows carry no pointer
+        return row < m_columns.size() ? createIndex(row, 0, nullptr) : QModelIndex();
+    }
+
+    if (parent.internalPointer()) { //todos have no children
+        return QModelIndex();
+    }
+
+    Column *col = m_columns.value(parent.row());
+    if (!col || row >= col->size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, col);
+}
+
+QModelIndex BoardModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || !child.internalPointer()) {
+        return QModelIndex();
+    }
+
+    Column *col = static_cast<Column*>(child.internalPointer());
+    return createIndex(m_columns.indexOf(col), 0, nullptr);
+}
+
+int BoardModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_columns.size();
+    }
+    if (parent.column() != 0 || parent.internalPointer()) {
+        return 0;
+    }
+    return m_columns.at(parent.row())->size();
+}
+
+int BoardModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 1;
+}
+
+QVariant BoardModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    if (!index.internalPointer()) {
+        const Column *col = m_columns.at(index.row());
+        if (role == Qt::DisplayRole || role == Qt::EditRole) {
+            return col->title;
+        }
+        return QVariant();
+    }
+
+    const Column *col = static_cast<Column*>(index.internalPointer());
+    const int row = index.row();
+    const bool checked = col->flags.at(row) & Checked;
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+    case Qt::AccessibleTextRole:
+        return m_texts.text(col->texts.at(row));
+    case Qt::CheckStateRole:
+        return checked ? Qt::Checked : Qt::Unchecked;
+    case ItemIdRole:
+        return col->ids.at(row);
+    case DueAtRole:
+        return scheduleAt(col, row).dueAt;
+    case Qt::ToolTipRole: {
+        const qint64 dueAt = scheduleAt(col, row).dueAt;
+        if (dueAt == 0) {
+            return QVariant();
+        }
+        return QString("Due %1").arg(QLocale().toString(QDateTime::fromMSecsSinceEpoch(dueAt), QLocale::ShortFormat));
+    }
+    case Qt::AccessibleDescriptionRole: {
+        const qint64 dueAt = scheduleAt(col, row).dueAt;
+        if (!checked && dueAt != 0 && dueAt <= QDateTime::currentMSecsSinceEpoch()) {
+            return QStringLiteral("Overdue");
+        }
+        return checked ? QStringLiteral("Done") : QStringLiteral("Not done");
+    }
+    default:
+        return QVariant();
+    }
+}
+
+bool BoardModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid()) {
+        return false;
+    }
+
+    if (!index.internalPointer()) {
+        if (role != Qt::EditRole) {
+            return false;
+        }
+        setBoardColumnTitle(index.row(), value.toString());
+        return true;
+    }
+
+    const int column = parent(index).row();
+    if (role == Qt::EditRole) {
+        setItemText(column, index.row(), value.toString());
+        return true;
+    }
+    if (role == Qt::CheckStateRole) {
+        setItemChecked(column, index.row(), value.toInt() == Qt::Checked);
+        return true;
+    }
+    return false;
+}
+
+Qt::ItemFlags BoardModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    if (!index.internalPointer()) {
+        return Qt::ItemIsEnabled | Qt::ItemIsEditable;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable
+         | Qt::ItemIsUserCheckable | Qt::ItemNeverHasChildren;
+}
+
+int BoardModel::boardColumnCount() const
+{
+    return m_columns.size();
+}
+
+QModelIndex BoardModel::boardColumnIndex(int column) const
+{
+    return index(column, 0);
+}
+
+QString BoardModel::boardColumnTitle(int column) const
+{
+    const Column *col = m_columns.value(column);
+    return col ? col->title : QString();
+}
+
+void BoardModel::setBoardColumnTitle(int column, const QString &title)
+{
+    Column *col = m_columns.value(column);
+    if (!col || col->title == title) {
+        return;
+    }
+    col->title = ownedText(title);
+    ++m_generation;
+    const QModelIndex idx = boardColumnIndex(column);
+    emit dataChanged(idx, idx, {Qt::DisplayRole, Qt::EditRole});
+}
+
+void BoardModel::insertBoardColumn(int column, const QString &title)
+{
+    column = qBound(0, column, m_columns.size());
+    beginInsertRows(QModelIndex(), column, column);
+    Column *col = new Column;
+    col->title = ownedText(title);
+    m_columns.insert(column, col);
+    ++m_generation;
+    endInsertRows();
+}
+
+void BoardModel::removeBoardColumn(int column)
+{
+    if (column < 0 || column >= m_columns.size()) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), column, column);
+    Column *col = m_columns.takeAt(column);
+    releaseItems(col, 0, col->size());
+    delete col;
+    ++m_generation;
+    endRemoveRows();
+}
+
+void BoardModel::addDefaultColumns()
+{
+    insertBoardColumn(m_columns.size(), "To Do");
+    insertBoardColumn(m_columns.size(), "Doing");
+    insertBoardColumn(m_columns.size(), "Done");
+}
+
+bool BoardModel::moveBoardColumn(int from, int to)
+{
+    if (from < 0 || from >= m_columns.size()) {
+        return false;
+    }
+    to = qBound(0, to, m_columns.size());
+    if (to == from || to == from + 1) { //already there
+        return false;
+    }
+    if (!beginMoveRows(QModelIndex(), from, from, QModelIndex(), to)) {
+        return false;
+    }
+    m_columns.move(from, to > from ? to - 1 : to);
+    ++m_generation;
+    endMoveRows();
+    return true;
+}
+
+int BoardModel::itemCount(int column) const
+{
+    const Column *col = m_columns.value(column);
+    return col ? col->size() : 0;
+}
+
+TodoItem BoardModel::item(int column, int row) const
+{
+    const Column *col = m_columns.value(column);
+    return col && row >= 0 && row < col->size() ? itemAt(col, row) : TodoItem();
+}
+
+quint64 BoardModel::itemId(int column, int row) const
+{
+    const Column *col = m_columns.value(column);
+    return col && row >= 0 && row < col->size() ? col->ids.at(row) : 0;
+}
+
+QStringView BoardModel::itemTextView(const QModelIndex &index) const
+{
+    const Column *col = static_cast<const Column*>(index.internalPointer());
+    return col && index.model() == this ? m_texts.view(col->texts.at(index.row())) : QStringView();
+}
+
+quint32 BoardModel::itemTextHandle(int column, int row) const
+{
+    const Column *col = m_columns.value(column);
+    return col && row >= 0 && row < col->size() ? col->texts.at(row) : 0;
+}
+
+QStringView BoardModel::textView(quint32 handle) const
+{
+    return m_texts.view(handle);
+}
+
+bool BoardModel::isItemChecked(int column, int row) const
+{
+    const Column *col = m_columns.value(column);
+    return col && row >= 0 && row < col->size() && (col->flags.at(row) & Checked);
+}
+
+qint64 BoardModel::itemRemindAt(int column, int row) const
+{
+    const Column *col = m_columns.value(column);
+    return col && row >= 0 && row < col->size() ? scheduleAt(col, row).remindAt : 0;
+}
+
+int BoardModel::itemRepeatMinutes(int column, int row) const
+{
+    const Column *col = m_columns.value(column);
+    return col && row >= 0 && row < col->size() ? scheduleAt(col, row).repeatMinutes : 0;
+}
+
+QModelIndexList BoardModel::itemIndexes(const QList<quint64> &ids) const
+{
+    const QSet<quint64> wanted(ids.cbegin(), ids.cend());
+    QModelIndexList indexes;
+    for (Column *col : m_columns) {
+        for (int row = 0; row < col->size() && indexes.size() < wanted.size(); ++row) {
+            if (wanted.contains(col->ids.at(row))) {
+                indexes.append(createIndex(row, 0, col));
+            }
+        }
+    }
+    return indexes;
+}
+
+QList<TodoItem> BoardModel::items(int column) const
+{
+    const Column *col = m_columns.value(column);
+    return col ? itemsOf(col) : QList<TodoItem>();
+}
+
+void BoardModel::insertItem(int column, int row, const TodoItem &item)
+{
+    insertItems(column, row, QList<TodoItem>{item});
+}
+
+void BoardModel::insertItems(int column, int row, const QList<TodoItem> &items)
+{
+    Column *col = m_columns.value(column);
+    if (!col || items.isEmpty()) {
+        return;
+    }
+    skipTakenIds(items);
+    row = qBound(0, row, col->size());
+    beginInsertRows(boardColumnIndex(column), row, row + items.size() - 1);
+    col->insert(row, items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        storeItem(col, row + i, items.at(i));
+    }
+    ++m_generation;
+    endInsertRows();
+}
+
+void BoardModel::removeItem(int column, int row)
+{
+    removeItems(column, row, 1);
+}
+
+void BoardModel::removeItems(int column, int row, int count)
+{
+    Column *col = m_columns.value(column);
+    if (!col || count <= 0 || row < 0 || row + count > col->size()) {
+        return;
+    }
+    beginRemoveRows(boardColumnIndex(column), row, row + count - 1);
+    releaseItems(col, row, count);
+    col->remove(row, count);
+    ++m_generation;
+    endRemoveRows();
+}
+
+bool BoardModel::moveItem(int fromColumn, int fromRow, int toColumn, int toRow)
+{
+    return moveItems(fromColumn, fromRow, 1, toColumn, toRow);
+}
+
+bool BoardModel::moveItems(int fromColumn, int fromRow, int count, int toColumn, int toRow)
+{
+    Column *src = m_columns.value(fromColumn);
+    Column *dst = m_columns.value(toColumn);
+    if (!src || !dst || count <= 0 || fromRow < 0 || fromRow + count > src->size()) {
+        return false;
+    }
+    toRow = qBound(0, toRow, dst->size());
+    if (src == dst && toRow >= fromRow && toRow <= fromRow + count) { //already there
+        return false;
+    }
+    if (!beginMoveRows(boardColumnIndex(fromColumn), fromRow, fromRow + count - 1, boardColumnIndex(toColumn), toRow)) {
+        return false;
+    }
+    //texts and schedules stay where they are, only the rows move
+    const Column moved = src->mid(fromRow, count);
+    src->remove(fromRow, count);
+    if (src == dst && toRow > fromRow) {
+        toRow -= count;
+    }
+    dst->insert(toRow, moved);
+    ++m_generation;
+    endMoveRows();
+    return true;
+}
+
+void BoardModel::setItemText(int column, int row, const QString &text)
+{
+    Column *col = m_columns.value(column);
+    if (!col || row < 0 || row >= col->size() || m_texts.view(col->texts.at(row)) == text) {
+        return;
+    }
+    const quint32 handle = m_texts.add(text);
+    m_texts.release(col->texts.at(row));
+    col->texts[row] = handle;
+    ++m_generation;
+    const QModelIndex idx = index(row, 0, boardColumnIndex(column));
+    emit dataChanged(idx, idx, {Qt::DisplayRole, Qt::EditRole});
+}
+
+void BoardModel::setItemChecked(int column, int row, bool checked)
+{
+    Column *col = m_columns.value(column);
+    if (!col || row < 0 || row >= col->size() || bool(col->flags.at(row) & Checked) == checked) {
+        return;
+    }
+    col->flags[row] ^= Checked;
+    col->checkedAt[row] = checked ? QDateTime::currentMSecsSinceEpoch() : 0;
+    m_doneCount += checked ? 1 : -1;
+    ++m_generation;
+    const QModelIndex idx = index(row, 0, boardColumnIndex(column));
+    emit dataChanged(idx, idx, {Qt::CheckStateRole});
+}
+
+void BoardModel::setItemSchedule(int column, int row, qint64 dueAt, int repeatMinutes)
+{
+    Column *col = m_columns.value(column);
+    if (!col || row < 0 || row >= col->size()) {
+        return;
+    }
+    dueAt = qMax<qint64>(dueAt, 0);
+    repeatMinutes = dueAt ? qMax(repeatMinutes, 0) : 0;
+    const Schedule was = scheduleAt(col, row);
+    if (was.dueAt == dueAt && was.remindAt == dueAt && was.repeatMinutes == repeatMinutes) {
+        return;
+    }
+    setScheduleAt(col, row, Schedule{dueAt, dueAt, repeatMinutes});
+    ++m_generation;
+    const QModelIndex idx = index(row, 0, boardColumnIndex(column));
+    emit dataChanged(idx, idx, {DueAtRole});
+}
+
+void BoardModel::setItemReminder(int column, int row, qint64 remindAt)
+{
+    Column *col = m_columns.value(column);
+    if (!col || row < 0 || row >= col->size() || scheduleAt(col, row).remindAt == qMax<qint64>(remindAt, 0)) {
+        return;
+    }
+    Schedule schedule = scheduleAt(col, row);
+    schedule.remindAt = qMax<qint64>(remindAt, 0);
+    setScheduleAt(col, row, schedule);
+    ++m_generation;
+    const QModelIndex idx = index(row, 0, boardColumnIndex(column));
+    emit dataChanged(idx, idx, {DueAtRole});
+}
+
+namespace {
+//sorted, duplicates and rows outside the column dropped, then cut into runs of adjacent rows
+QList<QPair<int, int>> rowRuns(QList<int> rows, int rowCount)
+{
+    std::sort(rows.begin(), rows.end());
+    QList<QPair<int, int>> runs; //first and last row
+    for (int row : rows) {
+        if (row < 0 || row >= rowCount) {
+            continue;
+        }
+        if (!runs.isEmpty() && row <= runs.last().second + 1) {
+            runs.last().second = qMax(runs.last().second, row);
+        } else {
+            runs.append(qMakePair(row, row));
+        }
+    }
+    return runs;
+}
+}
+
+void BoardModel::removeItems(int column, const QList<int> &rows)
+{
+    const QList<QPair<int, int>> runs = rowRuns(rows, itemCount(column));
+    beginBatch();
+    //bottom up, so the rows of the runs still ahead stay where they are
+    for (auto it = runs.crbegin(); it != runs.crend(); ++it) {
+        removeItems(column, it->first, it->second - it->first + 1);
+    }
+    endBatch();
+}
+
+void BoardModel::setItemsChecked(int column, const QList<int> &rows, bool checked)
+{
+    Column *col = m_columns.value(column);
+    if (!col) {
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    beginBatch();
+    for (const QPair<int, int> &run : rowRuns(rows, col->size())) {
+        //only the todos that actually change, a done one keeps the time it was done
+        int first = -1;
+        for (int row = run.first; row <= run.second + 1; ++row) {
+            const bool changes = row <= run.second && bool(col->flags.at(row) & Checked) != checked;
+            if (changes) {
+                col->flags[row] ^= Checked;
+                col->checkedAt[row] = checked ? now : 0;
+                m_doneCount += checked ? 1 : -1;
+                if (first < 0) {
+                    first = row;
+                }
+            } else if (first >= 0) {
+                ++m_generation;
+                const QModelIndex parent = boardColumnIndex(column);
+                emit dataChanged(index(first, 0, parent), index(row - 1, 0, parent), {Qt::CheckStateRole});
+                first = -1;
+            }
+        }
+    }
+    endBatch();
+}
+
+bool BoardModel::moveItems(int fromColumn, const QList<int> &rows, int toColumn, int toRow)
+{
+    Column *src = m_columns.value(fromColumn);
+    Column *dst = m_columns.value(toColumn);
+    if (!src || !dst) {
+        return false;
+    }
+    toRow = qBound(0, toRow, dst->size());
+
+    //a run reaching over toRow is two runs, one on either side of it
+    QList<QPair<int, int>> above;
+    QList<QPair<int, int>> below;
+    for (const QPair<int, int> &run : rowRuns(rows, src->size())) {
+        if (src != dst || run.second < toRow) {
+            above.append(run);
+        } else if (run.first >= toRow) {
+            below.append(run);
+        } else {
+            above.append(qMakePair(run.first, toRow - 1));
+            below.append(qMakePair(toRow, run.second));
+        }
+    }
+
+    bool moved = false;
+    beginBatch();
+    //runs above the target bottom up, each lands in front of the one moved before it;
+    //from another column every run is above in that sense
+    int at = toRow;
+    for (auto it = above.crbegin(); it != above.crend(); ++it) {
+        const int count = it->second - it->first + 1;
+        moved |= moveItems(fromColumn, it->first, count, toColumn, at);
+        if (src == dst) {
+            at -= count;
+        }
+    }
+    //runs below top down, each lands behind the one moved before it
+    at = toRow;
+    for (const QPair<int, int> &run : below) {
+        const int count = run.second - run.first + 1;
+        moved |= moveItems(fromColumn, run.first, count, toColumn, at);
+        at += count;
+    }
+    endBatch();
+    return moved;
+}
+
+void BoardModel::sortItems(int column, ItemSort sort)
+{
+    Column *col = m_columns.value(column);
+    if (!col || col->size() < 2) {
+        return;
+    }
+
+    QList<int> order(col->size());
+    std::iota(order.begin(), order.end(), 0);
+    if (sort == SortByText) {
+        //a key per todo up front, comparing keys is a plain byte compare
+        QCollator collator;
+        collator.setNumericMode(true);
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        QList<QCollatorSortKey> keys;
+        keys.reserve(col->size());
+        for (quint32 text : std::as_const(col->texts)) {
+            keys.append(collator.sortKey(m_texts.text(text)));
+        }
+        std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) {
+            return keys.at(a).compare(keys.at(b)) < 0;
+        });
+    } else {
+        std::stable_sort(order.begin(), order.end(), [col](int a, int b) {
+            return !(col->flags.at(a) & Checked) && (col->flags.at(b) & Checked);
+        });
+    }
+    if (std::is_sorted(order.cbegin(), order.cend())) {
+        return; //already in that order
+    }
+
+    //one layout change for the whole column instead of a move per todo
+    const QModelIndex parent = boardColumnIndex(column);
+    emit layoutAboutToBeChanged({QPersistentModelIndex(parent)}, QAbstractItemModel::VerticalSortHint);
+    QList<int> newRow(order.size());
+    for (int row = 0; row < order.size(); ++row) {
+        newRow[order.at(row)] = row;
+    }
+    for (const QModelIndex &index : persistentIndexList()) {
+        if (index.internalPointer() == col) {
+            changePersistentIndex(index, createIndex(newRow.at(index.row()), 0, col));
+        }
+    }
+    col->reorder(order);
+    ++m_generation;
+    emit layoutChanged({QPersistentModelIndex(parent)}, QAbstractItemModel::VerticalSortHint);
+    emit itemsReordered(column, order);
+}
+
+void BoardModel::beginBatch()
+{
+    if (m_batchDepth++ == 0) {
+        emit batchStarted();
+    }
+}
+
+void BoardModel::endBatch()
+{
+    if (--m_batchDepth == 0) {
+        emit batchFinished();
+    }
+}
+
+void BoardModel::clear()
+{
+    beginResetModel();
+    qDeleteAll(m_columns);
+    m_columns.clear();
+    m_texts.clear();
+    m_schedules.clear();
+    m_todoCount = 0;
+    m_doneCount = 0;
+    ++m_generation;
+    endResetModel();
+}
+
+quint64 BoardModel::generation() const
+{
+    return m_generation;
+}
+
+int BoardModel::todoCount() const
+{
+    return m_todoCount;
+}
+
+int BoardModel::doneCount() const
+{
+    return m_doneCount;
+}
+
+BoardData BoardModel::boardData() const
+{
+    BoardData data;
+    data.columns.reserve(m_columns.size());
+    for (const Column *col : m_columns) {
+        BoardColumnData column;
+        column.title = col->title;
+        column.items = itemsOf(col);
+        data.columns.append(column);
+    }
+    return data;
+}
+
+BoardSnapshot BoardModel::snapshot() const
+{
+    //a column is a title and a few lists, copying them only takes references
+    QSharedPointer<BoardSnapshot::Data> data(new BoardSnapshot::Data);
+    data->columns.reserve(m_columns.size());
+    for (const Column *col : m_columns) {
+        data->columns.append(*col);
+    }
+    data->texts = m_texts;
+    data->schedules = m_schedules;
+
+    BoardSnapshot snapshot;
+    snapshot.d = data;
+    return snapshot;
+}
+
+void BoardModel::setBoardSnapshot(const BoardSnapshot &snapshot)
+{
+    beginResetModel();
+    qDeleteAll(m_columns);
+    m_columns.clear();
+    m_texts = snapshot.d ? snapshot.d->texts : TextArena();
+    m_schedules = snapshot.d ? snapshot.d->schedules : QHash<quint64, Schedule>();
+    m_todoCount = 0;
+    m_doneCount = 0;
+    for (int c = 0; c < snapshot.columnCount(); ++c) {
+        //the lists are shared with the snapshot until the column is edited
+        Column *col = new Column(snapshot.d->columns.at(c));
+        for (int row = 0; row < col->size(); ++row) {
+            m_nextItemId = qMax(m_nextItemId, col->ids.at(row) + 1);
+            m_doneCount += col->flags.at(row) & Checked;
+        }
+        m_todoCount += col->size();
+        m_columns.append(col);
+    }
+    ++m_generation;
+    endResetModel();
+}
+
+void BoardModel::setBoardData(const BoardData &data)
+{
+    beginResetModel();
+    qDeleteAll(m_columns);
+    m_columns.clear();
+    m_texts.clear();
+    m_schedules.clear();
+    m_todoCount = 0;
+    m_doneCount = 0;
+    for (const BoardColumnData &column : data.columns) {
+        skipTakenIds(column.items);
+    }
+    for (const BoardColumnData &column : data.columns) {
+        Column *col = new Column;
+        col->title = ownedText(column.title);
+        col->insert(0, column.items.size());
+        for (int row = 0; row < column.items.size(); ++row) {
+            storeItem(col, row, column.items.at(row));
+        }
+        m_columns.append(col);
+    }
+    ++m_generation;
+    endResetModel();
+}
+
+void BoardModel::skipTakenIds(const QList<TodoItem> &items)
+{
+    for (const TodoItem &item : items) {
+        m_nextItemId = qMax(m_nextItemId, item.id + 1);
+    }
+}
+
+void BoardModel::storeItem(Column *col, int row, const TodoItem &item)
+{
+    const quint64 id = item.id != 0 ? item.id : m_nextItemId++;
+    col->ids[row] = id;
+    col->texts[row] = m_texts.add(item.text);
+    col->checkedAt[row] = item.checkedAt;
+    col->flags[row] = item.checked ? Checked : 0;
+    if (item.dueAt != 0 || item.remindAt != 0 || item.repeatMinutes != 0) {
+        col->flags[row] |= Scheduled;
+        m_schedules.insert(id, Schedule{item.dueAt, item.remindAt, item.repeatMinutes});
+    }
+    ++m_todoCount;
+    m_doneCount += item.checked;
+}
+
+void BoardModel::releaseItems(Column *col, int row, int count)
+{
+    for (int i = row; i < row + count; ++i) {
+        m_texts.release(col->texts.at(i));
+        if (col->flags.at(i) & Scheduled) {
+            m_schedules.remove(col->ids.at(i));
+        }
+        m_doneCount -= bool(col->flags.at(i) & Checked);
+    }
+    m_todoCount -= count;
+}
+
+TodoItem BoardModel::itemAt(const Column *col, int row) const
+{
+    TodoItem item;
+    item.text = m_texts.text(col->texts.at(row));
+    item.checked = col->flags.at(row) & Checked;
+    item.id = col->ids.at(row);
+    item.checkedAt = col->checkedAt.at(row);
+    const Schedule schedule = scheduleAt(col, row);
+    item.dueAt = schedule.dueAt;
+    item.remindAt = schedule.remindAt;
+    item.repeatMinutes = schedule.repeatMinutes;
+    return item;
+}
+
+QList<TodoItem> BoardModel::itemsOf(const Column *col) const
+{
+    QList<TodoItem> items;
+    items.reserve(col->size());
+    for (int row = 0; row < col->size(); ++row) {
+        items.append(itemAt(col, row));
+    }
+    return items;
+}
+
+BoardModel::Schedule BoardModel::scheduleAt(const Column *col, int row) const
+{
+    return col->flags.at(row) & Scheduled ? m_schedules.value(col->ids.at(row)) : Schedule();
+}
+
+void BoardModel::setScheduleAt(Column *col, int row, const Schedule &schedule)
+{
+    if (schedule.dueAt == 0 && schedule.remindAt == 0 && schedule.repeatMinutes == 0) {
+        col->flags[row] &= ~Scheduled;
+        m_schedules.remove(col->ids.at(row));
+    } else {
+        col->flags[row] |= Scheduled;
+        m_schedules.insert(col->ids.at(row), schedule);
+    }
+}
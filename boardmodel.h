@@ -0,0 +1,185 @@
+#ifndef BOARDMODEL_H
+#define BOARDMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include "boarddata.h"
+#include "textarena.h"
+
+//the whole board as the model held it at one moment, taken without copying a
+//single text: it shares the model's lists and text buffer, and the model copies
+//those once it changes next instead. Nothing in it changes after that, so it can
+//go to another thread, e.g. the snapshot writer
+class BoardSnapshot
+{
+public:
+    quint64 sequence = 0; //as in BoardData
+    quint64 stamp = 0;
+
+    int columnCount() const;
+    QString columnTitle(int column) const;
+    int itemCount(int column) const;
+    quint64 itemId(int column, int row) const;
+    QStringView itemText(int column, int row) const;
+    bool isItemChecked(int column, int row) const;
+    qint64 itemDueAt(int column, int row) const;
+    int itemRepeatMinutes(int column, int row) const;
+
+    //every text copied out, for the file formats
+    BoardData toBoardData() const;
+
+    //memory it keeps alive once the model moved on, roughly
+    qint64 byteSize() const;
+
+private:
+    friend class BoardModel;
+    struct Data;
+    QSharedPointer<const Data> d;
+};
+
+//two level model of the whole board: top level rows are the columns,
+//their children are the todos of that column. It owns the board in compact
+//form, TodoItem is only what goes in and comes out
+class BoardModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles
+    {
+        ItemIdRole = Qt::UserRole + 1, //quint64 that follows a todo through moves
+        DueAtRole //qint64 msecs since epoch, 0 without a due date; also what changes with a todo's reminder
+    };
+
+    enum ItemSort
+    {
+        SortByText,   //by the locale's collation, numbers by value
+        SortByChecked //open todos first, otherwise in the order they are
+    };
+
+    explicit BoardModel(QObject *parent = nullptr);
+    ~BoardModel() override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    //board columns
+    int boardColumnCount() const;
+    QModelIndex boardColumnIndex(int column) const;
+    QString boardColumnTitle(int column) const;
+    void setBoardColumnTitle(int column, const QString &title);
+    void insertBoardColumn(int column, const QString &title);
+    void removeBoardColumn(int column);
+    //the columns a brand new board starts with
+    void addDefaultColumns();
+    bool moveBoardColumn(int from, int to); //to is the index before the move
+
+    //todos inside a column
+    int itemCount(int column) const;
+    TodoItem item(int column, int row) const;
+    quint64 itemId(int column, int row) const;
+    //the text where the model keeps it, no copy; only good until the model changes next,
+    //for painting and measuring, which ask for it far more often than it changes
+    QStringView itemTextView(const QModelIndex &index) const;
+    //handle of the todo's text in the model's text buffer, it changes with the text;
+    //the search index keeps these instead of copies of every text
+    quint32 itemTextHandle(int column, int row) const;
+    QStringView textView(quint32 handle) const; //same lifetime as itemTextView()
+    //single fields of a todo, for callers that would otherwise copy its text with item()
+    bool isItemChecked(int column, int row) const;
+    qint64 itemRemindAt(int column, int row) const;
+    int itemRepeatMinutes(int column, int row) const;
+    //where the todos with these ids are now, in board order; ids no todo has are left out
+    QModelIndexList itemIndexes(const QList<quint64> &ids) const;
+    QList<TodoItem> items(int column) const;
+    void insertItem(int column, int row, const TodoItem &item);
+    void insertItems(int column, int row, const QList<TodoItem> &items); //one notification for all of them
+    void removeItem(int column, int row);
+    void removeItems(int column, int row, int count);
+    bool moveItem(int fromColumn, int fromRow, int toColumn, int toRow); //toRow is the index before the move
+    bool moveItems(int fromColumn, int fromRow, int count, int toColumn, int toRow);
+    void setItemText(int column, int row, const QString &text);
+    void setItemChecked(int column, int row, bool checked);
+    //a due date of 0 removes it, the first reminder comes when the todo is due
+    void setItemSchedule(int column, int row, qint64 dueAt, int repeatMinutes);
+    void setItemReminder(int column, int row, qint64 remindAt); //0 for no further reminder
+
+    //several todos of a column at once, rows in any order; each run of adjacent
+    //rows is one notification and the whole call is one batch
+    void removeItems(int column, const QList<int> &rows);
+    void setItemsChecked(int column, const QList<int> &rows, bool checked);
+    //the todos end up next to each other before toRow, in the order they were in
+    bool moveItems(int fromColumn, const QList<int> &rows, int toColumn, int toRow);
+    void sortItems(int column, ItemSort sort);
+
+    //changes between these belong together, the journal writes them in one go
+    void beginBatch();
+    void endBatch();
+
+    void clear();
+
+    //bumped by every change, lets savers tell whether anything happened since
+    quint64 generation() const;
+
+    //todos on the whole board and how many of them are done, kept up to date
+    //with every change instead of counted
+    int todoCount() const;
+    int doneCount() const;
+
+    //whole board at once as plain values, every text copied in or out; for keeping the
+    //board around or handing it to another thread, snapshot() copies none of them
+    BoardData boardData() const;
+    void setBoardData(const BoardData &data);
+    BoardSnapshot snapshot() const;
+    //back to a board taken with snapshot(), with no text copied on the way
+    void setBoardSnapshot(const BoardSnapshot &snapshot);
+
+signals:
+    void batchStarted();
+    void batchFinished();
+    //the todos of column were rearranged, order lists the old row of every new row
+    void itemsReordered(int column, const QList<int> &order);
+
+private:
+    friend class BoardSnapshot;
+    struct Column;
+
+    //due date and reminder, held apart since most todos have neither
+    struct Schedule
+    {
+        qint64 dueAt = 0;
+        qint64 remindAt = 0;
+        qint32 repeatMinutes = 0;
+    };
+
+    //a new id must not repeat one further down items
+    void skipTakenIds(const QList<TodoItem> &items);
+    //fills in a row opened by Column::insert, a todo without an id gets a fresh one
+    void storeItem(Column *col, int row, const TodoItem &item);
+    //lets go of what the rows hold outside the column, before they are removed
+    void releaseItems(Column *col, int row, int count);
+    TodoItem itemAt(const Column *col, int row) const;
+    QList<TodoItem> itemsOf(const Column *col) const;
+    Schedule scheduleAt(const Column *col, int row) const;
+    void setScheduleAt(Column *col, int row, const Schedule &schedule);
+
+    //columns are heap allocated so child indexes can point at them and
+    //stay valid while columns get moved around
+    QList<Column*> m_columns;
+    TextArena m_texts;
+    QHash<quint64, Schedule> m_schedules; //by todo id
+    quint64 m_generation = 0;
+    quint64 m_nextItemId = 1;
+    int m_todoCount = 0;
+    int m_doneCount = 0;
+    int m_batchDepth = 0;
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "boardstorage.h"
+#include "boardmodel.h"
+#include "binaryboardformat.h"
+#include "boardindex.h"
+#include "jsonboardformat.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include "tracer.h"
+
+namespace {
+const qint64 CompactionThreshold = 1024 * 1024; //journal size that triggers a new snapshot
+
+//never 0, which a file from an older version or edited by hand reads as, and it
+//fits the 53 bits a double keeps, which other JSON readers turn numbers into
+quint64 newStamp()
+{
+    return (QRandomGenerator::global()->generate64() & ((quint64(1) << 53) - 1)) | 1;
+}
+}
+
+BoardStorage::BoardStorage(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+    , m_journal(new BoardJournal(fileName + ".journal", this))
+    , m_writer(new SnapshotWriter(fileName, this))
+{
+    connect(m_journal, &BoardJournal::recordWritten, this, &BoardStorage::compactIfNeeded);
+    connect(m_writer, &SnapshotWriter::saved, this, &BoardStorage::onSnapshotSaved);
+}
+
+QString BoardStorage::fileName() const
+{
+    return m_fileName;
+}
+
+bool BoardStorage::exists() const
+{
+    return QFile::exists(m_fileName) || QFile::exists(m_journal->fileName());
+}
+
+BoardData BoardStorage::load(BoardData *snapshot) const
+{
+    TRACE_SPAN("load board");
+    BoardData data;
+    readSnapshot(m_fileName, &data);
+    if (snapshot) {
+        *snapshot = data;
+    }
+    {
+        TRACE_SPAN("replay journal");
+        m_journal->replay(&data);
+    }
+
+    //todos of a file from before ids were kept, or added to it by hand, have no id
+    //yet, and done ones from before the time was kept start aging from now
+    quint64 nextId = 1;
+    for (const BoardColumnData &column : data.columns) {
+        for (const TodoItem &item : column.items) {
+            nextId = qMax(nextId, item.id + 1);
+        }
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (BoardColumnData &column : data.columns) {
+        for (TodoItem &item : column.items) {
+            if (item.id == 0) {
+                item.id = nextId++;
+            }
+            if (item.checked && item.checkedAt == 0) {
+                item.checkedAt = now;
+            }
+        }
+    }
+    return data;
+}
+
+void BoardStorage::attach(BoardModel *model, quint64 sequence, quint64 stamp)
+{
+    m_model = model;
+    m_savedGeneration = model->generation();
+    m_journal->open(sequence, stamp);
+    m_journal->attach(model);
+    m_loadedSequence = m_journal->sequence();
+}
+
+void BoardStorage::setLoading(bool loading)
+{
+    m_loading = loading;
+
+    //the loaded todos match the snapshot, only edits made meanwhile make it dirty
+    if (!loading && m_model && m_journal->sequence() == m_loadedSequence) {
+        m_savedGeneration = m_model->generation();
+    }
+}
+
+void BoardStorage::setJournalPaused(bool paused)
+{
+    m_journal->setPaused(paused);
+}
+
+quint64 BoardStorage::sequence() const
+{
+    return m_journal->sequence();
+}
+
+quint64 BoardStorage::stamp() const
+{
+    return m_journal->stamp();
+}
+
+bool BoardStorage::isDirty() const
+{
+    return m_model && m_model->generation() != m_savedGeneration;
+}
+
+void BoardStorage::save(bool force)
+{
+    if (force || isDirty()) {
+        writeSnapshot();
+    }
+}
+
+bool BoardStorage::fold()
+{
+    if (!m_model || m_loading || (m_journal->isEmpty() && !isDirty())) {
+        return true; //the file has it all already
+    }
+
+    //a write still running would land on top of this one
+    m_writer->waitForIdle();
+
+    TRACE_SPAN("fold journal");
+    BoardSnapshot snapshot = m_model->snapshot();
+    snapshot.sequence = m_journal->sequence();
+    snapshot.stamp = newStamp();
+    if (writeSnapshotFile(m_fileName, snapshot.toBoardData()) < 0) {
+        return false;
+    }
+    //a queued report of an older write must not stamp the journal back
+    m_writing.clear();
+    m_savedGeneration = m_model->generation();
+    m_journal->discardUpTo(snapshot.sequence, snapshot.stamp);
+    emit snapshotSaved(snapshot);
+    return true;
+}
+
+void BoardStorage::compactIfNeeded()
+{
+    //a write in flight already picks up the records, no need to queue another
+    if (m_journal->size() > CompactionThreshold && !m_writer->isBusy()) {
+        writeSnapshot();
+    }
+}
+
+SnapshotWriter *BoardStorage::snapshotWriter() const
+{
+    return m_writer;
+}
+
+void BoardStorage::writeSnapshot()
+{
+    if (!m_model || m_loading) {
+        return;
+    }
+
+    TRACE_SPAN("save");
+    //no text is copied here, the writer does that on its own thread
+    BoardSnapshot snapshot = m_model->snapshot();
+    snapshot.sequence = m_journal->sequence();
+    snapshot.stamp = newStamp();
+    m_writing.insert(m_model->generation(), snapshot);
+    m_writer->write(snapshot, m_model->generation());
+}
+
+void BoardStorage::onSnapshotSaved(quint64 generation, quint64 sequence)
+{
+    if (!m_writing.contains(generation)) {
+        return; //fold() wrote a newer one meanwhile
+    }
+    m_savedGeneration = generation;
+
+    //requests the writer coalesced away never reach the file
+    const BoardSnapshot snapshot = m_writing.value(generation);
+    m_writing.erase(m_writing.begin(), m_writing.upperBound(generation));
+
+    //records up to the snapshot are now redundant, later ones must stay and
+    //from now on continue this snapshot
+    m_journal->discardUpTo(sequence, snapshot.stamp);
+    emit snapshotSaved(snapshot);
+}
+
+BoardFormat BoardStorage::formatForFile(const QString &fileName)
+{
+    if (QFileInfo(fileName).suffix() == BinaryBoardFormat::fileSuffix()) {
+        return BoardFormat::Binary;
+    }
+    return BoardFormat::Json;
+}
+
+bool BoardStorage::readSnapshot(const QString &fileName, BoardData *data)
+{
+    TRACE_SPAN("parse snapshot");
+    if (formatForFile(fileName) == BoardFormat::Binary) {
+        BinaryBoardReader reader;
+        if (!reader.open(fileName)) {
+            return false;
+        }
+        *data = reader.toBoardData();
+        return true;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QByteArray content = file.readAll();
+    file.close();
+
+    //false for a file caught halfway through being written by another program
+    return JsonBoardFormat::parse(content, data);
+}
+
+QByteArray BoardStorage::serializeSnapshot(const BoardData &data, BoardFormat format)
+{
+    TRACE_SPAN("serialize snapshot");
+    if (format == BoardFormat::Binary) {
+        return BinaryBoardFormat::serialize(data);
+    }
+
+    return JsonBoardFormat::serialize(data);
+}
+
+qint64 BoardStorage::writeSnapshotFile(const QString &fileName, const BoardData &data, QString *errorString)
+{
+    QByteArray bytes = serializeSnapshot(data, formatForFile(fileName));
+
+    //QSaveFile so a crash mid-write never leaves a truncated snapshot behind
+    TRACE_SPAN("write snapshot");
+    QSaveFile file(fileName);
+    bool ok = file.open(QIODevice::WriteOnly)
+              && file.write(bytes) == bytes.size()
+              && file.commit();
+    if (!ok) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return -1;
+    }
+    return bytes.size();
+}
+
+bool BoardStorage::convert(const QString &fromFileName, const QString &toFileName)
+{
+    BoardData data;
+    if (!readSnapshot(fromFileName, &data) && !QFile::exists(fromFileName + ".journal")) {
+        return false;
+    }
+    BoardJournal(fromFileName + ".journal").replay(&data);
+
+    //the converted file starts without a journal of its own
+    QFile::remove(toFileName + ".journal");
+    data.sequence = 0;
+    data.stamp = newStamp();
+    return writeSnapshotFile(toFileName, data) >= 0;
+}
+
+QString BoardStorage::boardFile(const BoardIndex &boards, const BoardInfo &info, BoardFormat format)
+{
+    QString jsonFile = boards.boardFile(info, "json");
+    QString binaryFile = boards.boardFile(info, BinaryBoardFormat::fileSuffix());
+    QString dataFile = format == BoardFormat::Binary ? binaryFile : jsonFile;
+    QDir().mkpath(QFileInfo(dataFile).absolutePath());
+
+    //switching formats carries the board over instead of starting empty
+    QString otherFile = format == BoardFormat::Binary ? jsonFile : binaryFile;
+    if (!QFile::exists(dataFile) && !QFile::exists(dataFile + ".journal") && QFile::exists(otherFile)) {
+        convert(otherFile, dataFile);
+    }
+    return dataFile;
+}
@@ -0,0 +1,92 @@
+#ifndef BOARDSTORAGE_H
+#define BOARDSTORAGE_H
+
+#include <QObject>
+#include <QMap>
+#include "boarddata.h"
+#include "boardjournal.h"
+#include "boardmodel.h"
+#include "snapshotwriter.h"
+
+class BoardIndex;
+struct BoardInfo;
+
+enum class BoardFormat
+{
+    Json,
+    Binary
+};
+
+//snapshot file plus the journal of edits made since it was written
+class BoardStorage : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BoardStorage(const QString &fileName, QObject *parent = nullptr);
+
+    QString fileName() const;
+    bool exists() const;
+
+    //snapshot with the journal replayed on top; snapshot, if given, gets the file alone
+    BoardData load(BoardData *snapshot = nullptr) const;
+
+    //starts journaling every edit made to model, sequence and stamp are the ones load() gave
+    void attach(BoardModel *model, quint64 sequence, quint64 stamp);
+
+    //no snapshots while the model is only partially loaded
+    void setLoading(bool loading);
+    void setJournalPaused(bool paused);
+
+    //sequence of the last edit written to the journal
+    quint64 sequence() const;
+    //of the snapshot the journal continues
+    quint64 stamp() const;
+
+    //true when the model changed since the last snapshot was written
+    bool isDirty() const;
+
+    //writes a fresh snapshot in the background and drops the journal records it covers,
+    //force writes it even when nothing changed
+    void save(bool force = false);
+    //writes the snapshot right away on this thread and empties the journal, for when
+    //the board is closed: a journal is only replayed onto the file it continues, and a
+    //sync client may replace that file before the board is opened again
+    bool fold();
+    void compactIfNeeded();
+
+    SnapshotWriter *snapshotWriter() const;
+
+    //the format of a snapshot follows its file extension
+    static BoardFormat formatForFile(const QString &fileName);
+    static bool readSnapshot(const QString &fileName, BoardData *data);
+    static QByteArray serializeSnapshot(const BoardData &data, BoardFormat format);
+    //returns the number of bytes written or -1
+    static qint64 writeSnapshotFile(const QString &fileName, const BoardData &data, QString *errorString = nullptr);
+
+    //converts a board with its journal between formats, e.g. json to binary
+    static bool convert(const QString &fromFileName, const QString &toFileName);
+    //snapshot file of a listed board in format, converted over from the other format if needed
+    static QString boardFile(const BoardIndex &boards, const BoardInfo &info, BoardFormat format);
+
+signals:
+    //snapshot is what the file holds now
+    void snapshotSaved(const BoardSnapshot &snapshot);
+
+private slots:
+    void onSnapshotSaved(quint64 generation, quint64 sequence);
+
+private:
+    void writeSnapshot();
+
+    QString m_fileName;
+    BoardJournal *m_journal;
+    SnapshotWriter *m_writer;
+    BoardModel *m_model = nullptr;
+    QMap<quint64, BoardSnapshot> m_writing; //handed to the writer, by generation
+    quint64 m_savedGeneration = 0;
+    quint64 m_loadedSequence = 0;
+    bool m_loading = false;
+};
+
+#endif
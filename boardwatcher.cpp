@@ -0,0 +1,157 @@
+#include "boardwatcher.h"
+#include "boardmerge.h"
+#include "boardmodel.h"
+#include "boardstorage.h"
+#include <QFile>
+#include "tracer.h"
+
+namespace {
+const int DebounceMs = 500; //a sync client or an editor tends to write a file in several steps
+
+//written by an older version, load() filled in what it lacks
+bool needsUpgrade(const BoardData &data)
+{
+    for (const BoardColumnData &column : data.columns) {
+        for (const TodoItem &item : column.items) {
+            if (item.id == 0 || (item.checked && item.checkedAt == 0)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+}
+
+BoardWatcher::BoardWatcher(BoardStorage *storage, BoardModel *model, QObject *parent)
+    : QObject(parent)
+    , m_storage(storage)
+    , m_model(model)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DebounceMs);
+    connect(&m_debounce, &QTimer::timeout, this, &BoardWatcher::check);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &BoardWatcher::onFileChanged);
+    connect(storage, &BoardStorage::snapshotSaved, this, &BoardWatcher::onSnapshotSaved);
+}
+
+BoardWatcher::~BoardWatcher()
+{
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+void BoardWatcher::setBusyCheck(const std::function<bool()> &check)
+{
+    m_isBusy = check;
+}
+
+void BoardWatcher::start(const MergeBase &base)
+{
+    setBase(base);
+    m_started = true;
+    watch();
+    check();
+}
+
+MergeBase BoardWatcher::base() const
+{
+    return m_base;
+}
+
+void BoardWatcher::watch()
+{
+    //a file replaced by renaming over it drops out of the watcher, and a new board has none yet
+    const QString file = m_storage->fileName();
+    if (!m_watcher.files().contains(file) && QFile::exists(file)) {
+        m_watcher.addPath(file);
+    }
+}
+
+void BoardWatcher::setBase(const MergeBase &base)
+{
+    m_base = base;
+    ++m_baseVersion;
+}
+
+void BoardWatcher::upgradeFile(const BoardData &theirs)
+{
+    if (m_upgradeChecked) {
+        return;
+    }
+    m_upgradeChecked = true;
+    //ids for a file from an older version, and a journal folded in so the ids in
+    //the file cover every todo; otherwise a todo added elsewhere could take one of them
+    if (needsUpgrade(theirs) || m_storage->sequence() != theirs.sequence) {
+        m_storage->save(true);
+    }
+}
+
+void BoardWatcher::onFileChanged()
+{
+    m_debounce.start();
+}
+
+void BoardWatcher::onSnapshotSaved(const BoardSnapshot &snapshot)
+{
+    //our own write, nothing to merge from it; hashing the texts copies none of them
+    setBase(MergeBase(snapshot));
+    watch();
+}
+
+void BoardWatcher::check()
+{
+    if (!m_started) {
+        return;
+    }
+    //a snapshot being written would look like an outside change halfway through
+    if (m_thread || m_storage->snapshotWriter()->isBusy() || (m_isBusy && m_isBusy())) {
+        m_debounce.start();
+        return;
+    }
+
+    m_readVersion = m_baseVersion;
+    const QString file = m_storage->fileName();
+    m_thread = QThread::create([this, file]() {
+        m_read = BoardData();
+        m_readOk = BoardStorage::readSnapshot(file, &m_read);
+        m_readBase = m_readOk ? MergeBase(m_read) : MergeBase();
+    });
+    m_thread->setObjectName("BoardWatcher");
+    connect(m_thread, &QThread::finished, this, &BoardWatcher::onRead);
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+    m_thread->start();
+}
+
+void BoardWatcher::onRead()
+{
+    m_thread = nullptr;
+    watch();
+
+    BoardData theirs = m_read;
+    const MergeBase theirBase = m_readBase;
+    m_read = BoardData();
+    m_readBase = MergeBase();
+    if (!m_readOk) {
+        return; //gone or only half written, finishing it changes the file again
+    }
+
+    if (m_readVersion != m_baseVersion || m_storage->snapshotWriter()->isBusy()) {
+        m_debounce.start(); //saved meanwhile, what was read may be outdated already
+        return;
+    }
+    if (theirBase == m_base) {
+        upgradeFile(theirs);
+        return;
+    }
+
+    TRACE_SPAN("merge board");
+    const MergeResult result = BoardMerge::apply(m_base, theirs, m_model);
+    setBase(theirBase);
+
+    //the journal continues the file as it was before, a snapshot of the merged board
+    //replaces both so the next load does not replay old records onto the new file
+    m_upgradeChecked = true;
+    m_storage->save(true);
+    emit merged(result.changes, result.conflicts);
+}
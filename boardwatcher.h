@@ -0,0 +1,71 @@
+#ifndef BOARDWATCHER_H
+#define BOARDWATCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QStringList>
+#include <functional>
+#include "boarddata.h"
+#include "boardmerge.h"
+
+class BoardModel;
+class BoardSnapshot;
+class BoardStorage;
+
+//notices when the snapshot file of the open board is changed by another program,
+//e.g. a sync client, and merges the change into the model by todo id: only the
+//todos and columns that differ are touched, the rest of the board stays as it is
+class BoardWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    BoardWatcher(BoardStorage *storage, BoardModel *model, QObject *parent = nullptr);
+    ~BoardWatcher() override;
+
+    //while it returns true merging waits, e.g. during an import
+    void setBusyCheck(const std::function<bool()> &check);
+
+    //the model has to be fully loaded; base is the file the model was loaded from,
+    //whatever changed in it since is merged on the first read instead of overwritten
+    void start(const MergeBase &base);
+    //the file as the app last knew it, kept with a cached board for its next start()
+    MergeBase base() const;
+
+signals:
+    //conflicts are todos changed on both sides, the version in the app was kept
+    void merged(int changes, const QStringList &conflicts);
+
+private slots:
+    void onFileChanged();
+    void check();
+    void onRead();
+    void onSnapshotSaved(const BoardSnapshot &snapshot);
+
+private:
+    void watch();
+    void setBase(const MergeBase &base);
+    void upgradeFile(const BoardData &theirs);
+
+    BoardStorage *m_storage;
+    BoardModel *m_model;
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    QThread *m_thread = nullptr;
+    std::function<bool()> m_isBusy;
+
+    MergeBase m_base;           //the file as the app last read or wrote it
+    quint64 m_baseVersion = 0;  //bumped whenever m_base changes
+    bool m_started = false;
+    bool m_upgradeChecked = false;
+
+    //touched by the reader thread while it runs
+    BoardData m_read;
+    MergeBase m_readBase;       //of m_read, worked out on the thread as well
+    bool m_readOk = false;
+    quint64 m_readVersion = 0;  //m_baseVersion when the read started
+};
+
+#endif
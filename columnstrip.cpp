@@ -0,0 +1,204 @@
+#include "columnstrip.h"
+#include <QResizeEvent>
+#include <QScrollBar>
+#include "tracer.h"
+
+namespace {
+const int Overscan = 1; //columns kept on either side of the viewport, a short scroll never waits for one
+const int MaxSpare = 4; //hidden widgets kept around for columns coming into view
+}
+
+ColumnStrip::ColumnStrip(BoardModel *model, QScrollArea *scrollArea, QWidget *parent)
+    : QWidget(parent)
+    , m_model(model)
+    , m_scrollArea(scrollArea)
+{
+    connect(m_model, &BoardModel::rowsInserted, this, &ColumnStrip::onRowsInserted);
+    connect(m_model, &BoardModel::rowsAboutToBeRemoved, this, &ColumnStrip::onRowsAboutToBeRemoved);
+    connect(m_model, &BoardModel::rowsRemoved, this, &ColumnStrip::onRowsRemoved);
+    connect(m_model, &BoardModel::rowsMoved, this, &ColumnStrip::onRowsMoved);
+    connect(m_model, &BoardModel::modelReset, this, &ColumnStrip::onModelReset);
+    connect(m_scrollArea->horizontalScrollBar(), &QScrollBar::valueChanged, this, &ColumnStrip::updateColumns);
+
+    updateWidth();
+}
+
+void ColumnStrip::setColumnFactory(const std::function<TodoColumn*(int row)> &create)
+{
+    m_create = create;
+}
+
+void ColumnStrip::setLoadingCheck(const std::function<bool(int row)> &check)
+{
+    m_isLoading = check;
+}
+
+void ColumnStrip::refreshLoading()
+{
+    for (int row = 0; row < m_columns.size(); ++row) {
+        if (TodoColumn *column = m_columns.at(row)) {
+            column->setLoading(m_isLoading && m_isLoading(row));
+        }
+    }
+}
+
+QRect ColumnStrip::columnRect(int row) const
+{
+    return QRect(Margin + row * (TodoColumn::Width + Spacing), Margin, TodoColumn::Width, qMax(0, height() - 2 * Margin));
+}
+
+TodoColumn *ColumnStrip::columnWidget(int row) const
+{
+    return m_columns.value(row);
+}
+
+bool ColumnStrip::isDragging() const
+{
+    for (const QList<TodoColumn*> *columns : {&m_columns, &m_pinned}) {
+        for (const TodoColumn *column : *columns) {
+            if (column && column->isDragSource()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ColumnStrip::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateColumns();
+}
+
+void ColumnStrip::updateColumns()
+{
+    TRACE_SPAN("update columns");
+    const int stride = TodoColumn::Width + Spacing;
+    const int left = m_scrollArea->horizontalScrollBar()->value();
+    const int right = left + m_scrollArea->viewport()->width();
+    const int first = qMax(0, (left - Margin) / stride - Overscan);
+    const int last = qMin(int(m_columns.size()) - 1, (right - Margin) / stride + Overscan);
+
+    //hand back what went out of view first, those widgets show the columns coming in;
+    //the one a drag started from stays bound, QDrag::exec() still runs inside it
+    for (int row = 0; row < m_columns.size(); ++row) {
+        if (m_columns.at(row) && (row < first || row > last) && !m_columns.at(row)->isDragSource()) {
+            release(m_columns.at(row));
+            m_columns[row] = nullptr;
+        }
+    }
+
+    for (int row = first; row <= last; ++row) {
+        TodoColumn *column = m_columns.at(row);
+        if (!column) {
+            if (!m_spare.isEmpty()) {
+                column = m_spare.takeLast();
+                column->setColumn(m_model->boardColumnIndex(row));
+            } else if (m_create) {
+                column = m_create(row);
+                column->setParent(this);
+                connect(column, &TodoColumn::dragFinished, this, [this, column]() {
+                    onDragFinished(column);
+                });
+            } else {
+                continue;
+            }
+            column->setLoading(m_isLoading && m_isLoading(row));
+            m_columns[row] = column;
+        }
+        column->setGeometry(columnRect(row));
+        column->show();
+    }
+
+    //a jump across the board can leave more behind than the next one needs
+    while (m_spare.size() > MaxSpare) {
+        m_spare.takeLast()->deleteLater(); //may be the sender of the current signal
+    }
+}
+
+void ColumnStrip::release(TodoColumn *column)
+{
+    column->hide();
+    if (column->isDragSource()) {
+        m_pinned.append(column); //its column went away, still nothing may rebind or delete it
+    } else {
+        m_spare.append(column);
+    }
+}
+
+void ColumnStrip::onDragFinished(TodoColumn *column)
+{
+    if (m_pinned.removeOne(column)) {
+        m_spare.append(column);
+    }
+    //lets go of it if the drag scrolled it out of view
+    updateColumns();
+    emit dragFinished();
+}
+
+void ColumnStrip::updateWidth()
+{
+    //only the minimum, the scroll area stretches the strip over a wider viewport
+    const int count = m_columns.size();
+    setMinimumWidth(2 * Margin + count * TodoColumn::Width + qMax(0, count - 1) * Spacing);
+}
+
+void ColumnStrip::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) { //todos are handled by the column views
+        return;
+    }
+    m_columns.insert(first, last - first + 1, nullptr);
+    updateWidth();
+    updateColumns();
+}
+
+void ColumnStrip::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    for (int row = last; row >= first; --row) {
+        if (TodoColumn *column = m_columns.at(row)) {
+            release(column); //may be the sender of the current signal, it is only hidden
+        }
+        m_columns.removeAt(row);
+    }
+}
+
+void ColumnStrip::onRowsRemoved(const QModelIndex &parent)
+{
+    //the rows left behind can only be bound once the model agrees on them
+    if (!parent.isValid()) {
+        updateWidth();
+        updateColumns();
+    }
+}
+
+void ColumnStrip::onRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row)
+{
+    if (parent.isValid() || destination.isValid()) {
+        return;
+    }
+
+    //the widgets follow their columns, their root indexes already did
+    const QList<TodoColumn*> moved = m_columns.mid(start, end - start + 1);
+    m_columns.remove(start, moved.size());
+    const int insertAt = row > start ? row - moved.size() : row;
+    for (int i = 0; i < moved.size(); ++i) {
+        m_columns.insert(insertAt + i, moved.at(i));
+    }
+    updateColumns();
+}
+
+void ColumnStrip::onModelReset()
+{
+    for (TodoColumn *column : std::as_const(m_columns)) {
+        if (column) {
+            release(column);
+        }
+    }
+    m_columns = QList<TodoColumn*>(m_model->boardColumnCount(), nullptr);
+    updateWidth();
+    updateColumns();
+}
@@ -0,0 +1,67 @@
+#ifndef COLUMNSTRIP_H
+#define COLUMNSTRIP_H
+
+#include <QWidget>
+#include <QScrollArea>
+#include <functional>
+#include "boardmodel.h"
+#include "todocolumn.h"
+
+//the board's columns side by side inside a horizontally scrolling area; every
+//column is TodoColumn::Width wide, so the strip's width and the place of each
+//column follow from the column count alone and only the columns around the
+//viewport exist as widgets, the ones scrolled away are reused for those coming in
+class ColumnStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static const int Margin = 16;
+    static const int Spacing = 16;
+
+    ColumnStrip(BoardModel *model, QScrollArea *scrollArea, QWidget *parent = nullptr);
+
+    //makes the widget for a board row that comes into view, only while none can be reused
+    void setColumnFactory(const std::function<TodoColumn*(int row)> &create);
+    //whether a board row takes no edits right now, asked for every column that comes into view
+    void setLoadingCheck(const std::function<bool(int row)> &check);
+    //asks the loading check again for the columns there are widgets for
+    void refreshLoading();
+
+    //where a board row sits in the strip, whether it has a widget or not
+    QRect columnRect(int row) const;
+    //nullptr for rows scrolled too far away to have a widget
+    TodoColumn *columnWidget(int row) const;
+
+    //true while a drag started from one of the columns runs its own event loop
+    bool isDragging() const;
+
+signals:
+    void dragFinished();
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent);
+    void onRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row);
+    void onModelReset();
+    void updateColumns();
+
+private:
+    void release(TodoColumn *column);
+    void onDragFinished(TodoColumn *column);
+    void updateWidth();
+
+    BoardModel *m_model;
+    QScrollArea *m_scrollArea;
+    std::function<TodoColumn*(int row)> m_create;
+    std::function<bool(int row)> m_isLoading;
+    QList<TodoColumn*> m_columns; //one per board row, nullptr where there is no widget
+    QList<TodoColumn*> m_spare;   //hidden, waiting to show another column
+    QList<TodoColumn*> m_pinned;  //released while a drag started from them runs, spare once it ends
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "duedatedialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLocale>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+DueDateDialog::DueDateDialog(qint64 dueAt, int repeatMinutes, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Due Date");
+
+    QDateTime due = QDateTime::fromMSecsSinceEpoch(dueAt);
+    if (dueAt == 0) {
+        due = QDateTime(QDate::currentDate().addDays(1), QTime(9, 0));
+    }
+    m_dateEdit = new QDateTimeEdit(due, this);
+    m_dateEdit->setCalendarPopup(true);
+    m_dateEdit->setDisplayFormat(QLocale().dateTimeFormat(QLocale::ShortFormat));
+
+    m_repeatBox = new QComboBox(this);
+    m_repeatBox->addItem("Once", 0);
+    m_repeatBox->addItem("Every Hour", 60);
+    m_repeatBox->addItem("Every Day", 24 * 60);
+    m_repeatBox->addItem("Every Week", 7 * 24 * 60);
+    if (m_repeatBox->findData(repeatMinutes) < 0) {
+        m_repeatBox->addItem(QString("Every %1 Minutes").arg(repeatMinutes), repeatMinutes); //set by another version or by hand
+    }
+    m_repeatBox->setCurrentIndex(m_repeatBox->findData(repeatMinutes));
+
+    QFormLayout *form = new QFormLayout();
+    form->addRow("&Due:", m_dateEdit);
+    form->addRow("&Remind:", m_repeatBox);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    QPushButton *removeButton = buttons->addButton("Re&move Due Date", QDialogButtonBox::DestructiveRole);
+    removeButton->setEnabled(dueAt != 0);
+    connect(removeButton, &QPushButton::clicked, this, [this]() {
+        m_removed = true;
+        accept();
+    });
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(buttons);
+}
+
+qint64 DueDateDialog::dueAt() const
+{
+    return m_removed ? 0 : m_dateEdit->dateTime().toMSecsSinceEpoch();
+}
+
+int DueDateDialog::repeatMinutes() const
+{
+    return m_removed ? 0 : m_repeatBox->currentData().toInt();
+}
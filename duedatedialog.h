@@ -0,0 +1,27 @@
+#ifndef DUEDATEDIALOG_H
+#define DUEDATEDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QDateTimeEdit>
+
+//asks for the due date of todos and how often to remind of them again;
+//dueAt() is 0 when the due date was removed
+class DueDateDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    //dueAt 0 starts from tomorrow morning
+    DueDateDialog(qint64 dueAt, int repeatMinutes, QWidget *parent = nullptr);
+
+    qint64 dueAt() const;
+    int repeatMinutes() const;
+
+private:
+    QDateTimeEdit *m_dateEdit;
+    QComboBox *m_repeatBox;
+    bool m_removed = false;
+};
+
+#endif
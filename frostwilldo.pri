@@ -0,0 +1,73 @@
+# everything except main(), shared by the app, the benchmarks and the tests
+
+QT += concurrent network
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/mainwindow.cpp \
+           $$PWD/archivedialog.cpp \
+           $$PWD/archivemodel.cpp \
+           $$PWD/boardarchive.cpp \
+           $$PWD/boardcache.cpp \
+           $$PWD/boardcli.cpp \
+           $$PWD/boardimporter.cpp \
+           $$PWD/boardindex.cpp \
+           $$PWD/boardmodel.cpp \
+           $$PWD/boardfiltermodel.cpp \
+           $$PWD/boardjournal.cpp \
+           $$PWD/boardstorage.cpp \
+           $$PWD/boardloader.cpp \
+           $$PWD/boardmerge.cpp \
+           $$PWD/boardwatcher.cpp \
+           $$PWD/columnstrip.cpp \
+           $$PWD/duedatedialog.cpp \
+           $$PWD/binaryboardformat.cpp \
+           $$PWD/instanceserver.cpp \
+           $$PWD/jsonboardformat.cpp \
+           $$PWD/reminderscheduler.cpp \
+           $$PWD/searchindex.cpp \
+           $$PWD/snapshotwriter.cpp \
+           $$PWD/startupprofile.cpp \
+           $$PWD/textarena.cpp \
+           $$PWD/textlayoutcache.cpp \
+           $$PWD/timerwheel.cpp \
+           $$PWD/theme.cpp \
+           $$PWD/tracer.cpp \
+           $$PWD/todoitemdelegate.cpp \
+           $$PWD/todolistview.cpp \
+           $$PWD/todocolumn.cpp
+
+HEADERS += $$PWD/mainwindow.h \
+           $$PWD/archivedialog.h \
+           $$PWD/archivemodel.h \
+           $$PWD/boardarchive.h \
+           $$PWD/boardcache.h \
+           $$PWD/boardcli.h \
+           $$PWD/boardimporter.h \
+           $$PWD/boardindex.h \
+           $$PWD/boarddata.h \
+           $$PWD/boardmodel.h \
+           $$PWD/boardfiltermodel.h \
+           $$PWD/boardjournal.h \
+           $$PWD/boardstorage.h \
+           $$PWD/boardloader.h \
+           $$PWD/boardmerge.h \
+           $$PWD/boardwatcher.h \
+           $$PWD/columnstrip.h \
+           $$PWD/duedatedialog.h \
+           $$PWD/binaryboardformat.h \
+           $$PWD/instanceserver.h \
+           $$PWD/jsonboardformat.h \
+           $$PWD/reminderscheduler.h \
+           $$PWD/searchindex.h \
+           $$PWD/snapshotwriter.h \
+           $$PWD/startupprofile.h \
+           $$PWD/textarena.h \
+           $$PWD/textlayoutcache.h \
+           $$PWD/timerwheel.h \
+           $$PWD/theme.h \
+           $$PWD/todoitem.h \
+           $$PWD/tracer.h \
+           $$PWD/todoitemdelegate.h \
+           $$PWD/todolistview.h \
+           $$PWD/todocolumn.h
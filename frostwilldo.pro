@@ -5,11 +5,6 @@ CONFIG += c++17
 TARGET = frostwilldo
 TEMPLATE = app
 
-SOURCES += main.cpp \
-           mainwindow.cpp \
-           todoitem.cpp \
-           todocolumn.cpp
-
-HEADERS += mainwindow.h \
-           todoitem.h \
-           todocolumn.h
+include(frostwilldo.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,193 @@
+#include "instanceserver.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace {
+const quint16 ProtocolVersion = 1;
+const int ConnectTimeoutMs = 200;
+const int ReplyTimeoutMs = 60000; //a command waits while the app is still loading a board
+const int LockTimeoutMs = 10000;  //another command line run is usually done long before
+const int LockRetryMs = 100;
+}
+
+InstanceRequest::InstanceRequest(QLocalSocket *socket)
+    : QObject(socket)
+    , m_socket(socket)
+{
+}
+
+InstanceRequest::Type InstanceRequest::type() const
+{
+    return m_type;
+}
+
+QStringList InstanceRequest::arguments() const
+{
+    return m_arguments;
+}
+
+QString InstanceRequest::workingDirectory() const
+{
+    return m_workingDirectory;
+}
+
+QByteArray InstanceRequest::input() const
+{
+    return m_input;
+}
+
+void InstanceRequest::reply(int exitCode, const QByteArray &output, const QByteArray &error)
+{
+    if (m_replied) {
+        return;
+    }
+    m_replied = true;
+
+    QByteArray message;
+    QDataStream out(&message, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << qint32(exitCode) << output << error;
+    m_socket->write(message);
+    m_socket->disconnectFromServer(); //after the reply is written, then the socket and this go
+}
+
+InstanceServer::InstanceServer(const QString &dataPath, QObject *parent)
+    : QObject(parent)
+    , m_dataPath(dataPath)
+    //one server per data directory, so per user
+    , m_serverName("frostwilldo-" + QCryptographicHash::hash(dataPath.toUtf8(), QCryptographicHash::Sha1).toHex().left(16))
+    , m_lock(dataPath + "/frostwilldo.lock")
+{
+    //held for as long as the app runs, an owner that crashed is still noticed by its pid
+    m_lock.setStaleLockTime(0);
+}
+
+InstanceServer::~InstanceServer()
+{
+    close(); //before the lock goes, so the next owner finds no socket in its way
+}
+
+bool InstanceServer::forwardOrLock(InstanceRequest::Type type, const QStringList &arguments, const QByteArray &input,
+                                   InstanceReply *reply)
+{
+    QDir().mkpath(m_dataPath);
+
+    //another launch may be starting up at the same time, whoever gets the lock first serves
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        if (forward(type, arguments, input, reply)) {
+            return true;
+        }
+        if (m_lock.tryLock(LockRetryMs)) {
+            return false;
+        }
+    } while (!timer.hasExpired(LockTimeoutMs));
+    return false;
+}
+
+bool InstanceServer::isLocked() const
+{
+    return m_lock.isLocked();
+}
+
+bool InstanceServer::forward(InstanceRequest::Type type, const QStringList &arguments, const QByteArray &input,
+                             InstanceReply *reply)
+{
+    QLocalSocket socket;
+    socket.connectToServer(m_serverName);
+    if (!socket.waitForConnected(ConnectTimeoutMs)) {
+        return false;
+    }
+
+    QByteArray message;
+    QDataStream out(&message, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << ProtocolVersion << quint8(type) << arguments << QDir::currentPath() << input;
+    socket.write(message);
+
+    //blocking, nothing else to do until the answer is there
+    QDataStream in(&socket);
+    in.setVersion(QDataStream::Qt_6_0);
+    QElapsedTimer timer;
+    timer.start();
+    forever {
+        qint32 exitCode = 0;
+        in.startTransaction();
+        in >> exitCode >> reply->output >> reply->error;
+        if (in.commitTransaction()) {
+            reply->exitCode = exitCode;
+            return true;
+        }
+        const qint64 left = ReplyTimeoutMs - timer.elapsed();
+        if (left <= 0 || !socket.waitForReadyRead(int(left))) {
+            break;
+        }
+    }
+    reply->exitCode = 1;
+    reply->output.clear();
+    reply->error = "frostwilldo: the running app did not answer\n";
+    return true;
+}
+
+bool InstanceServer::listen()
+{
+    if (!m_lock.isLocked()) {
+        return false;
+    }
+
+    //holding the lock, a socket still around was left by an owner that crashed
+    QLocalServer::removeServer(m_serverName);
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &InstanceServer::onNewConnection);
+    return m_server->listen(m_serverName);
+}
+
+void InstanceServer::close()
+{
+    delete m_server;
+    m_server = nullptr;
+}
+
+void InstanceServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        InstanceRequest *request = new InstanceRequest(socket);
+        connect(socket, &QLocalSocket::readyRead, request, [this, request]() {
+            readRequest(request);
+        });
+        readRequest(request); //may all be there already
+    }
+}
+
+void InstanceServer::readRequest(InstanceRequest *request)
+{
+    QLocalSocket *socket = request->m_socket;
+    QDataStream in(socket);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint16 version = 0;
+    quint8 type = 0;
+    in.startTransaction();
+    in >> version;
+    if (in.status() == QDataStream::Ok && version != ProtocolVersion) {
+        in.abortTransaction();
+        disconnect(socket, &QLocalSocket::readyRead, request, nullptr);
+        request->reply(2, QByteArray(), "frostwilldo: the running app is a different version, close it first\n");
+        return;
+    }
+    in >> type >> request->m_arguments >> request->m_workingDirectory >> request->m_input;
+    if (!in.commitTransaction()) {
+        return; //the rest is still on its way
+    }
+
+    disconnect(socket, &QLocalSocket::readyRead, request, nullptr);
+    request->m_type = type == InstanceRequest::Command ? InstanceRequest::Command : InstanceRequest::Activate;
+    emit requestReceived(request);
+}
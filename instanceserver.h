@@ -0,0 +1,96 @@
+#ifndef INSTANCESERVER_H
+#define INSTANCESERVER_H
+
+#include <QObject>
+#include <QLockFile>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+
+//a request from a later launch, answered by the instance that owns the boards
+class InstanceRequest : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Type : quint8 {
+        Activate = 1, //bring the window to the front
+        Command = 2   //run a command line, see BoardCli
+    };
+
+    Type type() const;
+    QStringList arguments() const;
+    QString workingDirectory() const;
+    QByteArray input() const; //stdin of the launch, for commands that read it
+
+    //sends the answer back, the launch prints output and error and exits with exitCode
+    void reply(int exitCode, const QByteArray &output = QByteArray(), const QByteArray &error = QByteArray());
+
+private:
+    friend class InstanceServer;
+    explicit InstanceRequest(QLocalSocket *socket);
+
+    QLocalSocket *m_socket;
+    Type m_type = Activate;
+    QStringList m_arguments;
+    QString m_workingDirectory;
+    QByteArray m_input;
+    bool m_replied = false;
+};
+
+struct InstanceReply
+{
+    int exitCode = 0;
+    QByteArray output;
+    QByteArray error;
+};
+
+//only one process at a time works on the boards: it holds frostwilldo.lock in the
+//data directory, and the app also listens on a local socket so that later launches,
+//the window or a command line, hand their request over to it and exit right away
+//
+//a request is a single message on the socket, written with QDataStream:
+//  quint16 protocol version, quint8 type, QStringList arguments,
+//  QString working directory, QByteArray stdin
+//answered by qint32 exit code, QByteArray stdout, QByteArray stderr
+class InstanceServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InstanceServer(const QString &dataPath, QObject *parent = nullptr);
+    ~InstanceServer() override;
+
+    //hands the request to the process that owns the boards, or makes this one the owner
+    //when there is none; true when it was handed over and reply holds the answer,
+    //otherwise isLocked() tells whether this process owns the boards now
+    bool forwardOrLock(InstanceRequest::Type type, const QStringList &arguments, const QByteArray &input,
+                       InstanceReply *reply);
+    bool isLocked() const;
+
+    //needs the lock, requests come in through requestReceived from then on
+    bool listen();
+    //later launches wait for the lock from then on, while this process winds down
+    void close();
+
+signals:
+    //the request is deleted along with its connection, keep it in a QPointer
+    void requestReceived(InstanceRequest *request);
+
+private slots:
+    void onNewConnection();
+
+private:
+    void readRequest(InstanceRequest *request);
+    //false when nobody is listening
+    bool forward(InstanceRequest::Type type, const QStringList &arguments, const QByteArray &input,
+                 InstanceReply *reply);
+
+    QString m_dataPath;
+    QString m_serverName;
+    QLockFile m_lock;
+    QLocalServer *m_server = nullptr;
+};
+
+#endif
@@ -0,0 +1,715 @@
+#include "jsonboardformat.h"
+#include <QtConcurrent>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include "tracer.h"
+
+namespace {
+const int MaxDepth = 1024; //the nesting QJsonDocument accepts
+
+//---- writing
+
+char hexDigit(uint value)
+{
+    return char(value < 10 ? '0' + value : 'a' + value - 10);
+}
+
+//escaped the way QJsonDocument does it: quotes, backslashes and control characters,
+//the rest as UTF-8, surrogates without their partner as \u escapes
+void appendString(QByteArray &out, const QString &text)
+{
+    out += '"';
+    const char16_t *p = reinterpret_cast<const char16_t*>(text.constData());
+    const char16_t *end = p + text.size();
+    while (p != end) {
+        //plain ASCII in one go, nearly every todo is nothing but
+        const char16_t *run = p;
+        while (p != end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        if (p != run) {
+            const qsizetype at = out.size();
+            out.resize(at + (p - run));
+            char *dst = out.data() + at;
+            while (run != p) {
+                *dst++ = char(*run++);
+            }
+        }
+        if (p == end) {
+            break;
+        }
+
+        const char16_t u = *p++;
+        if (u < 0x80) {
+            out += '\\';
+            switch (u) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case 0x08: out += 'b'; break;
+            case 0x0c: out += 'f'; break;
+            case 0x0a: out += 'n'; break;
+            case 0x0d: out += 'r'; break;
+            case 0x09: out += 't'; break;
+            default:
+                out += "u00";
+                out += hexDigit(u >> 4);
+                out += hexDigit(u & 0xf);
+            }
+        } else if (QChar::isHighSurrogate(u) && p != end && QChar::isLowSurrogate(*p)) {
+            const char32_t code = QChar::surrogateToUcs4(u, *p++);
+            out += char(0xf0 | (code >> 18));
+            out += char(0x80 | ((code >> 12) & 0x3f));
+            out += char(0x80 | ((code >> 6) & 0x3f));
+            out += char(0x80 | (code & 0x3f));
+        } else if (QChar::isSurrogate(u)) {
+            out += "\\u";
+            out += hexDigit(u >> 12);
+            out += hexDigit((u >> 8) & 0xf);
+            out += hexDigit((u >> 4) & 0xf);
+            out += hexDigit(u & 0xf);
+        } else if (u < 0x800) {
+            out += char(0xc0 | (u >> 6));
+            out += char(0x80 | (u & 0x3f));
+        } else {
+            out += char(0xe0 | (u >> 12));
+            out += char(0x80 | ((u >> 6) & 0x3f));
+            out += char(0x80 | (u & 0x3f));
+        }
+    }
+    out += '"';
+}
+
+//one element of the columns array, at the indentation it has in the whole file
+QByteArray writeColumn(const BoardColumnData &column)
+{
+    QByteArray out;
+    out.reserve(64 + column.items.size() * 160); //rough, spares most of the regrowing
+    out += "        {\n"
+           "            \"title\": ";
+    appendString(out, column.title);
+    out += ",\n"
+           "            \"todos\": [\n";
+    for (qsizetype i = 0; i < column.items.size(); ++i) {
+        const TodoItem &item = column.items.at(i);
+        out += "                {\n"
+               "                    \"checked\": ";
+        out += item.checked ? "true" : "false";
+        if (item.checkedAt != 0) {
+            out += ",\n"
+                   "                    \"checkedAt\": ";
+            out += QByteArray::number(item.checkedAt);
+        }
+        if (item.dueAt != 0) {
+            out += ",\n"
+                   "                    \"dueAt\": ";
+            out += QByteArray::number(item.dueAt);
+        }
+        out += ",\n"
+               "                    \"id\": ";
+        out += QByteArray::number(qint64(item.id));
+        if (item.remindAt != 0) {
+            out += ",\n"
+                   "                    \"remindAt\": ";
+            out += QByteArray::number(item.remindAt);
+        }
+        if (item.repeatMinutes != 0) {
+            out += ",\n"
+                   "                    \"repeatMinutes\": ";
+            out += QByteArray::number(item.repeatMinutes);
+        }
+        out += ",\n"
+               "                    \"text\": ";
+        appendString(out, item.text);
+        out += i + 1 < column.items.size() ? "\n                },\n" : "\n                }\n";
+    }
+    out += "            ]\n"
+           "        }";
+    return out;
+}
+
+//---- reading
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+//cursor over a piece of the document; everything read is checked against the JSON
+//grammar, a damaged file fails here the same way it fails QJsonDocument
+class Reader
+{
+public:
+    Reader(const char *begin, const char *end)
+        : m_p(begin)
+        , m_end(end)
+    {
+    }
+
+    //next character that is not white space, '\0' at the end
+    char peek()
+    {
+        while (m_p != m_end && (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t')) {
+            ++m_p;
+        }
+        return m_p != m_end ? *m_p : '\0';
+    }
+    bool consume(char c)
+    {
+        if (peek() != c) {
+            return false;
+        }
+        ++m_p;
+        return true;
+    }
+    bool atEnd()
+    {
+        peek();
+        return m_p == m_end;
+    }
+    const char *position() const
+    {
+        return m_p;
+    }
+    void seek(const char *p)
+    {
+        m_p = p;
+    }
+
+    //a member name, without a copy unless it has escapes
+    bool readKey(QByteArray *key);
+    //values of another type are skipped and read as false, 0 and empty,
+    //like QJsonValue::toBool(), toInteger() and toString()
+    bool readBool(bool *value);
+    bool readInteger(qint64 *value);
+    bool readString(QString *value);
+    bool skipValue();
+
+private:
+    bool decodeString(QString *value);
+    bool skipString();
+    bool readNumber(qint64 *value);
+    bool skipDigits();
+    bool skipLiteral(const char *literal);
+
+    const char *m_p;
+    const char *m_end;
+    int m_depth = 0;
+};
+
+//walks an object, member reads the value of each key
+template<typename Member>
+bool readObject(Reader &in, Member member)
+{
+    if (!in.consume('{')) {
+        return false;
+    }
+    if (in.consume('}')) {
+        return true;
+    }
+    do {
+        QByteArray key;
+        if (!in.readKey(&key) || !in.consume(':') || !member(key)) {
+            return false;
+        }
+    } while (in.consume(','));
+    return in.consume('}');
+}
+
+//walks an array, element reads each value
+template<typename Element>
+bool readArray(Reader &in, Element element)
+{
+    if (!in.consume('[')) {
+        return false;
+    }
+    if (in.consume(']')) {
+        return true;
+    }
+    do {
+        if (!element()) {
+            return false;
+        }
+    } while (in.consume(','));
+    return in.consume(']');
+}
+
+bool Reader::readKey(QByteArray *key)
+{
+    if (peek() != '"') {
+        return false;
+    }
+    const char *start = m_p + 1;
+    const char *p = start;
+    while (p != m_end && *p != '"' && *p != '\\' && uchar(*p) >= 0x20) {
+        ++p;
+    }
+    if (p != m_end && *p == '"') {
+        *key = QByteArray::fromRawData(start, p - start);
+        m_p = p + 1;
+        return true;
+    }
+    QString decoded;
+    if (!decodeString(&decoded)) {
+        return false;
+    }
+    *key = decoded.toUtf8();
+    return true;
+}
+
+bool Reader::readBool(bool *value)
+{
+    const char c = peek();
+    *value = c == 't';
+    if (c == 't') {
+        return skipLiteral("true");
+    }
+    return c == 'f' ? skipLiteral("false") : skipValue();
+}
+
+bool Reader::readInteger(qint64 *value)
+{
+    const char c = peek();
+    if (c == '-' || isDigit(c)) {
+        return readNumber(value);
+    }
+    *value = 0;
+    return skipValue();
+}
+
+bool Reader::readString(QString *value)
+{
+    if (peek() == '"') {
+        return decodeString(value);
+    }
+    value->clear();
+    return skipValue();
+}
+
+bool Reader::skipValue()
+{
+    if (++m_depth > MaxDepth) {
+        return false;
+    }
+    bool ok;
+    qint64 number;
+    switch (peek()) {
+    case '{':
+        ok = readObject(*this, [this](const QByteArray &) { return skipValue(); });
+        break;
+    case '[':
+        ok = readArray(*this, [this]() { return skipValue(); });
+        break;
+    case '"':
+        ok = skipString();
+        break;
+    case 't':
+        ok = skipLiteral("true");
+        break;
+    case 'f':
+        ok = skipLiteral("false");
+        break;
+    case 'n':
+        ok = skipLiteral("null");
+        break;
+    default:
+        ok = readNumber(&number);
+    }
+    --m_depth;
+    return ok;
+}
+
+bool Reader::decodeString(QString *value)
+{
+    if (!consume('"')) {
+        return false;
+    }
+    value->clear();
+    forever {
+        //runs without escapes are decoded in one go, a multi byte sequence never ends early
+        const char *run = m_p;
+        while (m_p != m_end && *m_p != '"' && *m_p != '\\' && uchar(*m_p) >= 0x20) {
+            ++m_p;
+        }
+        if (m_p == m_end || uchar(*m_p) < 0x20) {
+            return false;
+        }
+        if (m_p != run) {
+            if (value->isEmpty() && *m_p == '"') {
+                *value = QString::fromUtf8(run, m_p - run);
+            } else {
+                value->append(QString::fromUtf8(run, m_p - run));
+            }
+        }
+        if (*m_p++ == '"') {
+            return true;
+        }
+
+        if (m_p == m_end) {
+            return false;
+        }
+        switch (*m_p++) {
+        case '"': value->append(u'"'); break;
+        case '\\': value->append(u'\\'); break;
+        case '/': value->append(u'/'); break;
+        case 'b': value->append(u'\b'); break;
+        case 'f': value->append(u'\f'); break;
+        case 'n': value->append(u'\n'); break;
+        case 'r': value->append(u'\r'); break;
+        case 't': value->append(u'\t'); break;
+        case 'u': {
+            //surrogate pairs come as two escapes, each is one UTF-16 unit
+            if (m_end - m_p < 4) {
+                return false;
+            }
+            char16_t unit = 0;
+            for (int i = 0; i < 4; ++i) {
+                const char c = *m_p++;
+                const int digit = isDigit(c) ? c - '0'
+                                : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                                : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+                if (digit < 0) {
+                    return false;
+                }
+                unit = char16_t(unit << 4 | digit);
+            }
+            value->append(QChar(unit));
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+bool Reader::skipString()
+{
+    if (!consume('"')) {
+        return false;
+    }
+    while (m_p != m_end) {
+        const char c = *m_p++;
+        if (c == '"') {
+            return true;
+        }
+        if (uchar(c) < 0x20) {
+            return false;
+        }
+        if (c == '\\') {
+            if (m_p == m_end) {
+                return false;
+            }
+            const char escaped = *m_p++;
+            if (escaped == 'u') {
+                for (int i = 0; i < 4; ++i) {
+                    if (m_p == m_end || !isxdigit(uchar(*m_p++))) {
+                        return false;
+                    }
+                }
+            } else if (!std::strchr("\"\\/bfnrt", escaped) || escaped == '\0') {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+bool Reader::readNumber(qint64 *value)
+{
+    peek();
+    const char *start = m_p;
+    if (m_p != m_end && *m_p == '-') {
+        ++m_p;
+    }
+    if (m_p == m_end || !isDigit(*m_p)) {
+        return false;
+    }
+    if (*m_p++ != '0') { //no leading zeros
+        while (m_p != m_end && isDigit(*m_p)) {
+            ++m_p;
+        }
+    }
+    bool integral = true;
+    if (m_p != m_end && *m_p == '.') {
+        integral = false;
+        ++m_p;
+        if (!skipDigits()) {
+            return false;
+        }
+    }
+    if (m_p != m_end && (*m_p == 'e' || *m_p == 'E')) {
+        integral = false;
+        ++m_p;
+        if (m_p != m_end && (*m_p == '+' || *m_p == '-')) {
+            ++m_p;
+        }
+        if (!skipDigits()) {
+            return false;
+        }
+    }
+
+    //ids and times, short enough to add up without overflowing
+    const bool negative = *start == '-';
+    const char *digits = negative ? start + 1 : start;
+    if (integral && m_p - digits <= 18) {
+        qint64 number = 0;
+        for (const char *p = digits; p != m_p; ++p) {
+            number = number * 10 + (*p - '0');
+        }
+        *value = negative ? -number : number;
+        return true;
+    }
+
+    //anything else goes through a double, kept only when it is a whole number in range
+    bool ok = false;
+    const QByteArray text = QByteArray::fromRawData(start, m_p - start);
+    if (integral) {
+        *value = text.toLongLong(&ok);
+    }
+    if (!ok) {
+        const double number = text.toDouble(&ok);
+        ok = ok && std::trunc(number) == number && number >= -9223372036854775808.0 && number < 9223372036854775808.0;
+        *value = ok ? qint64(number) : 0;
+    }
+    return true;
+}
+
+bool Reader::skipDigits()
+{
+    if (m_p == m_end || !isDigit(*m_p)) {
+        return false;
+    }
+    while (m_p != m_end && isDigit(*m_p)) {
+        ++m_p;
+    }
+    return true;
+}
+
+bool Reader::skipLiteral(const char *literal)
+{
+    const qsizetype length = qsizetype(std::strlen(literal));
+    if (m_end - m_p < length || std::memcmp(m_p, literal, length) != 0) {
+        return false;
+    }
+    m_p += length;
+    return true;
+}
+
+//just past the object or array starting at p, found by counting brackets outside of
+//strings; nothing else is checked here, the column is read properly afterwards
+const char *findValueEnd(const char *p, const char *end)
+{
+    int depth = 0;
+    while (p != end) {
+        switch (*p++) {
+        case '"':
+            while (p != end && *p != '"') {
+                if (*p == '\\' && ++p == end) {
+                    return nullptr;
+                }
+                ++p;
+            }
+            if (p == end) {
+                return nullptr;
+            }
+            ++p;
+            break;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth <= 0) {
+                return p;
+            }
+            break;
+        }
+    }
+    return nullptr;
+}
+
+//one element of the columns array, found by the sequential pass and read in parallel
+struct ColumnSpan
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    BoardColumnData column;
+    bool ok = false;
+};
+
+bool readColumn(ColumnSpan &span)
+{
+    Reader in(span.begin, span.end);
+    BoardColumnData &column = span.column;
+    bool ok;
+    if (in.peek() != '{') {
+        ok = in.skipValue(); //an empty column, like QJsonValue::toObject() gives
+    } else {
+        ok = readObject(in, [&](const QByteArray &key) {
+            if (key == "title") {
+                return in.readString(&column.title);
+            }
+            if (key != "todos") {
+                return in.skipValue();
+            }
+            column.items.clear();
+            if (in.peek() != '[') {
+                return in.skipValue();
+            }
+            return readArray(in, [&]() {
+                TodoItem item;
+                if (in.peek() != '{') {
+                    if (!in.skipValue()) {
+                        return false;
+                    }
+                } else if (!readObject(in, [&](const QByteArray &key) {
+                               if (key == "text") {
+                                   return in.readString(&item.text);
+                               }
+                               if (key == "checked") {
+                                   return in.readBool(&item.checked);
+                               }
+                               if (key == "id") {
+                                   qint64 id;
+                                   const bool read = in.readInteger(&id);
+                                   item.id = quint64(id);
+                                   return read;
+                               }
+                               if (key == "checkedAt") {
+                                   return in.readInteger(&item.checkedAt);
+                               }
+                               if (key == "dueAt") {
+                                   return in.readInteger(&item.dueAt);
+                               }
+                               if (key == "remindAt") {
+                                   return in.readInteger(&item.remindAt);
+                               }
+                               if (key == "repeatMinutes") {
+                                   qint64 minutes;
+                                   const bool read = in.readInteger(&minutes);
+                                   item.repeatMinutes = qint32(minutes);
+                                   return read;
+                               }
+                               return in.skipValue();
+                           })) {
+                    return false;
+                }
+                column.items.append(item);
+                return true;
+            });
+        });
+    }
+    return ok && in.atEnd();
+}
+}
+
+QByteArray JsonBoardFormat::serialize(const BoardData &data)
+{
+    QList<QByteArray> columns;
+    {
+        TRACE_SPAN("write columns");
+        columns = QtConcurrent::blockingMapped<QList<QByteArray>>(data.columns, writeColumn);
+    }
+
+    qsizetype size = 64;
+    for (const QByteArray &column : columns) {
+        size += column.size() + 2;
+    }
+    QByteArray out;
+    out.reserve(size);
+    out += "{\n"
+           "    \"columns\": [\n";
+    for (qsizetype c = 0; c < columns.size(); ++c) {
+        out += columns.at(c);
+        out += c + 1 < columns.size() ? ",\n" : "\n";
+    }
+    out += "    ],\n"
+           "    \"sequence\": ";
+    out += QByteArray::number(qint64(data.sequence));
+    out += ",\n"
+           "    \"stamp\": ";
+    out += QByteArray::number(qint64(data.stamp));
+    out += "\n"
+           "}\n";
+    return out;
+}
+
+bool JsonBoardFormat::parse(const QByteArray &json, BoardData *data)
+{
+    const char *begin = json.constData();
+    const char *end = begin + json.size();
+    if (json.startsWith("\xef\xbb\xbf")) {
+        begin += 3; //a byte order mark some editors put in front
+    }
+
+    //only finds where each column starts and ends, reading them is left to the threads
+    Reader in(begin, end);
+    QList<ColumnSpan> spans;
+    qint64 sequence = 0;
+    qint64 stamp = 0;
+    bool ok;
+    if (in.peek() != '{') {
+        ok = in.skipValue(); //valid but not a board, no columns like QJsonDocument::object() gives
+    } else {
+        TRACE_SPAN("split columns");
+        ok = readObject(in, [&](const QByteArray &key) {
+            if (key == "sequence") {
+                return in.readInteger(&sequence);
+            }
+            if (key == "stamp") {
+                return in.readInteger(&stamp);
+            }
+            if (key != "columns") {
+                return in.skipValue();
+            }
+            spans.clear();
+            if (in.peek() != '[') {
+                return in.skipValue();
+            }
+            return readArray(in, [&]() {
+                ColumnSpan span;
+                const char c = in.peek();
+                span.begin = in.position();
+                if (c == '{' || c == '[') {
+                    span.end = findValueEnd(span.begin, end);
+                    if (!span.end) {
+                        return false;
+                    }
+                    in.seek(span.end);
+                } else {
+                    if (!in.skipValue()) {
+                        return false;
+                    }
+                    span.end = in.position();
+                }
+                spans.append(span);
+                return true;
+            });
+        });
+    }
+    if (!ok || !in.atEnd()) {
+        return false;
+    }
+
+    {
+        TRACE_SPAN("read columns");
+        QtConcurrent::blockingMap(spans, [](ColumnSpan &span) {
+            span.ok = readColumn(span);
+        });
+    }
+    for (const ColumnSpan &span : spans) {
+        if (!span.ok) {
+            return false;
+        }
+    }
+
+    data->columns.clear();
+    data->columns.reserve(spans.size());
+    for (const ColumnSpan &span : spans) {
+        data->columns.append(span.column);
+    }
+    data->sequence = sequence;
+    data->stamp = stamp;
+    return true;
+}
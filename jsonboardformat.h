@@ -0,0 +1,30 @@
+#ifndef JSONBOARDFORMAT_H
+#define JSONBOARDFORMAT_H
+
+#include <QByteArray>
+#include "boarddata.h"
+
+//frostwilldo.json read and written straight from and into the board, no QJsonDocument
+//in between; columns are independent, so each one is parsed or written on a core of
+//its own and the pieces are put together in order:
+//
+//  {"columns": [{"title": ..., "todos": [{"checked", "checkedAt", "dueAt", "id",
+//                                         "remindAt", "repeatMinutes", "text"}, ...]}, ...],
+//   "sequence": ..., "stamp": ...}
+//
+//the times and repeatMinutes are left out while they are 0
+//
+//the output is byte for byte what QJsonDocument::toJson() writes for the same board,
+//keys sorted and indented by four, tests/jsonboardformattest.cpp checks that. Files
+//now carry "id", "sequence" and "stamp", which versions from before those existed
+//skip on reading and drop on their next save
+class JsonBoardFormat
+{
+public:
+    static QByteArray serialize(const BoardData &data);
+    //false for anything QJsonDocument rejects as well, e.g. a file caught halfway
+    //through being written; members that are not part of a board are skipped
+    static bool parse(const QByteArray &json, BoardData *data);
+};
+
+#endif
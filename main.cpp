@@ -1,27 +1,142 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include "boardcli.h"
+#include "instanceserver.h"
 #include "mainwindow.h"
+#include "startupprofile.h"
+#include "theme.h"
+#include "tracer.h"
+
+namespace {
+QString dataPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+bool printsAndExits(const QStringList &arguments)
+{
+    for (const QString &arg : arguments.mid(1)) {
+        if (arg == "-h" || arg == "--help" || arg == "-?" || arg == "-v" || arg == "--version") {
+            return true;
+        }
+    }
+    return false;
+}
+
+void write(FILE *handle, const QByteArray &data)
+{
+    QFile file;
+    file.open(handle, QIODevice::WriteOnly);
+    file.write(data);
+}
+
+int runCommandLine(const QStringList &arguments)
+{
+    QByteArray input;
+    if (BoardCli::readsInput(arguments)) {
+        QFile in;
+        in.open(stdin, QIODevice::ReadOnly);
+        input = in.readAll();
+    }
+
+    //with the app running, it owns the boards and runs the command on what it has open
+    InstanceServer instance(dataPath());
+    InstanceReply reply;
+    if (instance.forwardOrLock(InstanceRequest::Command, arguments, input, &reply)) {
+        write(stdout, reply.output);
+        write(stderr, reply.error);
+        return reply.exitCode;
+    }
+    if (!instance.isLocked()) {
+        write(stderr, "frostwilldo: the boards are busy, try again\n");
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    return BoardCli().run(arguments, input, out, err);
+}
+}
 
 int main(int argc, char *argv[])
 {
+    StartupProfile::start();
+    QCoreApplication::setApplicationName("FrostWillDo");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    //frostwilldo <command> works on the boards without a window or any widget
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments.append(QString::fromLocal8Bit(argv[i]));
+    }
+    if (BoardCli::isCommandLine(arguments)) {
+        QCoreApplication app(argc, argv);
+        return runCommandLine(app.arguments());
+    }
+
+    //one application object for the whole process, Qt does not support a second one
+    //after the first is gone; the sockets below need its event dispatcher
     QApplication app(argc, argv);
+    StartupProfile::mark("application");
+
+    //a second launch only brings the running window to the front
+    InstanceServer instance(dataPath());
+    if (!printsAndExits(arguments)) {
+        InstanceReply reply;
+        if (instance.forwardOrLock(InstanceRequest::Activate, app.arguments(), QByteArray(), &reply)) {
+            return reply.exitCode;
+        }
+        if (!instance.isLocked()) {
+            qWarning("FrostWillDo is busy with the boards, try again");
+            return 1;
+        }
+    }
+    StartupProfile::mark("single instance check");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption traceOption("trace", "Write a Chrome trace of the session to <file> on exit.", "file");
+    parser.addOption(traceOption);
+    QCommandLineOption profileOption("startup-profile", "Print how long each startup phase took once the board is loaded.");
+    parser.addOption(profileOption);
+    parser.process(app);
+    StartupProfile::setEnabled(parser.isSet(profileOption));
+
+    //the flag wins over the environment, both have to be set before anything is timed
+    QString traceFile = parser.isSet(traceOption) ? parser.value(traceOption) : qEnvironmentVariable("FROSTWILLDO_TRACE");
+    if (!traceFile.isEmpty()) {
+        Tracer::enable(traceFile);
+    }
+    StartupProfile::mark("arguments");
+
+    //one style and palette for the whole app, no style sheets anywhere so
+    //widgets are never re-polished; the window applies the saved theme
+    app.setStyle(new ThemeStyle);
+    StartupProfile::mark("style");
+
+    int result;
+    {
+        MainWindow window;
+        StartupProfile::mark("window");
+        //later launches are handed to this window once it is there
+        QObject::connect(&instance, &InstanceServer::requestReceived, &window, &MainWindow::handleRequest);
+        if (!instance.listen()) {
+            qWarning("Could not listen for other launches, they will wait until this one exits");
+        }
+        window.show();
+        StartupProfile::mark("show");
+        result = app.exec();
+    }
+    instance.close(); //while the event dispatcher is still there, the lock is held to the end
 
-    app.setApplicationName("FrostWillDo");
-    app.setApplicationVersion("1.0");
-
-    //set dark theme globally
-    app.setStyleSheet(
-        "QCheckBox { color: #ffffff; }"
-        "QCheckBox::indicator:unchecked { background-color: #2b2b2b; border: 1px solid #606060; }"
-        "QCheckBox::indicator:checked { background-color: #4dabf7; border: 1px solid #4dabf7; }"
-        "QInputDialog { background-color: #2b2b2b; color: #ffffff; }"
-        "QLineEdit { background-color: #1e1e1e; color: #ffffff; border: 1px solid #404040; padding: 4px; }"
-        "QScrollBar:vertical { background-color: #2b2b2b; width: 12px; }"
-        "QScrollBar::handle:vertical { background-color: #606060; border-radius: 6px; }"
-        "QScrollBar::handle:vertical:hover { background-color: #707070; }"
-    );
-
-    MainWindow window;
-    window.show();
-
-    return app.exec();
+    //after the window is gone: the closing fold ran inside exec(), but a background
+    //write still in flight only finishes while the window's snapshot writer is destroyed
+    if (Tracer::isEnabled() && !Tracer::dump()) {
+        qWarning("Could not write the trace to %s", qPrintable(traceFile));
+    }
+    return result;
 }
@@ -1,29 +1,58 @@
 #include "mainwindow.h"
+#include "binaryboardformat.h"
 #include <QInputDialog>
 #include <QMessageBox>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QStandardPaths>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QCloseEvent>
+#include <QSettings>
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
 #include <QDropEvent>
 #include <QMimeData>
+#include <QStatusBar>
+#include <QActionGroup>
+#include <QScreen>
+#include <QCursor>
+#include <QScrollBar>
+#include <QFileDialog>
+#include <QBuffer>
+#include <QTextStream>
+#include <QApplication>
+#include <QDateTime>
+#include <QSet>
+#include "boardarchive.h"
+#include "boardcli.h"
+#include "theme.h"
+#include "startupprofile.h"
+#include "textlayoutcache.h"
+#include "tracer.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , m_dataPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation))
+    , m_boards(m_dataPath)
 {
-    setWindowTitle("FrostWillDo");
+    QDir().mkpath(m_dataPath);
+
     setMinimumSize(800, 600);
-    setStyleSheet("QMainWindow { background-color: #121212; } QMenuBar { background-color: #1e1e1e; color: #ffffff; } QMenuBar::item:selected { background-color: #404040; }");
     setAcceptDrops(true);
 
-    //set up data file path location: $HOME/.local/share/FrostWillDo/frostwilldo.json
-    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir().mkpath(appDataPath);
-    m_dataFile = appDataPath + "/frostwilldo.json";
+    //the model owns the board, column widgets just follow it
+    m_model = new BoardModel(this);
+    m_filter = new BoardFilterModel(m_model, this); //what the columns show while searching
+
+    //boards live in the app data directory ($HOME/.local/share/FrostWillDo on linux),
+    //boards.json lists them and frostwilldo.ini holds the settings
+    m_settingsFile = m_dataPath + "/frostwilldo.ini";
+    QSettings settings(m_settingsFile, QSettings::IniFormat);
+    ThemeManager::instance()->setTheme(settings.value("appearance/theme", "Dark").toString());
+    m_binaryStorage = settings.value("storage/format", "json").toString() == "binary";
+    m_archiveAfterDays = settings.value("archive/afterDays", 30).toInt();
+    m_boardCache.setLimits(settings.value("boards/cached", 3).toInt(), settings.value("boards/cachedMegabytes", 32).toLongLong() * 1024 * 1024);
+    m_boards.loadOrCreate();
 
     //menu bar
     QMenuBar *menuBar = this->menuBar();
@@ -33,6 +62,12 @@ MainWindow::MainWindow(QWidget *parent)
     addColumnAction->setShortcut(QKeySequence::New);
     connect(addColumnAction, &QAction::triggered, this, &MainWindow::addColumn);
 
+    QAction *importAction = fileMenu->addAction("&Import...");
+    connect(importAction, &QAction::triggered, this, &MainWindow::importTodos);
+
+    QAction *archiveDoneAction = fileMenu->addAction("Archive &Done Todos");
+    connect(archiveDoneAction, &QAction::triggered, this, &MainWindow::archiveDoneTodos);
+
     fileMenu->addSeparator();
 
     QAction *saveAction = fileMenu->addAction("&Save");
@@ -45,34 +80,138 @@ MainWindow::MainWindow(QWidget *parent)
     exitAction->setShortcut(QKeySequence::Quit);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
 
+    //filled every time it opens, the counts come from the index
+    m_boardsMenu = menuBar->addMenu("&Boards");
+    connect(m_boardsMenu, &QMenu::aboutToShow, this, &MainWindow::populateBoardsMenu);
+
+    QMenu *viewMenu = menuBar->addMenu("&View");
+
+    QAction *findAction = viewMenu->addAction("&Find");
+    findAction->setShortcut(QKeySequence::Find);
+    connect(findAction, &QAction::triggered, this, [this]() {
+        m_searchEdit->setFocus(Qt::ShortcutFocusReason);
+        m_searchEdit->selectAll();
+    });
+
+    QAction *archiveAction = viewMenu->addAction("&Archive...");
+    connect(archiveAction, &QAction::triggered, this, &MainWindow::showArchive);
+
+    viewMenu->addSeparator();
+    m_themeMenu = viewMenu->addMenu("&Theme");
+    connect(m_themeMenu, &QMenu::aboutToShow, this, &MainWindow::populateThemeMenu);
+
     //central widget setup
     m_scrollArea = new QScrollArea(this);
+    m_scrollArea->setFrameShape(QFrame::NoFrame);
     m_scrollArea->setWidgetResizable(true);
     m_scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     m_scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 
-    m_centralWidget = new QWidget();
-    m_centralWidget->setStyleSheet("background-color: #121212;");
-
-    m_columnsLayout = new QHBoxLayout(m_centralWidget);
-    m_columnsLayout->setContentsMargins(16, 16, 16, 16);
-    m_columnsLayout->setSpacing(16);
-    m_columnsLayout->addStretch();
+    //only the columns around the viewport are widgets, boards with hundreds stay light
+    m_columnStrip = new ColumnStrip(m_model, m_scrollArea);
+    m_columnStrip->setColumnFactory([this](int row) { return createColumnWidget(row); });
+    connect(m_columnStrip, &ColumnStrip::dragFinished, this, &MainWindow::processRequests, Qt::QueuedConnection);
+    m_columnStrip->setLoadingCheck([this](int row) { return isColumnLoading(row); });
+    m_scrollArea->setWidget(m_columnStrip);
+
+    m_autoScrollTimer = new QTimer(this);
+    connect(m_autoScrollTimer, &QTimer::timeout, this, &MainWindow::autoScroll);
+
+    //search bar above the board, filters the columns as you type
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search todos");
+    m_searchEdit->setClearButtonEnabled(true);
+    QAction *clearSearchAction = new QAction(m_searchEdit);
+    clearSearchAction->setShortcut(Qt::Key_Escape);
+    clearSearchAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(clearSearchAction, &QAction::triggered, m_searchEdit, &QLineEdit::clear);
+    m_searchEdit->addAction(clearSearchAction);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
+
+    QWidget *boardWidget = new QWidget(this);
+    QVBoxLayout *boardLayout = new QVBoxLayout(boardWidget);
+    boardLayout->setContentsMargins(16, 16, 16, 0);
+    boardLayout->setSpacing(0);
+    boardLayout->addWidget(m_searchEdit);
+    boardLayout->addWidget(m_scrollArea, 1);
+    setCentralWidget(boardWidget);
+
+    //last save latency and size, so slow saves are easy to spot
+    m_saveStatusLabel = new QLabel(this);
+    m_saveStatusLabel->setForegroundRole(QPalette::PlaceholderText); //muted, follows the theme
+    statusBar()->addPermanentWidget(m_saveStatusLabel);
+
+    //open the board used last, it loads while the window is already up; whatever
+    //the first frame does not need waits for finishStartup()
+    QString current = m_boards.currentBoard();
+    openBoard(m_boards.contains(current) ? current : m_boards.boards().first().id);
+}
 
-    m_scrollArea->setWidget(m_centralWidget);
-    setCentralWidget(m_scrollArea);
+bool MainWindow::event(QEvent *event)
+{
+    //the first paint event starts the first frame, a queued call runs once it is flushed;
+    //a window that never gets painted (minimized, on a hidden desktop) still finishes
+    //starting up from a zero timer queued when it is shown, whichever comes first wins
+    if (event->type() == QEvent::Paint && !m_painted) {
+        m_painted = true;
+        QMetaObject::invokeMethod(this, &MainWindow::finishStartup, Qt::QueuedConnection);
+    } else if (event->type() == QEvent::Show && !m_startupQueued) {
+        m_startupQueued = true;
+        QTimer::singleShot(0, this, &MainWindow::finishStartup);
+    }
+    return QMainWindow::event(event);
+}
 
-    //load saved data or create defaults
-    loadData();
+void MainWindow::finishStartup()
+{
+    if (m_startupFinished) {
+        return;
+    }
+    StartupProfile::mark(m_painted ? "first paint" : "shown");
+    TRACE_SPAN("deferred setup");
+
+    //shown while a file is imported, the board stays usable meanwhile
+    m_importProgress = new QProgressBar(this);
+    m_importProgress->setRange(0, 1000);
+    m_importProgress->setTextVisible(false);
+    m_importProgress->setMaximumWidth(160);
+    m_importProgress->hide();
+    m_importCancelButton = new QPushButton("Cancel", this);
+    m_importCancelButton->hide();
+    connect(m_importCancelButton, &QPushButton::clicked, this, [this]() {
+        if (m_importer) {
+            m_importer->cancel();
+        }
+    });
+    statusBar()->addPermanentWidget(m_importProgress);
+    statusBar()->addPermanentWidget(m_importCancelButton);
 
-    //setup auto-save
     setupAutoSave();
+
+    //done todos age while the app stays open, the hour is plenty for a days setting
+    m_archiveTimer = new QTimer(this);
+    m_archiveTimer->setInterval(3600000);
+    connect(m_archiveTimer, &QTimer::timeout, this, &MainWindow::autoArchive);
+    m_archiveTimer->start();
+
+    //every reminder of the board hangs off a single timer
+    m_reminders = new ReminderScheduler(m_model, this);
+    connect(m_reminders, &ReminderScheduler::remindersDue, this, &MainWindow::onRemindersDue);
+    StartupProfile::mark("deferred setup");
+
+    m_startupFinished = true;
+    if (!m_loader) {
+        StartupProfile::finish(); //a small board is loaded before its first frame
+    }
 }
 
 void MainWindow::dragEnterEvent(QDragEnterEvent *event)
 {
     if (event->mimeData()->hasFormat("application/x-todocolumn")) {
         event->acceptProposedAction();
+        startAutoScroll();
+    } else if (!importableFile(event->mimeData()).isEmpty()) {
+        event->acceptProposedAction();
     }
 }
 
@@ -80,40 +219,131 @@ void MainWindow::dragMoveEvent(QDragMoveEvent *event)
 {
     if (event->mimeData()->hasFormat("application/x-todocolumn")) {
         event->acceptProposedAction();
+        startAutoScroll();
+    } else if (!importableFile(event->mimeData()).isEmpty()) {
+        event->acceptProposedAction();
     }
 }
 
-void MainWindow::dropEvent(QDropEvent *event)
+void MainWindow::dragLeaveEvent(QDragLeaveEvent *event)
 {
-    if (event->mimeData()->hasFormat("application/x-todocolumn")) {
-        QByteArray columnData = event->mimeData()->data("application/x-todocolumn");
-        TodoColumn *column = reinterpret_cast<TodoColumn*>(columnData.toLongLong());
+    Q_UNUSED(event);
+    m_autoScrollTimer->stop();
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    //todo drags are taken by the columns, watch them to scroll the board sideways
+    switch (event->type()) {
+    case QEvent::DragEnter:
+    case QEvent::DragMove:
+        startAutoScroll();
+        break;
+    case QEvent::DragLeave:
+    case QEvent::Drop:
+        m_autoScrollTimer->stop();
+        break;
+    default:
+        break;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
 
-        if (column) {
-            //remove from current position
-            m_columnsLayout->removeWidget(column);
+void MainWindow::startAutoScroll()
+{
+    if (m_autoScrollTimer->isActive()) {
+        return;
+    }
+    qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    m_autoScrollTimer->setInterval(qMax(8, int(1000 / qMax(refreshRate, 1.0))));
+    m_autoScrollTimer->start();
+}
 
-            //insert at new position
-            QPoint centralPos = m_centralWidget->mapFrom(this, event->position().toPoint());
-            int dropIndex = getColumnDropIndex(centralPos);
-            m_columnsLayout->insertWidget(dropIndex, column);
+void MainWindow::autoScroll()
+{
+    //the closer to the edge of the board, the faster it scrolls
+    const int edge = 48;
+    QWidget *viewport = m_scrollArea->viewport();
+    QPoint pos = viewport->mapFromGlobal(QCursor::pos());
+    int step = 0;
+    if (pos.x() < edge) {
+        step = -(edge - qMax(pos.x(), 0));
+    } else if (pos.x() > viewport->width() - edge) {
+        step = qMin(pos.x(), viewport->width()) - viewport->width() + edge;
+    }
 
-            autoSave(); //save the new order
+    if (step == 0 || pos.y() < 0 || pos.y() > viewport->height()) {
+        m_autoScrollTimer->stop(); //the next drag move starts it again
+        return;
+    }
+    QScrollBar *scrollBar = m_scrollArea->horizontalScrollBar();
+    scrollBar->setValue(scrollBar->value() + step / 2);
+}
+
+void MainWindow::dropEvent(QDropEvent *event)
+{
+    m_autoScrollTimer->stop();
+
+    if (event->mimeData()->hasFormat("application/x-todocolumn")) {
+        TRACE_SPAN("drop column");
+        //-1 for a column removed during the drag
+        TodoColumn *source = qobject_cast<TodoColumn*>(event->source());
+        const int row = source ? source->modelRow() : -1;
+
+        if (row >= 0 && row < m_model->boardColumnCount()) {
+            //the strip follows the model through rowsMoved
+            QPoint stripPos = m_columnStrip->mapFrom(this, event->position().toPoint());
+            int dropIndex = getColumnDropIndex(stripPos);
+            m_model->moveBoardColumn(row, dropIndex);
         }
 
         event->acceptProposedAction();
+        return;
+    }
+
+    QString fileName = importableFile(event->mimeData());
+    if (!fileName.isEmpty()) {
+        //the columns pass files on, dropped onto one its todos go there
+        int column = 0;
+        for (QWidget *child = childAt(event->position().toPoint()); child; child = child->parentWidget()) {
+            if (TodoColumn *todoColumn = qobject_cast<TodoColumn*>(child)) {
+                column = todoColumn->modelRow();
+                break;
+            }
+        }
+        event->acceptProposedAction();
+        importFile(fileName, column);
     }
 }
 
-int MainWindow::getColumnDropIndex(const QPoint &pos)
+QString MainWindow::importableFile(const QMimeData *mimeData) const
 {
-    for (int i = 0; i < m_columnsLayout->count() - 1; ++i) { //-1 to skip stretch
-        QWidget *widget = m_columnsLayout->itemAt(i)->widget();
-        if (widget && pos.x() < widget->x() + widget->width() / 2) {
-            return i;
+    if (m_loader || m_importer || !mimeData->hasUrls()) {
+        return QString();
+    }
+    for (const QUrl &url : mimeData->urls()) {
+        if (url.isLocalFile() && BoardImporter::canImport(url.toLocalFile())) {
+            return url.toLocalFile();
         }
     }
-    return m_columnsLayout->count() - 1; //insert before stretch
+    return QString();
+}
+
+int MainWindow::getColumnDropIndex(const QPoint &pos)
+{
+    //columns all have the same width, so the slot follows from the x position,
+    //whether the columns around it have widgets or not
+    const int count = m_model->boardColumnCount();
+    if (count == 0) {
+        return 0;
+    }
+    const QRect first = m_columnStrip->columnRect(0);
+    const int stride = first.width() + ColumnStrip::Spacing;
+    const int half = first.x() + first.width() / 2; //drop before a column left of its middle
+    if (pos.x() < half) {
+        return 0;
+    }
+    return qMin(count, (pos.x() - half) / stride + 1);
 }
 
 void MainWindow::addColumn()
@@ -121,10 +351,7 @@ void MainWindow::addColumn()
     bool ok;
     QString title = QInputDialog::getText(this, "Add Column", "Column title:", QLineEdit::Normal, "", &ok);
     if (ok && !title.isEmpty()) {
-        TodoColumn *column = new TodoColumn(title, this);
-        m_columnsLayout->insertWidget(m_columnsLayout->count() - 1, column);
-        connect(column, &TodoColumn::deleteRequested, this, &MainWindow::deleteColumn);
-        autoSave(); //save immediately when adding column
+        m_model->insertBoardColumn(m_model->boardColumnCount(), title);
     }
 }
 
@@ -138,96 +365,575 @@ void MainWindow::deleteColumn()
                                        QMessageBox::Yes | QMessageBox::No);
 
         if (ret == QMessageBox::Yes) {
-            m_columnsLayout->removeWidget(column);
-            column->deleteLater();
-            autoSave(); //save immediately when deleting column
+            m_model->removeBoardColumn(column->modelRow());
         }
     }
 }
 
+void MainWindow::archiveTodo(const QList<int> &rows)
+{
+    TodoColumn *column = qobject_cast<TodoColumn*>(sender());
+    if (column) {
+        const int columnRow = column->modelRow();
+        const QSet<int> picked(rows.begin(), rows.end());
+        const int archived = archiveTodos([columnRow, &picked](int c, int r, const TodoItem &) {
+            return c == columnRow && picked.contains(r);
+        });
+        if (archived == 1) {
+            statusBar()->showMessage("Archived the todo, View > Archive brings it back", 5000);
+        } else if (archived > 1) {
+            statusBar()->showMessage(QString("Archived %1 todos, View > Archive brings them back").arg(archived), 5000);
+        }
+    }
+}
+
+void MainWindow::archiveDoneTodos()
+{
+    const int archived = archiveTodos([](int, int, const TodoItem &item) { return item.checked; });
+    statusBar()->showMessage(QString("Archived %1 done todos").arg(archived), 5000);
+}
+
+void MainWindow::autoArchive()
+{
+    if (m_archiveAfterDays <= 0 || m_loader || m_importer || !m_storage) {
+        return;
+    }
+
+    //a todo checked before the cut off has been done long enough
+    const qint64 cutOff = QDateTime::currentMSecsSinceEpoch() - qint64(m_archiveAfterDays) * 24 * 3600 * 1000;
+    const int archived = archiveTodos([cutOff](int, int, const TodoItem &item) {
+        return item.checked && item.checkedAt > 0 && item.checkedAt <= cutOff;
+    });
+    if (archived > 0) {
+        statusBar()->showMessage(QString("Archived %1 todos done more than %2 days ago").arg(archived).arg(m_archiveAfterDays), 5000);
+    }
+}
+
+int MainWindow::archiveTodos(const std::function<bool(int column, int row, const TodoItem &item)> &pick)
+{
+    //the loader and the importer hold on to rows of the model
+    if (m_loader || m_importer) {
+        statusBar()->showMessage("Wait until the board is loaded", 3000);
+        return 0;
+    }
+
+    TRACE_SPAN("archive todos");
+    const int archived = m_archive.archive(m_model, pick);
+    if (archived < 0) {
+        statusBar()->showMessage(QString("Could not write the archive, the todos stay on the board: %1").arg(m_archive.errorString()), 5000);
+        return 0;
+    }
+    if (archived > 0) {
+        updateBoardInfo();
+        if (m_archiveDialog) {
+            m_archiveDialog->refresh();
+        }
+    }
+    return archived;
+}
+
+void MainWindow::showArchive()
+{
+    if (!m_archiveDialog) {
+        m_archiveDialog = new ArchiveDialog(archiveFile(), this);
+        m_archiveDialog->setAttribute(Qt::WA_DeleteOnClose);
+        m_archiveDialog->setWindowTitle(QString("Archive - %1").arg(m_boards.board(m_boards.currentBoard()).name));
+        connect(m_archiveDialog, &ArchiveDialog::restoreRequested, this, &MainWindow::restoreArchived);
+    }
+    m_archiveDialog->show();
+    m_archiveDialog->raise();
+    m_archiveDialog->activateWindow();
+}
+
+void MainWindow::restoreArchived(const QList<ArchivedTodo> &todos)
+{
+    if (m_loader || m_importer) {
+        statusBar()->showMessage("Wait until the board is loaded", 3000);
+        return;
+    }
+
+    if (m_archive.restore(m_model, todos)) {
+        statusBar()->showMessage(QString("Restored %1 todos").arg(todos.size()), 5000);
+    } else {
+        statusBar()->showMessage("Restored, but the archive could not be updated, the todos are listed there as well", 5000);
+    }
+    updateBoardInfo();
+    if (m_archiveDialog) {
+        m_archiveDialog->refresh();
+    }
+}
+
+QString MainWindow::archiveFile() const
+{
+    return m_boards.boardFile(m_boards.board(m_boards.currentBoard()), "archive");
+}
+
+void MainWindow::populateThemeMenu()
+{
+    m_themeMenu->clear();
+
+    QActionGroup *group = new QActionGroup(m_themeMenu);
+    for (const QString &name : ThemeManager::instance()->themeNames()) {
+        QAction *action = m_themeMenu->addAction(name);
+        action->setCheckable(true);
+        action->setChecked(name == ThemeManager::instance()->theme().name);
+        group->addAction(action);
+        connect(action, &QAction::triggered, this, [this, name]() { setTheme(name); });
+    }
+}
+
+void MainWindow::setTheme(const QString &name)
+{
+    ThemeManager::instance()->setTheme(name);
+    QSettings settings(m_settingsFile, QSettings::IniFormat);
+    settings.setValue("appearance/theme", name);
+}
+
+void MainWindow::onSearchTextChanged(const QString &text)
+{
+    m_filter->setSearchText(text);
+    if (text.isEmpty()) {
+        statusBar()->clearMessage();
+    } else {
+        statusBar()->showMessage(QString("%1 matching todos").arg(m_filter->matchCount()));
+    }
+}
+
 void MainWindow::saveData()
 {
-    QJsonObject root;
-    QJsonArray columnsArray;
+    //every edit is already in the journal, this folds it into a new snapshot
+    m_storage->save();
+}
+
+void MainWindow::openBoard(const QString &id)
+{
+    if (m_loader || m_importer || !m_boards.contains(id)) {
+        return; //the current board is still filling in
+    }
+    if (m_storage) {
+        closeBoard();
+    }
+
+    BoardInfo info = m_boards.board(id);
+    info.lastOpened = QDateTime::currentDateTime();
+    m_boards.updateBoard(info);
+    m_boards.setCurrentBoard(id);
+    m_boards.save();
+    m_archive = BoardArchive(archiveFile());
+    setWindowTitle(QString("%1 - FrostWillDo").arg(info.name));
+
+    BoardFormat format = m_binaryStorage ? BoardFormat::Binary : BoardFormat::Json;
+    m_storage = new BoardStorage(BoardStorage::boardFile(m_boards, info, format), this);
+    connect(m_storage->snapshotWriter(), &SnapshotWriter::saved, this, &MainWindow::onSnapshotSaved);
+    connect(m_storage->snapshotWriter(), &SnapshotWriter::saveFailed, this, [this](quint64, const QString &error) {
+        statusBar()->showMessage(QString("Saving failed: %1").arg(error), 5000);
+    });
+    m_saveStatusLabel->clear();
+
+    if (m_boardCache.contains(id)) {
+        //still in memory from earlier, one reset and it is back
+        MergeBase base;
+        const BoardSnapshot snapshot = m_boardCache.take(id, &base);
+        m_model->setBoardSnapshot(snapshot);
+        m_storage->attach(m_model, snapshot.sequence, snapshot.stamp);
+        watchBoard(base);
+        autoArchive();
+        return;
+    }
+    loadData();
+}
+
+void MainWindow::closeBoard()
+{
+    if (m_archiveDialog) {
+        m_archiveDialog->close(); //shows the archive of the board that is going away
+    }
+    if (m_reminderBox) {
+        m_reminderBox->close();
+    }
+    updateBoardInfo();
+
+    //the journal is folded into the file, and the watcher's base follows every save; if
+    //folding fails the cached copy still continues the file as the watcher last knew it
+    m_storage->fold();
+    BoardSnapshot snapshot = m_model->snapshot();
+    snapshot.sequence = m_storage->sequence();
+    snapshot.stamp = m_storage->stamp();
+    m_boardCache.insert(m_boards.currentBoard(), snapshot, m_watcher ? m_watcher->base() : MergeBase(snapshot));
+    //the next board shares few texts with this one
+    TextLayoutCache::instance()->clear();
+
+    //the journal goes first so the reset to the next board is not logged into it
+    delete m_storage;
+    m_storage = nullptr;
+}
+
+void MainWindow::watchBoard(const MergeBase &base)
+{
+    //owned by the storage, both go when the board is closed
+    m_watcher = new BoardWatcher(m_storage, m_model, m_storage);
+    //a drag carries todo ids, but the rows it shows under the cursor must not shift under it
+    m_watcher->setBusyCheck([this]() { return m_importer != nullptr || m_columnStrip->isDragging(); });
+    connect(m_watcher, &BoardWatcher::merged, this, &MainWindow::onBoardMerged);
+    m_watcher->start(base);
+}
+
+void MainWindow::updateBoardInfo()
+{
+    //runs after every save, the model keeps its counts so this is no walk over the
+    //board, and boards.json is only written when what the switcher shows changed
+    QStringList columnTitles;
+    for (int column = 0; column < m_model->boardColumnCount(); ++column) {
+        columnTitles.append(m_model->boardColumnTitle(column));
+    }
+    if (m_boards.updateCounts(m_boards.currentBoard(), columnTitles, m_model->todoCount(), m_model->doneCount())) {
+        m_boards.saveInBackground();
+    }
+}
+
+void MainWindow::populateBoardsMenu()
+{
+    m_boardsMenu->clear();
+
+    QActionGroup *group = new QActionGroup(m_boardsMenu);
+    for (const BoardInfo &info : m_boards.boards()) {
+        QAction *action = m_boardsMenu->addAction(QString("%1\t%2 todos").arg(info.name).arg(info.itemCount));
+        action->setCheckable(true);
+        action->setChecked(info.id == m_boards.currentBoard());
+        action->setEnabled(!m_loader && !m_importer);
+        group->addAction(action);
+        const QString id = info.id;
+        connect(action, &QAction::triggered, this, [this, id]() {
+            if (id != m_boards.currentBoard()) {
+                openBoard(id);
+            }
+        });
+    }
+
+    m_boardsMenu->addSeparator();
+    QAction *newAction = m_boardsMenu->addAction("&New Board...", this, &MainWindow::newBoard);
+    newAction->setEnabled(!m_loader && !m_importer);
+    m_boardsMenu->addAction("&Rename Board...", this, &MainWindow::renameBoard);
+    QAction *deleteAction = m_boardsMenu->addAction("&Delete Board...", this, &MainWindow::deleteBoard);
+    deleteAction->setEnabled(!m_loader && m_boards.boards().size() > 1);
+}
+
+void MainWindow::newBoard()
+{
+    bool ok;
+    QString name = QInputDialog::getText(this, "New Board", "Board name:", QLineEdit::Normal, "", &ok);
+    if (ok && !name.isEmpty()) {
+        BoardInfo info = m_boards.addBoard(name);
+        m_boards.save();
+        openBoard(info.id);
+    }
+}
+
+void MainWindow::renameBoard()
+{
+    BoardInfo info = m_boards.board(m_boards.currentBoard());
+    bool ok;
+    QString name = QInputDialog::getText(this, "Rename Board", "Board name:", QLineEdit::Normal, info.name, &ok);
+    if (ok && !name.isEmpty()) {
+        info.name = name;
+        m_boards.updateBoard(info);
+        m_boards.save();
+        setWindowTitle(QString("%1 - FrostWillDo").arg(info.name));
+    }
+}
 
-    for (TodoColumn *column : columns()) {
-        QJsonObject columnObj;
-        columnObj["title"] = column->title();
+void MainWindow::deleteBoard()
+{
+    BoardInfo info = m_boards.board(m_boards.currentBoard());
+    int ret = QMessageBox::question(this, "Delete Board",
+                                    QString("Are you sure you want to delete the board '%1' and all of its todos?")
+                                    .arg(info.name),
+                                    QMessageBox::Yes | QMessageBox::No);
+    if (ret != QMessageBox::Yes) {
+        return;
+    }
 
-        QJsonArray todosArray;
-        for (TodoItem *item : column->todoItems()) {
-            QJsonObject todoObj;
-            todoObj["text"] = item->text();
-            todoObj["checked"] = item->isChecked();
-            todosArray.append(todoObj);
+    //move over to the board used most recently before this one
+    QString next;
+    QDateTime nextOpened;
+    for (const BoardInfo &other : m_boards.boards()) {
+        if (other.id != info.id && (next.isEmpty() || other.lastOpened > nextOpened)) {
+            next = other.id;
+            nextOpened = other.lastOpened;
         }
-        columnObj["todos"] = todosArray;
-        columnsArray.append(columnObj);
     }
+    if (next.isEmpty() || m_loader || m_importer) {
+        return;
+    }
+    openBoard(next);
 
-    root["columns"] = columnsArray;
+    m_boardCache.remove(info.id);
+    for (const QString &suffix : {QString("json"), QString(BinaryBoardFormat::fileSuffix())}) {
+        QString file = m_boards.boardFile(info, suffix);
+        QFile::remove(file);
+        QFile::remove(file + ".journal");
+    }
+    QFile::remove(m_boards.boardFile(info, "archive"));
+    m_boards.removeBoard(info.id);
+    m_boards.save();
+}
 
-    QJsonDocument doc(root);
-    QFile file(m_dataFile);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson());
-        file.close();
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    if (m_importer) {
+        m_importer->cancel(); //a half imported file is not kept
+    }
+    updateBoardInfo(); //counts shown in the switcher next time
+    if (m_storage) {
+        m_storage->fold(); //no journal is left for a replaced file to strand
     }
+    QMainWindow::closeEvent(event);
 }
 
 void MainWindow::loadData()
 {
-    QFile file(m_dataFile);
-    if (!file.open(QIODevice::ReadOnly)) {
-        //create default columns if no save file exists
-        TodoColumn *todoColumn = new TodoColumn("To Do", this);
-        TodoColumn *doingColumn = new TodoColumn("Doing", this);
-        TodoColumn *doneColumn = new TodoColumn("Done", this);
+    m_firstRun = !m_storage->exists();
+
+    //empty columns from the titles the index keeps, painted while the file is read
+    const QStringList titles = m_boards.board(m_boards.currentBoard()).columnTitles;
+    if (!m_firstRun && !titles.isEmpty()) {
+        BoardData skeleton;
+        for (const QString &title : titles) {
+            BoardColumnData column;
+            column.title = title;
+            skeleton.columns.append(column);
+        }
+        m_model->setBoardData(skeleton);
+    }
+
+    //the window shows up right away, the board fills in while it is visible
+    m_loader = new BoardLoader(m_storage, m_model, this);
+    m_loader->setVisibilityCheck([this](int column) { return isColumnVisible(column); });
+    connect(m_loader, &BoardLoader::columnsReady, this, &MainWindow::onColumnsReady);
+    connect(m_loader, &BoardLoader::columnLoaded, this, &MainWindow::onColumnLoaded);
+    connect(m_loader, &BoardLoader::finished, this, &MainWindow::onLoadFinished);
+    m_loader->start();
+    m_columnStrip->refreshLoading(); //the skeleton takes no edits until its todos are in
+}
+
+void MainWindow::onColumnsReady()
+{
+    m_columnStrip->refreshLoading();
+}
 
-        m_columnsLayout->insertWidget(m_columnsLayout->count() - 1, todoColumn);
-        m_columnsLayout->insertWidget(m_columnsLayout->count() - 1, doingColumn);
-        m_columnsLayout->insertWidget(m_columnsLayout->count() - 1, doneColumn);
+void MainWindow::onColumnLoaded(int column)
+{
+    if (TodoColumn *widget = columnWidget(column)) {
+        widget->setLoading(false);
+    }
+}
 
-        connect(todoColumn, &TodoColumn::deleteRequested, this, &MainWindow::deleteColumn);
-        connect(doingColumn, &TodoColumn::deleteRequested, this, &MainWindow::deleteColumn);
-        connect(doneColumn, &TodoColumn::deleteRequested, this, &MainWindow::deleteColumn);
+void MainWindow::onLoadFinished()
+{
+    const MergeBase base = m_loader->base();
+    m_loader->deleteLater();
+    m_loader = nullptr;
 
+    if (m_firstRun) {
+        m_model->addDefaultColumns(); //no save file yet
+    }
+    updateBoardInfo();
+    watchBoard(base);
+    autoArchive();
+    processRequests();
+    if (m_startupFinished) {
+        StartupProfile::finish();
+    }
+}
+
+void MainWindow::importTodos()
+{
+    if (m_loader || m_importer) {
+        statusBar()->showMessage("Wait until the board is loaded", 3000);
         return;
     }
+    QString fileName = QFileDialog::getOpenFileName(this, "Import Todos", QString(), BoardImporter::fileFilter());
+    if (!fileName.isEmpty()) {
+        importFile(fileName, 0);
+    }
+}
 
-    QByteArray data = file.readAll();
-    file.close();
+void MainWindow::importFile(const QString &fileName, int column)
+{
+    if (m_loader || m_importer) {
+        return;
+    }
+    //the window takes drops as soon as it is shown, the progress bar and the cancel
+    //button may not be there yet
+    finishStartup();
+
+    m_importer = new BoardImporter(m_model, column, this);
+    connect(m_importer, &BoardImporter::columnStarted, this, [this](int column) {
+        m_importColumns.append(m_model->boardColumnIndex(column));
+        if (TodoColumn *widget = columnWidget(column)) {
+            widget->setLoading(true); //the import appends to its end, nothing may move meanwhile
+        }
+    });
+    connect(m_importer, &BoardImporter::progress, this, [this](qint64 bytesRead, qint64 totalBytes) {
+        m_importProgress->setValue(totalBytes > 0 ? int(bytesRead * 1000 / totalBytes) : 0);
+    });
+    connect(m_importer, &BoardImporter::finished, this, &MainWindow::onImportFinished);
+    connect(m_importer, &BoardImporter::failed, this, &MainWindow::onImportFailed);
+
+    m_importProgress->setValue(0);
+    m_importProgress->show();
+    m_importCancelButton->show();
+    statusBar()->showMessage(QString("Importing %1...").arg(QFileInfo(fileName).fileName()));
+    m_importer->start(fileName);
+}
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    QJsonObject root = doc.object();
-    QJsonArray columnsArray = root["columns"].toArray();
+void MainWindow::onImportFinished(int imported)
+{
+    endImport();
+    statusBar()->showMessage(QString("Imported %1 todos").arg(imported), 5000);
+}
 
-    for (const QJsonValue &columnValue : columnsArray) {
-        QJsonObject columnObj = columnValue.toObject();
-        QString title = columnObj["title"].toString();
+void MainWindow::onImportFailed(const QString &error)
+{
+    endImport();
+    statusBar()->showMessage(error.isEmpty() ? QString("Import cancelled") : QString("Import failed: %1").arg(error), 5000);
+}
 
-        TodoColumn *column = new TodoColumn(title, this);
-        m_columnsLayout->insertWidget(m_columnsLayout->count() - 1, column);
-        connect(column, &TodoColumn::deleteRequested, this, &MainWindow::deleteColumn);
+void MainWindow::onBoardMerged(int changes, const QStringList &conflicts)
+{
+    updateBoardInfo();
+    statusBar()->showMessage(QString("The board file was changed outside, merged %1 changes").arg(changes), 5000);
+    if (conflicts.isEmpty()) {
+        return;
+    }
 
-        QJsonArray todosArray = columnObj["todos"].toArray();
-        for (const QJsonValue &todoValue : todosArray) {
-            QJsonObject todoObj = todoValue.toObject();
-            QString text = todoObj["text"].toString();
-            bool checked = todoObj["checked"].toBool();
+    //not modal, the board stays usable while the list is open
+    QStringList shown = conflicts.mid(0, 10);
+    if (conflicts.size() > shown.size()) {
+        shown.append(QString("and %1 more").arg(conflicts.size() - shown.size()));
+    }
+    QMessageBox *box = new QMessageBox(QMessageBox::Warning, "Board Changed Outside",
+                                       "Some todos were changed both here and in the board file:",
+                                       QMessageBox::Ok, this);
+    box->setInformativeText(shown.join("\n"));
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    box->open();
+}
 
-            column->addTodoItem(text);
-            //set checked state after adding
-            QList<TodoItem*> items = column->todoItems();
-            if (!items.isEmpty()) {
-                items.last()->setChecked(checked);
+void MainWindow::onRemindersDue(const QList<QPersistentModelIndex> &todos)
+{
+    QStringList texts;
+    for (const QPersistentModelIndex &todo : todos) {
+        texts.append(todo.data(Qt::DisplayRole).toString().section('\n', 0, 0));
+    }
+    statusBar()->showMessage(todos.size() == 1 ? QString("Reminder: %1").arg(texts.first())
+                                               : QString("%1 reminders").arg(todos.size()), 10000);
+    QApplication::alert(this);
+
+    //not modal like the merge conflicts, a newer reminder replaces the one still open
+    if (m_reminderBox) {
+        m_reminderBox->close();
+    }
+    QStringList shown = texts.mid(0, 10);
+    if (texts.size() > shown.size()) {
+        shown.append(QString("and %1 more").arg(texts.size() - shown.size()));
+    }
+    m_reminderBox = new QMessageBox(QMessageBox::Information, "Reminder",
+                                    todos.size() == 1 ? QString("This todo is due:") : QString("These todos are due:"),
+                                    QMessageBox::Ok, this);
+    m_reminderBox->setInformativeText(shown.join("\n"));
+    m_reminderBox->setAttribute(Qt::WA_DeleteOnClose);
+    QPushButton *snoozeButton = m_reminderBox->addButton("&Snooze 10 Minutes", QMessageBox::ActionRole);
+    connect(snoozeButton, &QPushButton::clicked, this, [this, todos]() {
+        const qint64 remindAt = QDateTime::currentMSecsSinceEpoch() + 10 * 60000;
+        m_model->beginBatch();
+        for (const QPersistentModelIndex &todo : todos) {
+            if (todo.isValid()) {
+                m_model->setItemReminder(todo.parent().row(), todo.row(), remindAt);
             }
         }
+        m_model->endBatch();
+    });
+    m_reminderBox->open();
+}
+
+void MainWindow::endImport()
+{
+    m_importer->deleteLater(); //the worker may still be winding down
+    m_importer = nullptr;
+    m_importProgress->hide();
+    m_importCancelButton->hide();
+    m_importColumns.clear();
+    m_columnStrip->refreshLoading();
+    updateBoardInfo();
+    processRequests();
+}
+
+void MainWindow::handleRequest(InstanceRequest *request)
+{
+    m_pendingRequests.append(request);
+    processRequests();
+}
+
+void MainWindow::processRequests()
+{
+    //commands need the whole board, and one that waits for a save must not let the next one in;
+    //nor may they move todos while a drag is over them
+    if (m_loader || m_importer || m_handlingRequest || m_columnStrip->isDragging()) {
+        return;
+    }
+    m_handlingRequest = true;
+    while (!m_pendingRequests.isEmpty()) {
+        QPointer<InstanceRequest> request = m_pendingRequests.takeFirst();
+        if (!request) {
+            continue; //the launch went away meanwhile
+        }
+        if (request->type() == InstanceRequest::Activate) {
+            setWindowState((windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
+            show();
+            raise();
+            activateWindow();
+            request->reply(0);
+        } else {
+            runCommand(request);
+        }
+    }
+    m_handlingRequest = false;
+}
+
+void MainWindow::runCommand(InstanceRequest *request)
+{
+    QPointer<InstanceRequest> guard(request);
+    QBuffer output;
+    QBuffer error;
+    output.open(QIODevice::WriteOnly);
+    error.open(QIODevice::WriteOnly);
+    int exitCode;
+    QString edited;
+    {
+        QTextStream out(&output);
+        QTextStream err(&error);
+        BoardCli cli(m_dataPath, &m_boards);
+        cli.setOpenBoard(m_boards.currentBoard(), m_model);
+        cli.setWorkingDirectory(request->workingDirectory());
+        exitCode = cli.run(request->arguments(), request->input(), out, err);
+        edited = cli.editedBoard();
+    }
+
+    //a board edited from its files is out of date in the cache
+    if (!edited.isEmpty() && edited != m_boards.currentBoard()) {
+        m_boardCache.remove(edited);
+    }
+    if (guard) {
+        guard->reply(exitCode, output.data(), error.data());
     }
 }
 
 void MainWindow::autoSave()
 {
+    if (!m_storage->isDirty()) {
+        return; //nothing changed since the last snapshot
+    }
     saveData();
 }
 
@@ -240,13 +946,45 @@ void MainWindow::setupAutoSave()
     m_autoSaveTimer->start();
 }
 
-QList<TodoColumn*> MainWindow::columns() const
+TodoColumn *MainWindow::createColumnWidget(int row)
+{
+    TRACE_SPAN("create column widget");
+    TodoColumn *column = new TodoColumn(m_filter, m_model->boardColumnIndex(row), m_columnStrip);
+    connect(column, &TodoColumn::deleteRequested, this, &MainWindow::deleteColumn);
+    connect(column, &TodoColumn::archiveRequested, this, &MainWindow::archiveTodo);
+    column->installEventFilter(this);
+    return column;
+}
+
+TodoColumn *MainWindow::columnWidget(int row) const
+{
+    return m_columnStrip->columnWidget(row);
+}
+
+bool MainWindow::isColumnVisible(int row) const
 {
-    QList<TodoColumn*> columnList;
-    for (int i = 0; i < m_columnsLayout->count() - 1; ++i) { //-1 to skip the stretch
-        if (TodoColumn *column = qobject_cast<TodoColumn*>(m_columnsLayout->itemAt(i)->widget())) {
-            columnList.append(column);
+    TodoColumn *column = columnWidget(row);
+    return column && !column->visibleRegion().isEmpty();
+}
+
+bool MainWindow::isColumnLoading(int row) const
+{
+    //a column still being filled by the loader or appended to by an import takes no edits
+    if (m_loader && m_loader->isColumnLoading(row)) {
+        return true;
+    }
+    for (const QPersistentModelIndex &index : m_importColumns) {
+        if (index.row() == row) {
+            return true;
         }
     }
-    return columnList;
+    return false;
+}
+
+void MainWindow::onSnapshotSaved(quint64 generation, quint64 sequence, qint64 bytes, qint64 msecs)
+{
+    Q_UNUSED(generation);
+    Q_UNUSED(sequence);
+    updateBoardInfo();
+    m_saveStatusLabel->setText(QString("Saved %1 in %2 ms").arg(locale().formattedDataSize(bytes)).arg(msecs));
 }
@@ -2,15 +2,32 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QHBoxLayout>
 #include <QScrollArea>
 #include <QPushButton>
 #include <QMenuBar>
 #include <QTimer>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
 #include <QDropEvent>
+#include <QPointer>
+#include <QMessageBox>
+#include "boardmodel.h"
+#include "boardfiltermodel.h"
+#include "boardstorage.h"
+#include "boardloader.h"
+#include "boardimporter.h"
+#include "boardwatcher.h"
+#include "boardindex.h"
+#include "boardcache.h"
+#include "boardarchive.h"
+#include "archivedialog.h"
+#include "instanceserver.h"
 #include "todocolumn.h"
+#include "columnstrip.h"
+#include "reminderscheduler.h"
 
 class MainWindow : public QMainWindow
 {
@@ -19,28 +36,105 @@ class MainWindow : public QMainWindow
 public:
     MainWindow(QWidget *parent = nullptr);
 
+public slots:
+    //from a later launch, run once no board is loading or importing
+    void handleRequest(InstanceRequest *request);
+
 protected:
+    bool event(QEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dragMoveEvent(QDragMoveEvent *event) override;
+    void dragLeaveEvent(QDragLeaveEvent *event) override;
     void dropEvent(QDropEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void addColumn();
+    void importTodos();
     void deleteColumn();
+    void archiveTodo(const QList<int> &rows);
+    void archiveDoneTodos();
+    void autoArchive();
+    void showArchive();
+    void restoreArchived(const QList<ArchivedTodo> &todos);
     void saveData();
+    void populateBoardsMenu();
+    void populateThemeMenu();
+    void newBoard();
+    void renameBoard();
+    void deleteBoard();
     void loadData();
     void autoSave();
+    void autoScroll();
+    void setTheme(const QString &name);
+    void onSearchTextChanged(const QString &text);
+    void onColumnsReady();
+    void onColumnLoaded(int column);
+    void onLoadFinished();
+    void onImportFinished(int imported);
+    void onImportFailed(const QString &error);
+    void onBoardMerged(int changes, const QStringList &conflicts);
+    void onRemindersDue(const QList<QPersistentModelIndex> &todos);
+    void onSnapshotSaved(quint64 generation, quint64 sequence, qint64 bytes, qint64 msecs);
+    void finishStartup();
 
 private:
     void setupAutoSave();
-    QList<TodoColumn*> columns() const;
+    void openBoard(const QString &id);
+    void closeBoard();
+    void watchBoard(const MergeBase &base);
+    QString archiveFile() const;
+    //moves what pick returns true for into the archive of the open board
+    int archiveTodos(const std::function<bool(int column, int row, const TodoItem &item)> &pick);
+    void updateBoardInfo();
+    void startAutoScroll();
+    //todos without a column of their own go to column
+    void importFile(const QString &fileName, int column);
+    void endImport();
+    void processRequests();
+    void runCommand(InstanceRequest *request);
+    QString importableFile(const QMimeData *mimeData) const;
     int getColumnDropIndex(const QPoint &pos);
+    TodoColumn *createColumnWidget(int row);
+    TodoColumn *columnWidget(int row) const;
+    bool isColumnVisible(int row) const;
+    bool isColumnLoading(int row) const;
 
+    BoardModel *m_model;
+    BoardFilterModel *m_filter;
+    QString m_dataPath;
+    BoardIndex m_boards;
+    BoardCache m_boardCache;
+    bool m_binaryStorage = false;
+    BoardStorage *m_storage = nullptr;
+    BoardLoader *m_loader = nullptr;
+    QPointer<BoardWatcher> m_watcher; //owned by m_storage
+    BoardImporter *m_importer = nullptr;
+    QList<QPersistentModelIndex> m_importColumns; //columns the import appends to
+    bool m_firstRun = false;
+    QList<QPointer<InstanceRequest>> m_pendingRequests;
+    bool m_handlingRequest = false;
+    bool m_painted = false;
+    bool m_startupQueued = false;
+    bool m_startupFinished = false;
     QScrollArea *m_scrollArea;
-    QWidget *m_centralWidget;
-    QHBoxLayout *m_columnsLayout;
-    QTimer *m_autoSaveTimer;
-    QString m_dataFile;
+    ColumnStrip *m_columnStrip;
+    QTimer *m_autoSaveTimer = nullptr;
+    QTimer *m_autoScrollTimer;
+    QTimer *m_archiveTimer = nullptr;
+    int m_archiveAfterDays = 30; //done todos older than this are archived, 0 keeps them on the board
+    BoardArchive m_archive; //of the open board, one for the session so it knows where the file ends
+    QPointer<ArchiveDialog> m_archiveDialog;
+    ReminderScheduler *m_reminders = nullptr; //created after the first frame
+    QPointer<QMessageBox> m_reminderBox;
+    QLabel *m_saveStatusLabel;
+    QProgressBar *m_importProgress = nullptr; //created after the first frame
+    QPushButton *m_importCancelButton = nullptr;
+    QLineEdit *m_searchEdit;
+    QMenu *m_boardsMenu;
+    QMenu *m_themeMenu;
+    QString m_settingsFile;
 };
 
 #endif
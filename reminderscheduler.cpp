@@ -0,0 +1,153 @@
+#include "reminderscheduler.h"
+#include <QDateTime>
+#include <QSet>
+#include "tracer.h"
+
+namespace {
+const qint64 Tick = 1000;         //reminders come on the second
+const qint64 MaxSleep = 3600000;  //wakes at least hourly, a system clock set meanwhile is caught up with
+}
+
+ReminderScheduler::ReminderScheduler(BoardModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_wheel(QDateTime::currentMSecsSinceEpoch(), Tick)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer); //a coarse timer may be minutes late on an hour
+    connect(&m_timer, &QTimer::timeout, this, &ReminderScheduler::onTimeout);
+
+    connect(m_model, &BoardModel::rowsInserted, this, &ReminderScheduler::onRowsInserted);
+    connect(m_model, &BoardModel::rowsAboutToBeRemoved, this, &ReminderScheduler::onRowsAboutToBeRemoved);
+    connect(m_model, &BoardModel::dataChanged, this, &ReminderScheduler::onDataChanged);
+    connect(m_model, &BoardModel::modelReset, this, &ReminderScheduler::rebuild);
+
+    rebuild();
+}
+
+int ReminderScheduler::scheduledCount() const
+{
+    return m_wheel.size();
+}
+
+void ReminderScheduler::rebuild()
+{
+    TRACE_SPAN("schedule reminders");
+    m_wheel.clear(QDateTime::currentMSecsSinceEpoch());
+    for (int column = 0; column < m_model->boardColumnCount(); ++column) {
+        for (int row = 0; row < m_model->itemCount(column); ++row) {
+            scheduleItem(column, row);
+        }
+    }
+    rearm();
+}
+
+void ReminderScheduler::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid()) {
+        for (int column = first; column <= last; ++column) {
+            for (int row = 0; row < m_model->itemCount(column); ++row) {
+                scheduleItem(column, row);
+            }
+        }
+    } else {
+        for (int row = first; row <= last; ++row) {
+            scheduleItem(parent.row(), row);
+        }
+    }
+    rearm();
+}
+
+void ReminderScheduler::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid()) {
+        for (int column = first; column <= last; ++column) {
+            for (int row = 0; row < m_model->itemCount(column); ++row) {
+                m_wheel.cancel(m_model->itemId(column, row));
+            }
+        }
+    } else {
+        for (int row = first; row <= last; ++row) {
+            m_wheel.cancel(m_model->itemId(parent.row(), row));
+        }
+    }
+    rearm();
+}
+
+void ReminderScheduler::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    const QModelIndex parent = topLeft.parent();
+    if (!parent.isValid()) {
+        return; //column titles
+    }
+    if (!roles.isEmpty() && !roles.contains(BoardModel::DueAtRole) && !roles.contains(Qt::CheckStateRole)) {
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        scheduleItem(parent.row(), row);
+    }
+    rearm();
+}
+
+void ReminderScheduler::scheduleItem(int column, int row)
+{
+    //runs for every todo on a reset, so nothing but the id, flags and schedule is read
+    const quint64 id = m_model->itemId(column, row);
+    const qint64 remindAt = m_model->isItemChecked(column, row) ? 0 : m_model->itemRemindAt(column, row);
+    if (remindAt > 0) {
+        m_wheel.schedule(id, remindAt);
+    } else {
+        m_wheel.cancel(id);
+    }
+}
+
+void ReminderScheduler::rearm()
+{
+    const qint64 wake = m_wheel.nextWake();
+    if (wake < 0) {
+        m_timer.stop();
+        return;
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_timer.start(int(qBound<qint64>(0, wake - now, MaxSleep)));
+}
+
+void ReminderScheduler::onTimeout()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QList<quint64> due = m_wheel.advance(now);
+    if (due.isEmpty()) {
+        rearm();
+        return;
+    }
+
+    TRACE_SPAN("reminders due");
+    //one walk over the board for everything that came up at once
+    QSet<quint64> ids(due.begin(), due.end());
+    QList<QPersistentModelIndex> todos;
+    m_model->beginBatch();
+    for (int column = 0; column < m_model->boardColumnCount() && !ids.isEmpty(); ++column) {
+        for (int row = 0; row < m_model->itemCount(column) && !ids.isEmpty(); ++row) {
+            if (!ids.remove(m_model->itemId(column, row))) {
+                continue;
+            }
+            todos.append(m_model->index(row, 0, m_model->boardColumnIndex(column)));
+
+            //the next one after now, reminders missed while the machine slept are not made up for
+            qint64 next = 0;
+            const int repeatMinutes = m_model->itemRepeatMinutes(column, row);
+            if (repeatMinutes > 0) {
+                const qint64 remindAt = m_model->itemRemindAt(column, row);
+                const qint64 every = qint64(repeatMinutes) * 60000;
+                next = remindAt + ((now - remindAt) / every + 1) * every;
+            }
+            m_model->setItemReminder(column, row, next); //reschedules through dataChanged
+        }
+    }
+    m_model->endBatch();
+    rearm();
+
+    if (!todos.isEmpty()) {
+        emit remindersDue(todos);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef REMINDERSCHEDULER_H
+#define REMINDERSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QPersistentModelIndex>
+#include "boardmodel.h"
+#include "timerwheel.h"
+
+//the next reminder of every open todo on the board, kept in one TimerWheel by todo
+//id and woken by a single timer that sleeps until something is due (or the wheel
+//has to pour a coarser slot); follows the model, so moves cost nothing and edits
+//only touch the todos they change
+class ReminderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReminderScheduler(BoardModel *model, QObject *parent = nullptr);
+
+    int scheduledCount() const;
+
+signals:
+    //todos whose reminder came up, indexes of the board model; by now a repeating
+    //one waits for its next reminder and the others for none
+    void remindersDue(const QList<QPersistentModelIndex> &todos);
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void rebuild();
+    void onTimeout();
+
+private:
+    void scheduleItem(int column, int row);
+    void rearm();
+
+    BoardModel *m_model;
+    TimerWheel m_wheel;
+    QTimer m_timer;
+};
+
+#endif
@@ -0,0 +1,236 @@
+#include "searchindex.h"
+#include "boardmodel.h"
+#include <algorithm>
+
+namespace {
+//past this share of dead postings the index is rebuilt from the model
+const double MaxStaleRatio = 0.5;
+}
+
+SearchIndex::SearchIndex(BoardModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    connect(m_model, &BoardModel::rowsInserted, this, &SearchIndex::onRowsInserted);
+    connect(m_model, &BoardModel::rowsAboutToBeRemoved, this, &SearchIndex::onRowsAboutToBeRemoved);
+    connect(m_model, &BoardModel::rowsRemoved, this, &SearchIndex::compactIfNeeded);
+    connect(m_model, &BoardModel::dataChanged, this, &SearchIndex::onDataChanged);
+    connect(m_model, &BoardModel::modelReset, this, &SearchIndex::rebuild);
+    rebuild();
+}
+
+QList<quint64> SearchIndex::trigrams(QStringView text)
+{
+    const QString folded = text.toString().toCaseFolded();
+    QList<quint64> result;
+    if (folded.size() < 3) {
+        return result;
+    }
+    result.reserve(folded.size() - 2);
+    const QChar *c = folded.constData();
+    for (qsizetype i = 0; i + 2 < folded.size(); ++i) {
+        result.append(quint64(c[i].unicode()) << 32 | quint64(c[i + 1].unicode()) << 16 | c[i + 2].unicode());
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QSet<quint64> SearchIndex::search(const QString &text) const
+{
+    const QString folded = text.toCaseFolded();
+    QSet<quint64> result;
+
+    const QList<quint64> grams = trigrams(folded);
+    if (grams.isEmpty()) {
+        //one or two characters, nothing to look up, check every todo
+        for (const Entry &entry : m_entries) {
+            if (entry.id != 0 && contains(entry, folded)) {
+                result.insert(entry.id);
+            }
+        }
+        return result;
+    }
+
+    //candidates come from the rarest trigram, the text check drops false positives
+    const QList<quint32> *smallest = nullptr;
+    for (quint64 gram : grams) {
+        auto it = m_postings.constFind(gram);
+        if (it == m_postings.constEnd()) {
+            return result; //a trigram nobody has, no match at all
+        }
+        if (!smallest || it->size() < smallest->size()) {
+            smallest = &*it;
+        }
+    }
+    for (quint32 slot : *smallest) {
+        const Entry &entry = m_entries.at(slot);
+        if (entry.id != 0 && contains(entry, folded)) {
+            result.insert(entry.id);
+        }
+    }
+    return result;
+}
+
+QSet<quint64> SearchIndex::refine(const QSet<quint64> &matches, const QString &text) const
+{
+    const QString folded = text.toCaseFolded();
+    QSet<quint64> result;
+    for (quint64 id : matches) {
+        auto slot = m_slots.constFind(id);
+        if (slot != m_slots.constEnd() && contains(m_entries.at(*slot), folded)) {
+            result.insert(id);
+        }
+    }
+    return result;
+}
+
+bool SearchIndex::matches(quint64 id, const QString &text) const
+{
+    auto slot = m_slots.constFind(id);
+    return slot != m_slots.constEnd() && contains(m_entries.at(*slot), text.toCaseFolded());
+}
+
+int SearchIndex::size() const
+{
+    return m_slots.size();
+}
+
+void SearchIndex::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid()) {
+        for (int column = first; column <= last; ++column) {
+            addColumn(column, 0, m_model->itemCount(column) - 1);
+        }
+        return;
+    }
+    addColumn(parent.row(), first, last);
+}
+
+void SearchIndex::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid()) {
+        for (int column = first; column <= last; ++column) {
+            for (int row = 0; row < m_model->itemCount(column); ++row) {
+                remove(m_model->itemId(column, row));
+            }
+        }
+        return;
+    }
+    for (int row = first; row <= last; ++row) {
+        remove(m_model->itemId(parent.row(), row));
+    }
+}
+
+void SearchIndex::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    const QModelIndex parent = topLeft.parent();
+    if (!parent.isValid()) {
+        return; //column titles are not searched
+    }
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole)) {
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        setText(m_model->itemId(parent.row(), row), m_model->itemTextHandle(parent.row(), row));
+    }
+    compactIfNeeded();
+}
+
+void SearchIndex::compactIfNeeded()
+{
+    if (m_stalePostings > m_postingCount * MaxStaleRatio) {
+        rebuild();
+    }
+}
+
+void SearchIndex::rebuild()
+{
+    m_entries.clear();
+    m_freeSlots.clear();
+    m_slots.clear();
+    m_postings.clear();
+    m_postingCount = 0;
+    m_stalePostings = 0;
+
+    for (int column = 0; column < m_model->boardColumnCount(); ++column) {
+        addColumn(column, 0, m_model->itemCount(column) - 1);
+    }
+}
+
+void SearchIndex::addColumn(int column, int first, int last)
+{
+    for (int row = first; row <= last; ++row) {
+        add(m_model->itemId(column, row), m_model->itemTextHandle(column, row));
+    }
+}
+
+bool SearchIndex::contains(const Entry &entry, const QString &folded) const
+{
+    return m_model->textView(entry.text).contains(folded, Qt::CaseInsensitive);
+}
+
+void SearchIndex::add(quint64 id, quint32 text)
+{
+    quint32 slot;
+    if (!m_freeSlots.isEmpty()) {
+        slot = m_freeSlots.takeLast();
+    } else {
+        slot = m_entries.size();
+        m_entries.append(Entry());
+    }
+
+    Entry &entry = m_entries[slot];
+    entry.id = id;
+    entry.text = text;
+    m_slots.insert(id, slot);
+
+    const QList<quint64> grams = trigrams(m_model->textView(text));
+    for (quint64 gram : grams) {
+        m_postings[gram].append(slot);
+    }
+    entry.grams = grams.size();
+    m_postingCount += grams.size();
+}
+
+void SearchIndex::remove(quint64 id)
+{
+    auto it = m_slots.find(id);
+    if (it == m_slots.end()) {
+        return;
+    }
+
+    //the postings stay behind until the next rebuild, a reused slot is
+    //checked against its new text anyway
+    Entry &entry = m_entries[*it];
+    m_stalePostings += entry.grams;
+    entry = Entry();
+    m_freeSlots.append(*it);
+    m_slots.erase(it);
+}
+
+void SearchIndex::setText(quint64 id, quint32 text)
+{
+    auto it = m_slots.constFind(id);
+    if (it == m_slots.constEnd()) {
+        add(id, text);
+        return;
+    }
+
+    Entry &entry = m_entries[*it];
+    if (entry.text == text) {
+        return; //interned, the same text gets the same handle
+    }
+
+    //the old text is already gone from the model, so every trigram of the new one
+    //gets a posting and all the old ones count as stale; a slot listed twice under
+    //a trigram only means one more text check on lookup
+    const QList<quint64> grams = trigrams(m_model->textView(text));
+    for (quint64 gram : grams) {
+        m_postings[gram].append(*it);
+    }
+    m_postingCount += grams.size();
+    m_stalePostings += entry.grams;
+    entry.text = text;
+    entry.grams = grams.size();
+}
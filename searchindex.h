@@ -0,0 +1,66 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QStringView>
+#include <QModelIndex>
+
+class BoardModel;
+
+//trigram index over the text of every todo, kept up to date from the model's
+//signals; moves cost nothing since todos are tracked by id, not position
+class SearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SearchIndex(BoardModel *model, QObject *parent = nullptr);
+
+    //ids of the todos containing text, case insensitive
+    QSet<quint64> search(const QString &text) const;
+    //narrows an earlier result down when the query only got longer
+    QSet<quint64> refine(const QSet<quint64> &matches, const QString &text) const;
+    bool matches(quint64 id, const QString &text) const;
+
+    int size() const;
+
+private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void compactIfNeeded();
+    void rebuild();
+
+private:
+    //the text stays in the model, the entry only knows where
+    struct Entry
+    {
+        quint64 id = 0;
+        quint32 text = 0;  //handle in the model's text buffer
+        quint32 grams = 0; //postings added for the text, they go stale with it
+    };
+
+    static QList<quint64> trigrams(QStringView text);
+
+    bool contains(const Entry &entry, const QString &folded) const;
+    void addColumn(int column, int first, int last);
+    void add(quint64 id, quint32 text);
+    void remove(quint64 id);
+    void setText(quint64 id, quint32 text);
+
+    BoardModel *m_model;
+
+    //postings point at slots, a slot is only trusted after checking its text,
+    //so stale postings left behind by edits and removals are harmless
+    QList<Entry> m_entries;
+    QList<quint32> m_freeSlots;
+    QHash<quint64, quint32> m_slots;
+    QHash<quint64, QList<quint32>> m_postings;
+    qint64 m_postingCount = 0;
+    qint64 m_stalePostings = 0;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "snapshotwriter.h"
+#include "boardstorage.h"
+
+SnapshotWriter::SnapshotWriter(const QString &fileName, QObject *parent)
+    : QObject(parent)
+    , m_fileName(fileName)
+    , m_context(new QObject)
+{
+    m_thread.setObjectName("SnapshotWriter");
+    m_context->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread.start(QThread::LowPriority);
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    //let a running write reach its commit, the journal covers anything still pending
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void SnapshotWriter::write(const BoardSnapshot &snapshot, quint64 generation)
+{
+    if (m_busy) {
+        //only the newest snapshot matters, drop whatever was waiting before
+        if (!m_hasPending) {
+            m_pendingTimer.start();
+        }
+        m_hasPending = true;
+        m_pending = snapshot;
+        m_pendingGeneration = generation;
+        return;
+    }
+
+    m_requestTimer.start();
+    start(snapshot, generation);
+}
+
+bool SnapshotWriter::isBusy() const
+{
+    return m_busy;
+}
+
+void SnapshotWriter::waitForIdle()
+{
+    m_hasPending = false;
+    m_pending = BoardSnapshot();
+    if (m_busy) {
+        //jobs run in order on the thread, an empty one returns once the write is done
+        QMetaObject::invokeMethod(m_context, []() {}, Qt::BlockingQueuedConnection);
+    }
+}
+
+quint64 SnapshotWriter::savedGeneration() const
+{
+    return m_savedGeneration;
+}
+
+qint64 SnapshotWriter::lastLatency() const
+{
+    return m_lastLatency;
+}
+
+qint64 SnapshotWriter::lastBytesWritten() const
+{
+    return m_lastBytesWritten;
+}
+
+void SnapshotWriter::start(const BoardSnapshot &snapshot, quint64 generation)
+{
+    m_busy = true;
+
+    const QString fileName = m_fileName;
+    QMetaObject::invokeMethod(m_context, [this, fileName, snapshot, generation]() {
+        QString error;
+        const qint64 size = BoardStorage::writeSnapshotFile(fileName, snapshot.toBoardData(), &error);
+        const bool ok = size >= 0;
+        const quint64 sequence = snapshot.sequence;
+        QMetaObject::invokeMethod(this, [this, ok, generation, sequence, size, error]() {
+            finish(ok, generation, sequence, size, error);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void SnapshotWriter::finish(bool ok, quint64 generation, quint64 sequence, qint64 bytes, const QString &error)
+{
+    m_busy = false;
+
+    if (ok) {
+        m_savedGeneration = generation;
+        m_lastLatency = m_requestTimer.elapsed();
+        m_lastBytesWritten = bytes;
+        emit saved(generation, sequence, bytes, m_lastLatency);
+    } else {
+        emit saveFailed(generation, error);
+    }
+
+    if (m_hasPending) {
+        m_hasPending = false;
+        m_requestTimer = m_pendingTimer;
+        const BoardSnapshot snapshot = m_pending;
+        m_pending = BoardSnapshot();
+        start(snapshot, m_pendingGeneration);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include <QObject>
+#include <QThread>
+#include <QElapsedTimer>
+#include "boardmodel.h"
+
+//serializes and commits board snapshots on its own thread, requests that come
+//in while a write is running are coalesced so only the newest one gets written
+class SnapshotWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SnapshotWriter(const QString &fileName, QObject *parent = nullptr);
+    ~SnapshotWriter() override;
+
+    //the texts are copied out of snapshot on the writer's thread
+    void write(const BoardSnapshot &snapshot, quint64 generation);
+    bool isBusy() const;
+    //blocks until the running write is committed and drops the one waiting after it,
+    //its report still comes in later
+    void waitForIdle();
+
+    quint64 savedGeneration() const;
+    qint64 lastLatency() const;      //msecs from the request to the committed file
+    qint64 lastBytesWritten() const;
+
+signals:
+    void saved(quint64 generation, quint64 sequence, qint64 bytes, qint64 msecs);
+    void saveFailed(quint64 generation, const QString &error);
+
+private:
+    void start(const BoardSnapshot &snapshot, quint64 generation);
+    void finish(bool ok, quint64 generation, quint64 sequence, qint64 bytes, const QString &error);
+
+    QString m_fileName;
+    QThread m_thread;
+    QObject *m_context; //lives on m_thread, jobs are queued to it
+
+    bool m_busy = false;
+    bool m_hasPending = false;
+    BoardSnapshot m_pending;
+    quint64 m_pendingGeneration = 0;
+    QElapsedTimer m_requestTimer;
+    QElapsedTimer m_pendingTimer;
+
+    quint64 m_savedGeneration = 0;
+    qint64 m_lastLatency = 0;
+    qint64 m_lastBytesWritten = 0;
+};
+
+#endif
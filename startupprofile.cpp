@@ -0,0 +1,86 @@
+#include "startupprofile.h"
+#include <QElapsedTimer>
+#include <QList>
+#include <cstdio>
+#include <cstring>
+#include "tracer.h"
+
+namespace {
+struct Phase
+{
+    const char *name;
+    qint64 endNs; //since start()
+};
+
+QElapsedTimer timer;
+QList<Phase> phases;
+bool enabled = false;
+bool finished = false;
+
+double msecs(qint64 ns)
+{
+    return ns / 1e6;
+}
+
+void printMilestone(const char *name, int budgetMs)
+{
+    for (const Phase &phase : phases) {
+        if (std::strcmp(phase.name, name) == 0) {
+            std::fprintf(stderr, "%s after %.1f ms, budget %d ms%s\n", name, msecs(phase.endNs), budgetMs,
+                         phase.endNs > qint64(budgetMs) * 1000000 ? ", OVER BUDGET" : "");
+            return;
+        }
+    }
+}
+}
+
+void StartupProfile::start()
+{
+    timer.start();
+}
+
+void StartupProfile::setEnabled(bool on)
+{
+    enabled = on;
+}
+
+bool StartupProfile::isEnabled()
+{
+    return enabled;
+}
+
+void StartupProfile::mark(const char *phase)
+{
+    if (finished || !timer.isValid()) {
+        return;
+    }
+    const qint64 end = timer.nsecsElapsed();
+    const qint64 duration = end - (phases.isEmpty() ? 0 : phases.last().endNs);
+    phases.append(Phase{phase, end});
+
+    //phases before tracing was switched on have no place on its clock
+    if (Tracer::isEnabled() && Tracer::now() >= duration) {
+        Tracer::record(phase, Tracer::now() - duration, duration);
+    }
+}
+
+void StartupProfile::finish()
+{
+    if (finished) {
+        return;
+    }
+    mark("interactive");
+    finished = true;
+    if (!enabled) {
+        return;
+    }
+
+    std::fprintf(stderr, "startup profile:\n");
+    qint64 previous = 0;
+    for (const Phase &phase : phases) {
+        std::fprintf(stderr, "  %-24s %8.1f ms %8.1f ms\n", phase.name, msecs(phase.endNs - previous), msecs(phase.endNs));
+        previous = phase.endNs;
+    }
+    printMilestone("first paint", FirstPaintBudgetMs);
+    printMilestone("interactive", InteractiveBudgetMs);
+}
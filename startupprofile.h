@@ -0,0 +1,28 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QtGlobal>
+
+//where startup time goes: phases from main() to the first frame and on to a fully
+//loaded board, checked against the budgets below; --startup-profile prints them to
+//stderr once the board is loaded, and with tracing on they show up in the trace too.
+//GUI thread only
+class StartupProfile
+{
+public:
+    static const int FirstPaintBudgetMs = 100;
+    static const int InteractiveBudgetMs = 300;
+
+    //first thing in main()
+    static void start();
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    //ends the phase running since the previous mark, name has to outlive the
+    //profile, string literals do; "first paint" and "interactive" are the milestones
+    static void mark(const char *phase);
+    //the board is usable, prints the profile, later marks are ignored
+    static void finish();
+};
+
+#endif
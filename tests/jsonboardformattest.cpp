@@ -0,0 +1,171 @@
+#include "jsonboardformattest.h"
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "boardgenerator.h"
+#include "jsonboardformat.h"
+
+Q_DECLARE_METATYPE(BoardData)
+
+namespace {
+//the board the way it was written before there was a writer of its own
+QByteArray referenceJson(const BoardData &data)
+{
+    QJsonArray columns;
+    for (const BoardColumnData &column : data.columns) {
+        QJsonArray todos;
+        for (const TodoItem &item : column.items) {
+            QJsonObject todo;
+            todo["checked"] = item.checked;
+            if (item.checkedAt != 0) {
+                todo["checkedAt"] = item.checkedAt;
+            }
+            if (item.dueAt != 0) {
+                todo["dueAt"] = item.dueAt;
+            }
+            todo["id"] = qint64(item.id);
+            if (item.remindAt != 0) {
+                todo["remindAt"] = item.remindAt;
+            }
+            if (item.repeatMinutes != 0) {
+                todo["repeatMinutes"] = item.repeatMinutes;
+            }
+            todo["text"] = item.text;
+            todos.append(todo);
+        }
+        QJsonObject object;
+        object["title"] = column.title;
+        object["todos"] = todos;
+        columns.append(object);
+    }
+    QJsonObject root;
+    root["columns"] = columns;
+    root["sequence"] = qint64(data.sequence);
+    root["stamp"] = qint64(data.stamp);
+    return QJsonDocument(root).toJson();
+}
+
+//a generated board with ids and the optional fields filled in on some todos,
+//the way load() leaves a board
+BoardData generated(int columns, int items, quint32 seed)
+{
+    BoardGeneratorOptions options;
+    options.columns = columns;
+    options.itemsPerColumn = items;
+    options.seed = seed;
+    BoardData data = BoardGenerator::generate(options);
+
+    quint64 id = 1;
+    for (BoardColumnData &column : data.columns) {
+        for (TodoItem &item : column.items) {
+            item.id = id++;
+            if (item.checked) {
+                item.checkedAt = 1700000000000 + qint64(item.id) * 1000;
+            }
+            if (item.id % 7 == 0) {
+                item.dueAt = 1800000000000 + qint64(item.id);
+                item.remindAt = item.dueAt - 600000;
+            }
+            if (item.id % 21 == 0) {
+                item.repeatMinutes = 1440;
+            }
+        }
+    }
+    data.sequence = id * 3;
+    data.stamp = 0x1fffffffffffff; //the largest a stamp gets
+    return data;
+}
+
+BoardColumnData column(const QString &title, const QStringList &texts)
+{
+    BoardColumnData result;
+    result.title = title;
+    for (const QString &text : texts) {
+        TodoItem item;
+        item.id = quint64(result.items.size() + 1);
+        item.text = text;
+        result.items.append(item);
+    }
+    return result;
+}
+
+void addBoardRows()
+{
+    QTest::addColumn<BoardData>("data");
+
+    QTest::newRow("generated 3x100") << generated(3, 100, 1);
+    QTest::newRow("generated 5x2000") << generated(5, 2000, 7);
+    QTest::newRow("no columns") << BoardData();
+
+    BoardData empty;
+    empty.columns.append(column("To Do", {}));
+    empty.columns.append(column("Doing", {"one"}));
+    empty.columns.append(column("", {}));
+    QTest::newRow("empty columns") << empty;
+
+    //everything the writer escapes or encodes on a path of its own
+    BoardData escapes;
+    escapes.columns.append(column("\"quoted\" \\ title\t", {
+        "",
+        "say \"hi\"",
+        "back\\slash and /slash",
+        "line\nbreak\r\n and \t tab",
+        QString("\b\f") + QChar(0x01) + QChar(0x1f) + QChar(0x7f),
+        QString("nul ") + QChar(0) + " in the middle",
+        "café üß 中文 €",
+        "emoji \U0001F600 and \U0001F680",
+        QString("lone ") + QChar(0xd800) + " high",
+        QString("lone ") + QChar(0xdc00) + " low",
+        QString("swapped ") + QChar(0xdc00) + QChar(0xd800),
+        QString(500, QChar('x')) + "\"",
+    }));
+    QTest::newRow("escapes") << escapes;
+}
+}
+
+void JsonBoardFormatTest::serializeMatchesQJsonDocument_data()
+{
+    addBoardRows();
+}
+
+void JsonBoardFormatTest::serializeMatchesQJsonDocument()
+{
+    QFETCH(BoardData, data);
+    QCOMPARE(JsonBoardFormat::serialize(data), referenceJson(data));
+}
+
+void JsonBoardFormatTest::parseGivesBackTheBoard_data()
+{
+    addBoardRows();
+}
+
+void JsonBoardFormatTest::parseGivesBackTheBoard()
+{
+    QFETCH(BoardData, data);
+
+    BoardData parsed;
+    QVERIFY(JsonBoardFormat::parse(JsonBoardFormat::serialize(data), &parsed));
+    QCOMPARE(parsed.sequence, data.sequence);
+    QCOMPARE(parsed.stamp, data.stamp);
+    QCOMPARE(parsed.columns.size(), data.columns.size());
+    for (int c = 0; c < data.columns.size(); ++c) {
+        const BoardColumnData &want = data.columns.at(c);
+        const BoardColumnData &got = parsed.columns.at(c);
+        QCOMPARE(got.title, want.title);
+        QCOMPARE(got.items.size(), want.items.size());
+        for (int row = 0; row < want.items.size(); ++row) {
+            const TodoItem &a = got.items.at(row);
+            const TodoItem &b = want.items.at(row);
+            QCOMPARE(a.id, b.id);
+            QCOMPARE(a.checked, b.checked);
+            QCOMPARE(a.checkedAt, b.checkedAt);
+            QCOMPARE(a.dueAt, b.dueAt);
+            QCOMPARE(a.remindAt, b.remindAt);
+            QCOMPARE(a.repeatMinutes, b.repeatMinutes);
+            //a surrogate without its partner is only written as an escape, reading
+            //it back gives the same code unit
+            QCOMPARE(a.text, b.text);
+        }
+    }
+}
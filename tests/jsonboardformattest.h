@@ -0,0 +1,19 @@
+#ifndef JSONBOARDFORMATTEST_H
+#define JSONBOARDFORMATTEST_H
+
+#include <QObject>
+
+//the hand written JSON writer against QJsonDocument, which it has to match byte for
+//byte, and the reader against the writer
+class JsonBoardFormatTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void serializeMatchesQJsonDocument_data();
+    void serializeMatchesQJsonDocument();
+    void parseGivesBackTheBoard_data();
+    void parseGivesBackTheBoard();
+};
+
+#endif
@@ -0,0 +1,20 @@
+#include <QtTest>
+#include <QApplication>
+#include "jsonboardformattest.h"
+#include "timerwheeltest.h"
+
+int main(int argc, char *argv[])
+{
+    //no window system needed, like the benchmarks
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    int failed = 0;
+    JsonBoardFormatTest jsonBoardFormat;
+    failed += QTest::qExec(&jsonBoardFormat, argc, argv);
+    TimerWheelTest timerWheel;
+    failed += QTest::qExec(&timerWheel, argc, argv);
+    return failed;
+}
@@ -0,0 +1,21 @@
+QT += widgets testlib
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = tests
+TEMPLATE = app
+
+include(../frostwilldo.pri)
+
+#generated boards come from the benchmarks
+INCLUDEPATH += ../benchmarks
+
+SOURCES += main.cpp \
+           jsonboardformattest.cpp \
+           timerwheeltest.cpp \
+           ../benchmarks/boardgenerator.cpp
+
+HEADERS += jsonboardformattest.h \
+           timerwheeltest.h \
+           ../benchmarks/boardgenerator.h
@@ -0,0 +1,157 @@
+#include "timerwheeltest.h"
+#include <QtTest>
+#include <algorithm>
+#include "timerwheel.h"
+
+namespace {
+const qint64 Tick = 1000;
+
+QList<quint64> sorted(QList<quint64> keys)
+{
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+//ticks on both sides of where each level is poured into the one below, and past
+//the farthest slot of the top level
+void addBoundaryRows()
+{
+    QTest::addColumn<qint64>("start");
+    QTest::addColumn<qint64>("delta");
+
+    const QList<qint64> starts = {0, 37, 64 * 64 - 3};
+    const QList<qint64> deltas = {1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+                                  16777215, 16777216, 16777216 + 5, 3 * 16777216 + 77};
+    for (qint64 start : starts) {
+        for (qint64 delta : deltas) {
+            QTest::addRow("%lld+%lld", start, delta) << start << delta;
+        }
+    }
+}
+}
+
+void TimerWheelTest::dueOnTheirTick_data()
+{
+    addBoundaryRows();
+}
+
+void TimerWheelTest::dueOnTheirTick()
+{
+    QFETCH(qint64, start);
+    QFETCH(qint64, delta);
+
+    TimerWheel wheel(start * Tick, Tick);
+    wheel.schedule(1, (start + delta) * Tick);
+    QCOMPARE(wheel.advance((start + delta) * Tick - 1), QList<quint64>());
+    QVERIFY(wheel.contains(1));
+    QCOMPARE(wheel.advance((start + delta) * Tick), QList<quint64>{1});
+    QCOMPARE(wheel.size(), 0);
+    QCOMPARE(wheel.nextWake(), qint64(-1));
+}
+
+void TimerWheelTest::wakesInTime_data()
+{
+    addBoundaryRows();
+}
+
+void TimerWheelTest::wakesInTime()
+{
+    QFETCH(qint64, start);
+    QFETCH(qint64, delta);
+
+    //driven from one nextWake() to the next the way ReminderScheduler does it, a
+    //wake that comes too late shows up as the key coming due late
+    TimerWheel wheel(start * Tick, Tick);
+    wheel.schedule(1, (start + delta) * Tick);
+    wheel.schedule(2, (start + delta + 1) * Tick);
+    QHash<quint64, qint64> dueTicks;
+    for (int wakes = 0; wheel.size() > 0 && wakes < 100; ++wakes) {
+        const qint64 wake = wheel.nextWake();
+        QVERIFY(wake > 0);
+        QVERIFY(wake <= (start + delta) * Tick || dueTicks.contains(1));
+        for (quint64 key : wheel.advance(wake)) {
+            dueTicks.insert(key, wake / Tick);
+        }
+    }
+    QCOMPARE(dueTicks.value(1), start + delta);
+    QCOMPARE(dueTicks.value(2), start + delta + 1);
+}
+
+void TimerWheelTest::pastDue()
+{
+    TimerWheel wheel(10 * Tick, Tick);
+    wheel.schedule(1, 3 * Tick);
+    wheel.schedule(2, 10 * Tick); //now itself is past as well
+    QCOMPARE(wheel.nextWake(), 11 * Tick);
+    QCOMPARE(wheel.advance(10 * Tick + Tick - 1), QList<quint64>());
+    QCOMPARE(sorted(wheel.advance(11 * Tick)), (QList<quint64>{1, 2}));
+
+    //and once time moved on
+    wheel.schedule(3, 0);
+    QCOMPARE(wheel.advance(12 * Tick), QList<quint64>{3});
+}
+
+void TimerWheelTest::roundsUp()
+{
+    TimerWheel wheel(0, Tick);
+    wheel.schedule(1, 1500);
+    QCOMPARE(wheel.advance(1000), QList<quint64>());
+    QCOMPARE(wheel.advance(2000), QList<quint64>{1});
+}
+
+void TimerWheelTest::cancel()
+{
+    TimerWheel wheel(0, Tick);
+    wheel.schedule(1, 5 * Tick);
+    wheel.schedule(2, 300000 * Tick); //on level 3
+    wheel.cancel(1);
+    wheel.cancel(2);
+    wheel.cancel(3); //never scheduled
+    QCOMPARE(wheel.size(), 0);
+    QCOMPARE(wheel.nextWake(), qint64(-1));
+    QCOMPARE(wheel.advance(400000 * Tick), QList<quint64>());
+}
+
+void TimerWheelTest::cancelFromSharedSlot()
+{
+    //head, middle and tail of a slot's list
+    TimerWheel wheel(0, Tick);
+    for (quint64 key = 1; key <= 5; ++key) {
+        wheel.schedule(key, 7 * Tick);
+    }
+    wheel.cancel(5);
+    wheel.cancel(3);
+    wheel.cancel(1);
+    QCOMPARE(wheel.size(), 2);
+    QCOMPARE(sorted(wheel.advance(7 * Tick)), (QList<quint64>{2, 4}));
+}
+
+void TimerWheelTest::reschedule()
+{
+    TimerWheel wheel(0, Tick);
+    wheel.schedule(1, 100 * Tick);
+    wheel.schedule(1, 5 * Tick); //earlier, out of a level 1 slot into level 0
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(wheel.nextWake(), 5 * Tick);
+    QCOMPARE(wheel.advance(5 * Tick), QList<quint64>{1});
+    QCOMPARE(wheel.advance(100 * Tick), QList<quint64>());
+
+    wheel.schedule(2, 110 * Tick);
+    wheel.schedule(2, 5000 * Tick); //later, it must not come at the old time
+    QCOMPARE(wheel.advance(4999 * Tick), QList<quint64>());
+    QCOMPARE(wheel.advance(5000 * Tick), QList<quint64>{2});
+}
+
+void TimerWheelTest::advanceSkipsAhead()
+{
+    //one call over a long sleep returns everything that came due meanwhile
+    TimerWheel wheel(0, Tick);
+    const QList<qint64> ticks = {1, 64, 4096, 262144, 16777216 + 5};
+    for (int i = 0; i < ticks.size(); ++i) {
+        wheel.schedule(quint64(i + 1), ticks.at(i) * Tick);
+    }
+    wheel.schedule(99, 20000000 * Tick);
+    QCOMPARE(sorted(wheel.advance(17000000 * Tick)), (QList<quint64>{1, 2, 3, 4, 5}));
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(wheel.advance(20000000 * Tick), QList<quint64>{99});
+}
@@ -0,0 +1,25 @@
+#ifndef TIMERWHEELTEST_H
+#define TIMERWHEELTEST_H
+
+#include <QObject>
+
+//the reminder timer wheel: keys come due on their tick, never before and never
+//later, across the points where a coarser level is poured into the finer ones
+class TimerWheelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void dueOnTheirTick_data();
+    void dueOnTheirTick();
+    void wakesInTime_data();
+    void wakesInTime();
+    void pastDue();
+    void roundsUp();
+    void cancel();
+    void cancelFromSharedSlot();
+    void reschedule();
+    void advanceSkipsAhead();
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include "textarena.h"
+#include <QHash>
+
+namespace {
+//short texts are the ones todos repeat, "call mum" on every list; a long note is one of a kind
+//and would only cost a hash of its whole length on every add
+const qsizetype MaxInternedLength = 64;
+const qsizetype MinIndexSize = 64;
+const qsizetype MinCompactUnits = 32 * 1024; //below this the gaps are not worth a copy
+}
+
+TextArena::TextArena()
+{
+    m_slots.append(Slot());
+}
+
+bool TextArena::isInterned(qsizetype length)
+{
+    return length <= MaxInternedLength;
+}
+
+quint32 TextArena::add(QStringView text)
+{
+    if (text.isEmpty()) {
+        return 0;
+    }
+    const bool interned = isInterned(text.size());
+    if (interned) {
+        if (quint32 handle = findInterned(text)) {
+            ++m_slots[handle].refs;
+            return handle;
+        }
+    }
+
+    quint32 handle;
+    if (!m_free.isEmpty()) {
+        handle = m_free.takeLast();
+    } else {
+        handle = m_slots.size();
+        m_slots.append(Slot());
+    }
+    Slot &slot = m_slots[handle];
+    slot.offset = m_units.size();
+    slot.length = text.size();
+    slot.refs = 1;
+    m_units.append(text);
+    if (interned) {
+        insertIndex(handle);
+    }
+    return handle;
+}
+
+void TextArena::release(quint32 handle)
+{
+    if (handle == 0 || handle >= quint32(m_slots.size()) || m_slots.at(handle).refs == 0) {
+        return;
+    }
+    if (--m_slots[handle].refs > 0) {
+        return;
+    }
+    //the index finds the entry by its text, it goes before the text turns into a gap
+    if (isInterned(m_slots.at(handle).length)) {
+        removeIndex(handle);
+    }
+    m_garbage += m_slots.at(handle).length;
+    m_slots[handle] = Slot();
+    m_free.append(handle);
+
+    if (m_garbage >= MinCompactUnits && m_garbage * 2 >= m_units.size()) {
+        compact();
+    }
+}
+
+QString TextArena::text(quint32 handle) const
+{
+    return view(handle).toString();
+}
+
+QStringView TextArena::view(quint32 handle) const
+{
+    const Slot &slot = m_slots.at(handle);
+    return QStringView(m_units).mid(slot.offset, slot.length);
+}
+
+void TextArena::clear()
+{
+    m_units.clear();
+    m_slots.clear();
+    m_slots.append(Slot());
+    m_free.clear();
+    m_index.clear();
+    m_indexed = 0;
+    m_garbage = 0;
+}
+
+qsizetype TextArena::byteSize() const
+{
+    return m_units.size() * qsizetype(sizeof(QChar)) + m_slots.size() * qsizetype(sizeof(Slot))
+           + (m_free.size() + m_index.size()) * qsizetype(sizeof(quint32));
+}
+
+quint32 TextArena::findInterned(QStringView text) const
+{
+    if (m_index.isEmpty()) {
+        return 0;
+    }
+    const qsizetype mask = m_index.size() - 1;
+    for (qsizetype i = qHash(text) & mask; m_index.at(i) != 0; i = (i + 1) & mask) {
+        if (view(m_index.at(i)) == text) {
+            return m_index.at(i);
+        }
+    }
+    return 0;
+}
+
+void TextArena::insertIndex(quint32 handle)
+{
+    //at most half full, so probe runs stay short
+    if ((m_indexed + 1) * 2 > m_index.size()) {
+        const QList<quint32> old = m_index;
+        m_index = QList<quint32>(qMax(MinIndexSize, old.size() * 2), 0);
+        m_indexed = 0;
+        for (quint32 entry : old) {
+            if (entry != 0) {
+                insertIndex(entry);
+            }
+        }
+    }
+    const qsizetype mask = m_index.size() - 1;
+    qsizetype i = qHash(view(handle)) & mask;
+    while (m_index.at(i) != 0) {
+        i = (i + 1) & mask;
+    }
+    m_index[i] = handle;
+    ++m_indexed;
+}
+
+void TextArena::removeIndex(quint32 handle)
+{
+    const qsizetype mask = m_index.size() - 1;
+    qsizetype hole = qHash(view(handle)) & mask;
+    while (m_index.at(hole) != handle) {
+        hole = (hole + 1) & mask;
+    }
+
+    //no tombstones: entries further down the probe run move up into the hole,
+    //unless their own bucket lies between the hole and where they are
+    for (qsizetype i = (hole + 1) & mask; m_index.at(i) != 0; i = (i + 1) & mask) {
+        const qsizetype home = qHash(view(m_index.at(i))) & mask;
+        const bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!stays) {
+            m_index[hole] = m_index.at(i);
+            hole = i;
+        }
+    }
+    m_index[hole] = 0;
+    --m_indexed;
+}
+
+void TextArena::compact()
+{
+    QString units;
+    units.reserve(m_units.size() - m_garbage);
+    for (Slot &slot : m_slots) {
+        if (slot.refs == 0) {
+            continue;
+        }
+        const quint32 offset = units.size();
+        units.append(QStringView(m_units).mid(slot.offset, slot.length));
+        slot.offset = offset;
+    }
+    m_units = units;
+    m_garbage = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef TEXTARENA_H
+#define TEXTARENA_H
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+//the todo texts of a board packed back to back into one UTF-16 buffer, a todo keeps
+//a 32-bit handle instead of a QString with a heap block of its own. Short texts are
+//interned, todos with the same text share a handle and count as references to it.
+//Handle 0 is the empty text. Released texts leave gaps that are squeezed out once
+//they make up half the buffer, handles stay the same through that
+class TextArena
+{
+public:
+    TextArena();
+
+    //one more reference to text, which must not point into the arena itself
+    quint32 add(QStringView text);
+    void release(quint32 handle);
+
+    //a copy that owns its memory, the buffer moves as texts are added
+    QString text(quint32 handle) const;
+    //valid until the next add() or release()
+    QStringView view(quint32 handle) const;
+
+    void clear();
+
+    //memory the arena holds, gaps and free slots included
+    qsizetype byteSize() const;
+
+private:
+    struct Slot
+    {
+        quint32 offset = 0;
+        quint32 length = 0;
+        quint32 refs = 0; //0 for a slot waiting on the free list
+    };
+
+    static bool isInterned(qsizetype length);
+    quint32 findInterned(QStringView text) const;
+    void insertIndex(quint32 handle);
+    void removeIndex(quint32 handle);
+    void compact();
+
+    QString m_units;
+    QList<Slot> m_slots;    //by handle, slot 0 is the empty text
+    QList<quint32> m_free;  //slots of released texts, handed out again first
+    QList<quint32> m_index; //open addressing over the interned handles, 0 for an empty bucket
+    qsizetype m_indexed = 0;
+    qsizetype m_garbage = 0; //units of released texts still taking up room in m_units
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "textlayoutcache.h"
+#include <QFontMetrics>
+#include <QTextLayout>
+#include <QtConcurrent/QtConcurrentMap>
+#include "boarddata.h"
+#include "tracer.h"
+
+namespace {
+const int MaxCachedLayouts = 100000;
+const int ParallelThreshold = 256; //below this the thread hand-off costs more than it saves
+}
+
+TextLayoutCache *TextLayoutCache::instance()
+{
+    static TextLayoutCache cache;
+    return &cache;
+}
+
+TextLayoutCache::TextLayoutCache()
+    : m_cache(MaxCachedLayouts)
+{
+}
+
+TextLayout TextLayoutCache::layout(const QString &text, const QFont &font, int width)
+{
+    Key key{text, font.key(), width};
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const TextLayout *cached = m_cache.object(key)) {
+            return *cached;
+        }
+    }
+
+    TextLayout result = compute(text, font, width);
+    QMutexLocker locker(&m_mutex);
+    //keys outlive the todos they were made for, none may point into the model's texts
+    m_cache.insert(Key{ownedText(text), key.font, width}, new TextLayout(result));
+    return result;
+}
+
+void TextLayoutCache::prepare(const QStringList &texts, const QFont &font, int width)
+{
+    const QString fontKey = font.key();
+    QStringList missing;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const QString &text : texts) {
+            if (!m_cache.contains(Key{text, fontKey, width})) {
+                missing.append(text);
+            }
+        }
+    }
+    if (missing.isEmpty()) {
+        return;
+    }
+
+    TRACE_SPAN("wrap texts");
+    QList<TextLayout> layouts;
+    if (missing.size() < ParallelThreshold) {
+        layouts.reserve(missing.size());
+        for (const QString &text : missing) {
+            layouts.append(compute(text, font, width));
+        }
+    } else {
+        layouts = QtConcurrent::blockingMapped<QList<TextLayout>>(missing, [font, width](const QString &text) {
+            return compute(text, font, width);
+        });
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < missing.size(); ++i) {
+        m_cache.insert(Key{ownedText(missing.at(i)), fontKey, width}, new TextLayout(layouts.at(i)));
+    }
+}
+
+void TextLayoutCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+TextLayout TextLayoutCache::compute(const QString &text, const QFont &font, int width)
+{
+    QFontMetrics fm(font);
+    TextLayout result;
+    result.lineSpacing = fm.lineSpacing();
+    result.ascent = fm.ascent();
+
+    //QTextLayout only breaks on line separators, not on newlines
+    QString wrapped = text;
+    wrapped.replace(QLatin1Char('\n'), QChar::LineSeparator);
+
+    QTextOption option;
+    option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+    QTextLayout textLayout(wrapped, font);
+    textLayout.setTextOption(option);
+    textLayout.beginLayout();
+    for (QTextLine line = textLayout.createLine(); line.isValid(); line = textLayout.createLine()) {
+        line.setLineWidth(qMax(1, width));
+        result.lines.append(TextLayout::Line{line.textStart(), line.textLength()});
+    }
+    textLayout.endLayout();
+
+    result.height = result.lines.size() * result.lineSpacing;
+    return result;
+}
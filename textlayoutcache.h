@@ -0,0 +1,66 @@
+#ifndef TEXTLAYOUTCACHE_H
+#define TEXTLAYOUTCACHE_H
+
+#include <QCache>
+#include <QFont>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+//word wrapped text, broken into lines once and painted line by line after that
+struct TextLayout
+{
+    struct Line
+    {
+        int start = 0;
+        int length = 0;
+    };
+
+    QList<Line> lines;
+    int lineSpacing = 0;
+    int ascent = 0;
+    int height = 0;
+};
+
+//shared by all columns, keyed by (text, font, width) so a resize back to a
+//width seen before or a second column with the same todo costs nothing; keys
+//keep a text of their own, never one pointing into the model's text buffer
+class TextLayoutCache
+{
+public:
+    static TextLayoutCache *instance();
+
+    TextLayout layout(const QString &text, const QFont &font, int width);
+
+    //lays out every text that is not cached yet, big batches are spread over
+    //the thread pool so a column can be measured in one go before it is shown
+    void prepare(const QStringList &texts, const QFont &font, int width);
+
+    void clear();
+
+private:
+    struct Key
+    {
+        QString text;
+        QString font;
+        int width;
+
+        bool operator==(const Key &other) const
+        {
+            return width == other.width && text == other.text && font == other.font;
+        }
+        friend size_t qHash(const Key &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.text, key.font, key.width);
+        }
+    };
+
+    TextLayoutCache();
+    static TextLayout compute(const QString &text, const QFont &font, int width);
+
+    QMutex m_mutex;
+    QCache<Key, TextLayout> m_cache;
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "theme.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyleFactory>
+#include <QStyleOptionButton>
+
+Theme Theme::dark()
+{
+    Theme theme;
+    theme.name = "Dark";
+    theme.window = QColor("#121212");
+    theme.surface = QColor("#1e1e1e");
+    theme.card = QColor("#2b2b2b");
+    theme.cardHover = QColor("#3d3d3d");
+    theme.border = QColor("#404040");
+    theme.checkBoxBorder = QColor("#606060");
+    theme.text = QColor("#ffffff");
+    theme.mutedText = QColor("#888888");
+    theme.accent = QColor("#4dabf7");
+    theme.accentHover = QColor("#339af0");
+    theme.danger = QColor("#ff6b6b");
+    theme.dangerHover = QColor("#3d1a1a");
+    theme.match = QColor("#7a6314");
+    theme.selection = QColor("#1d3b53");
+    return theme;
+}
+
+Theme Theme::light()
+{
+    Theme theme;
+    theme.name = "Light";
+    theme.window = QColor("#f1f3f5");
+    theme.surface = QColor("#ffffff");
+    theme.card = QColor("#f8f9fa");
+    theme.cardHover = QColor("#e9ecef");
+    theme.border = QColor("#dee2e6");
+    theme.checkBoxBorder = QColor("#adb5bd");
+    theme.text = QColor("#212529");
+    theme.mutedText = QColor("#868e96");
+    theme.accent = QColor("#228be6");
+    theme.accentHover = QColor("#1c7ed6");
+    theme.danger = QColor("#e03131");
+    theme.dangerHover = QColor("#ffe3e3");
+    theme.match = QColor("#ffec99");
+    theme.selection = QColor("#d0ebff");
+    return theme;
+}
+
+QPalette Theme::palette() const
+{
+    QPalette palette;
+    palette.setColor(QPalette::Window, window);
+    palette.setColor(QPalette::WindowText, text);
+    palette.setColor(QPalette::Base, surface);
+    palette.setColor(QPalette::AlternateBase, card);
+    palette.setColor(QPalette::Text, text);
+    palette.setColor(QPalette::PlaceholderText, mutedText);
+    palette.setColor(QPalette::Button, card);
+    palette.setColor(QPalette::ButtonText, text);
+    palette.setColor(QPalette::BrightText, danger);
+    palette.setColor(QPalette::Highlight, accent);
+    palette.setColor(QPalette::HighlightedText, Qt::white);
+    palette.setColor(QPalette::ToolTipBase, surface);
+    palette.setColor(QPalette::ToolTipText, text);
+    palette.setColor(QPalette::Light, cardHover);
+    palette.setColor(QPalette::Midlight, card);
+    palette.setColor(QPalette::Mid, border);
+    palette.setColor(QPalette::Dark, border);
+    palette.setColor(QPalette::Shadow, window);
+    palette.setColor(QPalette::Disabled, QPalette::WindowText, mutedText);
+    palette.setColor(QPalette::Disabled, QPalette::Text, mutedText);
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, mutedText);
+    return palette;
+}
+
+ThemeManager *ThemeManager::instance()
+{
+    static ThemeManager manager;
+    return &manager;
+}
+
+ThemeManager::ThemeManager()
+{
+    m_themes = {Theme::dark(), Theme::light()};
+}
+
+const Theme &ThemeManager::theme() const
+{
+    return m_themes.at(m_current);
+}
+
+QStringList ThemeManager::themeNames() const
+{
+    QStringList names;
+    for (const Theme &theme : m_themes) {
+        names.append(theme.name);
+    }
+    return names;
+}
+
+void ThemeManager::setTheme(const QString &name)
+{
+    for (int i = 0; i < m_themes.size(); ++i) {
+        if (m_themes.at(i).name.compare(name, Qt::CaseInsensitive) == 0) {
+            m_current = i;
+            break;
+        }
+    }
+
+    //a palette change only repaints, unlike a style sheet nothing gets re-polished
+    if (qobject_cast<QApplication*>(QCoreApplication::instance())) {
+        QApplication::setPalette(theme().palette());
+    }
+    emit themeChanged();
+}
+
+ThemeStyle::ThemeStyle()
+    : QProxyStyle(QStyleFactory::create("Fusion"))
+{
+}
+
+void ThemeStyle::drawPrimitive(PrimitiveElement element, const QStyleOption *option,
+                               QPainter *painter, const QWidget *widget) const
+{
+    const Theme &theme = ThemeManager::instance()->theme();
+
+    if (element == PE_PanelButtonCommand && widget) {
+        const QByteArray role = widget->property("themeRole").toByteArray();
+        const bool enabled = option->state & State_Enabled;
+        const bool hovered = enabled && (option->state & State_MouseOver);
+
+        if (role == "accent") {
+            painter->save();
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(!enabled ? theme.border : hovered ? theme.accentHover : theme.accent);
+            painter->drawRoundedRect(QRectF(option->rect), 4, 4);
+            painter->restore();
+            return;
+        }
+        if (role == "danger") {
+            if (hovered) {
+                painter->save();
+                painter->setRenderHint(QPainter::Antialiasing);
+                painter->setPen(Qt::NoPen);
+                painter->setBrush(theme.dangerHover);
+                painter->drawEllipse(QRectF(option->rect));
+                painter->restore();
+            }
+            return;
+        }
+    }
+
+    if (element == PE_PanelStatusBar) {
+        painter->fillRect(option->rect, theme.surface);
+        return;
+    }
+
+    QProxyStyle::drawPrimitive(element, option, painter, widget);
+}
+
+void ThemeStyle::drawControl(ControlElement element, const QStyleOption *option,
+                             QPainter *painter, const QWidget *widget) const
+{
+    const Theme &theme = ThemeManager::instance()->theme();
+
+    const QStyleOptionButton *buttonOption = qstyleoption_cast<const QStyleOptionButton*>(option);
+    if (element == CE_PushButtonLabel && buttonOption && widget) {
+        const QByteArray role = widget->property("themeRole").toByteArray();
+        if (role == "accent" || role == "danger") {
+            QStyleOptionButton button = *buttonOption;
+            button.palette.setColor(QPalette::ButtonText, role == "accent" ? QColor(Qt::white) : theme.danger);
+            QProxyStyle::drawControl(element, &button, painter, widget);
+            return;
+        }
+    }
+
+    if (element == CE_MenuBarEmptyArea) {
+        painter->fillRect(option->rect, theme.surface);
+        return;
+    }
+
+    QProxyStyle::drawControl(element, option, painter, widget);
+}
@@ -0,0 +1,73 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QObject>
+#include <QColor>
+#include <QPalette>
+#include <QProxyStyle>
+
+//colors of one theme, everything painted by hand reads them from here
+struct Theme
+{
+    QString name;
+    QColor window;        //board background
+    QColor surface;       //columns, menu bar, status bar
+    QColor card;          //a single todo
+    QColor cardHover;
+    QColor border;
+    QColor checkBoxBorder;
+    QColor text;
+    QColor mutedText;     //done todos, status messages
+    QColor accent;        //add buttons, checked boxes
+    QColor accentHover;
+    QColor danger;        //delete buttons
+    QColor dangerHover;
+    QColor match;         //behind search hits
+    QColor selection;     //behind selected todos
+
+    static Theme dark();
+    static Theme light();
+
+    //palette for the stock widgets (dialogs, line edits, scroll bars)
+    QPalette palette() const;
+};
+
+//holds the current theme and pushes it to the application, switching only
+//swaps the palette and repaints, no widget gets re-polished
+class ThemeManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ThemeManager *instance();
+
+    const Theme &theme() const;
+    QStringList themeNames() const;
+    void setTheme(const QString &name);
+
+signals:
+    void themeChanged();
+
+private:
+    ThemeManager();
+
+    QList<Theme> m_themes;
+    int m_current = 0;
+};
+
+//buttons tagged with the "themeRole" property ("accent" or "danger") are
+//painted in theme colors, the rest is left to Fusion
+class ThemeStyle : public QProxyStyle
+{
+    Q_OBJECT
+
+public:
+    ThemeStyle();
+
+    void drawPrimitive(PrimitiveElement element, const QStyleOption *option,
+                       QPainter *painter, const QWidget *widget = nullptr) const override;
+    void drawControl(ControlElement element, const QStyleOption *option,
+                     QPainter *painter, const QWidget *widget = nullptr) const override;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "timerwheel.h"
+#include <algorithm>
+
+namespace {
+//the slot bits rotated so bit 0 is the slot at start
+quint64 rotated(quint64 bits, int start)
+{
+    return start == 0 ? bits : (bits >> start) | (bits << (64 - start));
+}
+}
+
+TimerWheel::TimerWheel(qint64 now, qint64 tick)
+    : m_tick(qMax<qint64>(tick, 1))
+{
+    clear(now);
+}
+
+void TimerWheel::clear(qint64 now)
+{
+    std::fill(std::begin(m_heads), std::end(m_heads), -1);
+    std::fill(std::begin(m_occupied), std::end(m_occupied), 0);
+    m_nodes.clear();
+    m_free.clear();
+    m_index.clear();
+    m_current = now / m_tick;
+}
+
+void TimerWheel::schedule(quint64 key, qint64 when)
+{
+    int node = m_index.value(key, -1);
+    if (node >= 0) {
+        unlink(node);
+    } else if (!m_free.isEmpty()) {
+        node = m_free.takeLast();
+    } else {
+        node = m_nodes.size();
+        m_nodes.append(Node());
+    }
+
+    //rounded up, a key never comes due before its time
+    const qint64 tick = when / m_tick + (when % m_tick > 0 ? 1 : 0);
+    m_nodes[node].key = key;
+    m_nodes[node].tick = qMax(tick, m_current + 1);
+    m_index.insert(key, node);
+    link(node);
+}
+
+void TimerWheel::cancel(quint64 key)
+{
+    const int node = m_index.value(key, -1);
+    if (node >= 0) {
+        unlink(node);
+        release(node);
+    }
+}
+
+bool TimerWheel::contains(quint64 key) const
+{
+    return m_index.contains(key);
+}
+
+int TimerWheel::size() const
+{
+    return m_index.size();
+}
+
+QList<quint64> TimerWheel::advance(qint64 now)
+{
+    QList<quint64> due;
+    const qint64 target = now / m_tick;
+    while (m_current < target) {
+        //quiet stretches are skipped, a night asleep is not walked tick by tick
+        const qint64 wake = nextWakeTick();
+        if (wake < 0 || wake > target) {
+            m_current = target;
+            break;
+        }
+        m_current = wake;
+
+        //coarser slots whose time has come move down first, some of theirs may be due now
+        for (int level = 1; level < Levels; ++level) {
+            const int shift = level * SlotBits;
+            if (m_current & ((qint64(1) << shift) - 1)) {
+                break;
+            }
+            for (int node : take(level * Slots + int((m_current >> shift) & (Slots - 1)))) {
+                link(node);
+            }
+        }
+
+        for (int node : take(int(m_current & (Slots - 1)))) {
+            due.append(m_nodes.at(node).key);
+            release(node);
+        }
+    }
+    return due;
+}
+
+qint64 TimerWheel::nextWake() const
+{
+    const qint64 tick = nextWakeTick();
+    return tick < 0 ? -1 : tick * m_tick;
+}
+
+qint64 TimerWheel::nextWakeTick() const
+{
+    qint64 wake = -1;
+    for (int level = 0; level < Levels; ++level) {
+        if (!m_occupied[level]) {
+            continue;
+        }
+        //the first occupied slot after the current one, a level above 0 is
+        //poured at the start of its slot
+        const int shift = level * SlotBits;
+        const qint64 next = (m_current >> shift) + 1;
+        const int distance = qCountTrailingZeroBits(rotated(m_occupied[level], int(next & (Slots - 1))));
+        const qint64 tick = (next + distance) << shift;
+        if (wake < 0 || tick < wake) {
+            wake = tick;
+        }
+    }
+    return wake;
+}
+
+void TimerWheel::link(int node)
+{
+    Node &n = m_nodes[node];
+    const qint64 delta = n.tick - m_current;
+    int level = 0;
+    while (level < Levels - 1 && delta >= (qint64(1) << ((level + 1) * SlotBits))) {
+        ++level;
+    }
+    const int shift = level * SlotBits;
+    qint64 slotTick = n.tick >> shift;
+    if (delta >= (qint64(1) << (Levels * SlotBits))) {
+        slotTick = (m_current >> shift) + Slots; //as far out as the wheel reaches
+    }
+    n.slot = level * Slots + int(slotTick & (Slots - 1));
+    n.prev = -1;
+    n.next = m_heads[n.slot];
+    if (n.next >= 0) {
+        m_nodes[n.next].prev = node;
+    }
+    m_heads[n.slot] = node;
+    m_occupied[level] |= quint64(1) << (n.slot % Slots);
+}
+
+void TimerWheel::unlink(int node)
+{
+    Node &n = m_nodes[node];
+    if (n.prev >= 0) {
+        m_nodes[n.prev].next = n.next;
+    } else {
+        m_heads[n.slot] = n.next;
+        if (n.next < 0) {
+            m_occupied[n.slot / Slots] &= ~(quint64(1) << (n.slot % Slots));
+        }
+    }
+    if (n.next >= 0) {
+        m_nodes[n.next].prev = n.prev;
+    }
+    n.prev = n.next = -1;
+}
+
+void TimerWheel::release(int node)
+{
+    m_index.remove(m_nodes.at(node).key);
+    m_nodes[node].slot = -1;
+    m_free.append(node);
+}
+
+QList<int> TimerWheel::take(int slot)
+{
+    QList<int> nodes;
+    for (int node = m_heads[slot]; node >= 0; node = m_nodes.at(node).next) {
+        nodes.append(node);
+    }
+    m_heads[slot] = -1;
+    m_occupied[slot / Slots] &= ~(quint64(1) << (slot % Slots));
+    return nodes;
+}
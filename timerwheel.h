@@ -0,0 +1,63 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QHash>
+#include <QList>
+#include <QtGlobal>
+
+//hierarchical timer wheel: four levels of 64 slots, a slot being a linked list of
+//the keys due in it. A level 0 slot is one tick wide, every level above is 64 times
+//coarser and is poured into the levels below once time reaches its slot, so
+//scheduling and cancelling cost the same however many keys wait, and advancing
+//only costs the slots it passes. Times beyond the top level wait in its farthest
+//slot and are placed again when it is poured
+class TimerWheel
+{
+public:
+    //times are msecs, tick is the resolution keys come due with
+    explicit TimerWheel(qint64 now = 0, qint64 tick = 1000);
+
+    //schedules key for when, replacing a time it had; a time already past comes
+    //due with the next tick
+    void schedule(quint64 key, qint64 when);
+    void cancel(quint64 key);
+    bool contains(quint64 key) const;
+    int size() const;
+    void clear(qint64 now);
+
+    //moves time forward to now and returns the keys that came due, in no particular order
+    QList<quint64> advance(qint64 now);
+    //when advance() has work next, -1 with nothing scheduled: the earliest due key,
+    //or earlier when a coarser slot has to be poured into the finer ones first
+    qint64 nextWake() const;
+
+private:
+    static const int Levels = 4;
+    static const int SlotBits = 6;
+    static const int Slots = 1 << SlotBits;
+
+    struct Node
+    {
+        quint64 key = 0;
+        qint64 tick = 0;
+        int slot = -1; //level * Slots + index
+        int prev = -1;
+        int next = -1;
+    };
+
+    void link(int node);
+    void unlink(int node);
+    void release(int node);
+    QList<int> take(int slot);
+    qint64 nextWakeTick() const;
+
+    qint64 m_tick;
+    qint64 m_current = 0; //last tick advanced to
+    int m_heads[Levels * Slots];
+    quint64 m_occupied[Levels]; //a bit per slot holding anything
+    QList<Node> m_nodes;
+    QList<int> m_free; //unused entries of m_nodes
+    QHash<quint64, int> m_index; //key to its entry in m_nodes
+};
+
+#endif
@@ -5,22 +5,26 @@
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
 #include <QDropEvent>
+#include <QContextMenuEvent>
+#include <QMenu>
 #include <QMimeData>
 #include <QApplication>
 #include <QDrag>
-
-TodoColumn::TodoColumn(const QString &title, QWidget *parent)
+#include <QPainter>
+#include <QScreen>
+#include <QScrollBar>
+#include <QDateTime>
+#include "duedatedialog.h"
+#include "theme.h"
+#include "tracer.h"
+
+TodoColumn::TodoColumn(BoardFilterModel *filter, const QModelIndex &columnIndex, QWidget *parent)
     : QWidget(parent)
+    , m_model(filter->boardModel())
+    , m_filter(filter)
 {
     setAcceptDrops(true);
-    setFixedWidth(300); //slightly wider for better text display
-    setStyleSheet(
-        "TodoColumn { "
-        "   background-color: #1e1e1e; "
-        "   border: 1px solid #404040; "
-        "   border-radius: 8px; "
-        "}"
-    );
+    setFixedWidth(Width);
 
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(8, 8, 8, 8);
@@ -28,15 +32,23 @@ TodoColumn::TodoColumn(const QString &title, QWidget *parent)
 
     //header with title and buttons
     QHBoxLayout *headerLayout = new QHBoxLayout();
-    m_titleLabel = new QLabel(title, this);
-    m_titleLabel->setStyleSheet("font-weight: bold; font-size: 14px; color: #ffffff; padding: 4px;");
+    m_titleLabel = new QLabel(this);
+    QFont titleFont = m_titleLabel->font();
+    titleFont.setBold(true);
+    titleFont.setPixelSize(14);
+    m_titleLabel->setFont(titleFont);
+    m_titleLabel->setMargin(4);
     m_titleLabel->setWordWrap(true);
     m_titleLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
     m_titleLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
 
     m_deleteButton = new QPushButton("×", this);
     m_deleteButton->setFixedSize(20, 20);
-    m_deleteButton->setStyleSheet("QPushButton { color: #ff6b6b; font-weight: bold; border: none; background-color: transparent; } QPushButton:hover { background-color: #3d1a1a; border-radius: 10px; }");
+    QFont deleteFont = m_deleteButton->font();
+    deleteFont.setBold(true);
+    m_deleteButton->setFont(deleteFont);
+    m_deleteButton->setProperty("themeRole", "danger");
+    m_deleteButton->setAccessibleName("Delete column");
 
     headerLayout->addWidget(m_titleLabel);
     headerLayout->addWidget(m_deleteButton);
@@ -45,37 +57,78 @@ TodoColumn::TodoColumn(const QString &title, QWidget *parent)
 
     //add todo button
     m_addButton = new QPushButton("+ Add Todo", this);
-    m_addButton->setStyleSheet(
-        "QPushButton { "
-        "   background-color: #4dabf7; "
-        "   color: #ffffff; "
-        "   border: none; "
-        "   padding: 8px; "
-        "   border-radius: 4px; "
-        "} "
-        "QPushButton:hover { "
-        "   background-color: #339af0; "
-        "}"
-    );
+    m_addButton->setProperty("themeRole", "accent");
+    m_addButton->setMinimumHeight(32);
     mainLayout->addWidget(m_addButton);
 
-    //scroll area for todo items
-    m_scrollArea = new QScrollArea(this);
-    m_scrollArea->setWidgetResizable(true);
-    m_scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_scrollArea->setStyleSheet("QScrollArea { border: none; background-color: transparent; }");
-
-    m_itemsWidget = new QWidget();
-    m_itemsLayout = new QVBoxLayout(m_itemsWidget);
-    m_itemsLayout->setContentsMargins(0, 0, 0, 0);
-    m_itemsLayout->setSpacing(4);
-    m_itemsLayout->addStretch();
+    //virtualized list of todo items, rows are painted by the delegate
+    m_view = new TodoListView(this);
+    m_delegate = new TodoItemDelegate(m_view);
+    m_view->setItemDelegate(m_delegate);
+    m_view->setModel(m_filter); //shows what the search lets through
+    mainLayout->addWidget(m_view, 1);
+    setColumn(columnIndex);
 
-    m_scrollArea->setWidget(m_itemsWidget);
-    mainLayout->addWidget(m_scrollArea, 1);
+    connect(&m_dragTimer, &QTimer::timeout, this, &TodoColumn::onDragTick);
 
     connect(m_addButton, &QPushButton::clicked, this, &TodoColumn::onAddTodo);
     connect(m_deleteButton, &QPushButton::clicked, this, &TodoColumn::deleteRequested);
+    connect(m_model, &BoardModel::dataChanged, this, &TodoColumn::onDataChanged);
+    connect(ThemeManager::instance(), &ThemeManager::themeChanged, this, qOverload<>(&QWidget::update));
+    connect(m_filter, &BoardFilterModel::searchTextChanged, m_view->viewport(), qOverload<>(&QWidget::update)); //new highlights
+
+    //queued so rows are not removed while the view is still handling the click;
+    //whatever the selection holds goes to the model as one batch
+    connect(m_delegate, &TodoItemDelegate::deleteRequested, this, [this](const QPersistentModelIndex &index) {
+        if (index.isValid()) {
+            removeTodoItem(m_filter->mapToSource(index).row());
+        }
+    }, Qt::QueuedConnection);
+    connect(m_view, &TodoListView::deleteRequested, this, [this](const QList<QPersistentModelIndex> &indexes) {
+        m_model->removeItems(modelRow(), sourceRows(indexes));
+    }, Qt::QueuedConnection);
+    connect(m_view, &TodoListView::checkRequested, this, [this](const QList<QPersistentModelIndex> &indexes, bool checked) {
+        m_model->setItemsChecked(modelRow(), sourceRows(indexes), checked);
+    }, Qt::QueuedConnection);
+    connect(m_view, &TodoListView::moveRequested, this, [this](const QList<QPersistentModelIndex> &indexes, int column) {
+        TRACE_SPAN("move todos");
+        m_model->moveItems(modelRow(), sourceRows(indexes), column, m_model->itemCount(column));
+    }, Qt::QueuedConnection);
+    connect(m_view, &TodoListView::dueDateRequested, this, &TodoColumn::editDueDate, Qt::QueuedConnection);
+    connect(m_view, &TodoListView::snoozeRequested, this, [this](const QList<QPersistentModelIndex> &indexes, int minutes) {
+        const qint64 remindAt = QDateTime::currentMSecsSinceEpoch() + qint64(minutes) * 60000;
+        m_model->beginBatch();
+        for (int row : sourceRows(indexes)) {
+            if (m_model->item(modelRow(), row).dueAt != 0) {
+                m_model->setItemReminder(modelRow(), row, remindAt);
+            }
+        }
+        m_model->endBatch();
+    }, Qt::QueuedConnection);
+    connect(m_view, &TodoListView::dragStarted, this, [this]() {
+        m_dragSource = true;
+    });
+    connect(m_view, &TodoListView::dragFinished, this, [this]() {
+        m_dragSource = false;
+        emit dragFinished();
+    });
+    connect(m_view, &TodoListView::archiveRequested, this, [this](const QList<QPersistentModelIndex> &indexes) {
+        const QList<int> rows = sourceRows(indexes);
+        if (!rows.isEmpty()) {
+            emit archiveRequested(rows);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TodoColumn::setColumn(const QModelIndex &columnIndex)
+{
+    //nothing of the column shown before carries over
+    stopDragFeedback();
+    m_view->selectionModel()->clear();
+    m_view->setRootIndex(m_filter->mapFromSource(columnIndex));
+    m_view->scrollToTop();
+    m_titleLabel->setText(columnIndex.data(Qt::DisplayRole).toString());
+    m_view->setAccessibleName(m_titleLabel->text());
 }
 
 QString TodoColumn::title() const
@@ -85,54 +138,97 @@ QString TodoColumn::title() const
 
 void TodoColumn::setTitle(const QString &title)
 {
-    m_titleLabel->setText(title);
+    m_model->setBoardColumnTitle(modelRow(), title);
 }
 
-void TodoColumn::addTodoItem(const QString &text)
+int TodoColumn::modelRow() const
 {
-    TodoItem *item = new TodoItem(text, this);
-    addTodoItem(item);
+    return m_view->rootIndex().row();
 }
 
-void TodoColumn::addTodoItem(TodoItem *item)
+void TodoColumn::setLoading(bool loading)
 {
-    item->setParent(m_itemsWidget);
-    m_itemsLayout->insertWidget(m_itemsLayout->count() - 1, item);
+    m_loading = loading;
+    m_addButton->setEnabled(!loading);
+    m_view->setEnabled(!loading);
+}
 
-    //connect delete signal
-    connect(item, &TodoItem::deleteRequested, this, [this, item]() {
-        removeTodoItem(item);
-        item->deleteLater();
-    });
+bool TodoColumn::isLoading() const
+{
+    return m_loading;
 }
 
-void TodoColumn::insertTodoItem(int index, TodoItem *item)
+bool TodoColumn::isDragSource() const
 {
-    item->setParent(m_itemsWidget);
-    m_itemsLayout->insertWidget(qMin(index, m_itemsLayout->count() - 1), item);
+    return m_dragSource;
+}
 
-    //connect delete signal
-    connect(item, &TodoItem::deleteRequested, this, [this, item]() {
-        removeTodoItem(item);
-        item->deleteLater();
-    });
+void TodoColumn::addTodoItem(const QString &text, bool checked)
+{
+    TodoItem item;
+    item.text = text;
+    item.checked = checked;
+    addTodoItem(item);
 }
 
-void TodoColumn::removeTodoItem(TodoItem *item)
+void TodoColumn::addTodoItem(const TodoItem &item)
 {
-    m_itemsLayout->removeWidget(item);
-    item->setParent(nullptr);
+    m_model->insertItem(modelRow(), todoCount(), item);
 }
 
-QList<TodoItem*> TodoColumn::todoItems() const
+void TodoColumn::insertTodoItem(int index, const TodoItem &item)
 {
-    QList<TodoItem*> items;
-    for (int i = 0; i < m_itemsLayout->count() - 1; ++i) { //-1 to skip the stretch
-        if (TodoItem *item = qobject_cast<TodoItem*>(m_itemsLayout->itemAt(i)->widget())) {
-            items.append(item);
+    m_model->insertItem(modelRow(), index, item);
+}
+
+void TodoColumn::removeTodoItem(int index)
+{
+    m_model->removeItem(modelRow(), index);
+}
+
+QList<int> TodoColumn::sourceRows(const QList<QPersistentModelIndex> &indexes) const
+{
+    QList<int> rows;
+    rows.reserve(indexes.size());
+    for (const QPersistentModelIndex &index : indexes) {
+        if (index.isValid() && index.parent() == m_view->rootIndex()) {
+            rows.append(m_filter->mapToSource(index).row());
         }
     }
-    return items;
+    return rows;
+}
+
+int TodoColumn::todoCount() const
+{
+    return m_model->itemCount(modelRow());
+}
+
+QList<TodoItem> TodoColumn::todoItems() const
+{
+    return m_model->items(modelRow());
+}
+
+void TodoColumn::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    //rounded panel behind the column, painted directly instead of through a style sheet
+    const Theme &theme = ThemeManager::instance()->theme();
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(theme.border);
+    painter.setBrush(theme.surface);
+    painter.drawRoundedRect(QRectF(rect()).adjusted(0.5, 0.5, -0.5, -0.5), 8, 8);
+}
+
+void TodoColumn::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    //only the title of this column is interesting here, the view handles its rows
+    QModelIndex root = m_view->rootIndex();
+    if (!topLeft.parent().isValid() && topLeft.row() <= root.row() && root.row() <= bottomRight.row()) {
+        m_titleLabel->setText(root.data(Qt::DisplayRole).toString());
+        m_view->setAccessibleName(m_titleLabel->text());
+    }
 }
 
 void TodoColumn::onAddTodo()
@@ -144,56 +240,141 @@ void TodoColumn::onAddTodo()
     }
 }
 
-int TodoColumn::getDropIndex(const QPoint &pos)
+int TodoColumn::viewDropRow(const QPoint &pos) const
 {
     //find the best insertion point based on Y position
-    QPoint scrollAreaPos = m_scrollArea->mapFrom(this, pos);
-    QPoint itemsPos = m_itemsWidget->mapFrom(m_scrollArea, scrollAreaPos);
+    return m_view->dropRowAt(m_view->viewport()->mapFrom(this, pos));
+}
 
-    for (int i = 0; i < m_itemsLayout->count() - 1; ++i) {
-        QWidget *widget = m_itemsLayout->itemAt(i)->widget();
-        if (widget && itemsPos.y() < widget->y() + widget->height() / 2) {
-            return i;
-        }
-    }
-    return m_itemsLayout->count() - 1; //insert before stretch
+int TodoColumn::getDropIndex(const QPoint &pos) const
+{
+    //rows of the view skip todos hidden by the search, the result is a board row
+    return m_filter->sourceRow(modelRow(), viewDropRow(pos));
 }
 
 void TodoColumn::dragEnterEvent(QDragEnterEvent *event)
 {
-    if (event->mimeData()->hasFormat("application/x-todoitem")) {
+    if (!m_loading && event->mimeData()->hasFormat("application/x-todoitem")) {
         event->acceptProposedAction();
+
+        //feedback is refreshed once per frame, not for every mouse move
+        m_dragPosition = event->position().toPoint();
+        qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+        m_dragTimer.setInterval(qMax(8, int(1000 / qMax(refreshRate, 1.0))));
+        m_dragTimer.start();
+        onDragTick();
     }
 }
 
 void TodoColumn::dragMoveEvent(QDragMoveEvent *event)
 {
-    if (event->mimeData()->hasFormat("application/x-todoitem")) {
+    if (!m_loading && event->mimeData()->hasFormat("application/x-todoitem")) {
         event->acceptProposedAction();
+        m_dragPosition = event->position().toPoint();
     }
 }
 
-void TodoColumn::dropEvent(QDropEvent *event)
+void TodoColumn::dragLeaveEvent(QDragLeaveEvent *event)
 {
-    if (event->mimeData()->hasFormat("application/x-todoitem")) {
-        QByteArray itemData = event->mimeData()->data("application/x-todoitem");
-        TodoItem *item = reinterpret_cast<TodoItem*>(itemData.toLongLong());
+    Q_UNUSED(event);
+    stopDragFeedback();
+}
 
-        if (item) {
-            //remove from old parent
-            if (TodoColumn *oldColumn = qobject_cast<TodoColumn*>(item->parent()->parent()->parent())) {
-                oldColumn->removeTodoItem(item);
+void TodoColumn::dropEvent(QDropEvent *event)
+{
+    stopDragFeedback();
+
+    if (!m_loading && event->mimeData()->hasFormat("application/x-todoitem")) {
+        TRACE_SPAN("drop todo");
+        //"id,id,...", found again only now since the board may have changed during the drag
+        QList<quint64> ids;
+        for (const QByteArray &id : event->mimeData()->data("application/x-todoitem").split(',')) {
+            ids.append(id.toULongLong());
+        }
+        const QModelIndexList todos = m_model->itemIndexes(ids);
+
+        //todos moved to another column meanwhile stay where they are now
+        if (!todos.isEmpty()) {
+            const int fromColumn = todos.first().parent().row();
+            QList<int> rows;
+            for (const QModelIndex &todo : todos) {
+                if (todo.parent().row() == fromColumn) {
+                    rows.append(todo.row());
+                }
             }
-
-            //insert at the correct position in this column
-            int dropIndex = getDropIndex(event->position().toPoint());
-            insertTodoItem(dropIndex, item);
+            m_model->moveItems(fromColumn, rows, modelRow(), getDropIndex(event->position().toPoint()));
         }
 
         event->acceptProposedAction();
     }
 }
 
+void TodoColumn::editDueDate(const QList<QPersistentModelIndex> &indexes)
+{
+    QList<int> rows = sourceRows(indexes);
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    //starts from the first todo, what is chosen goes to all of them
+    const TodoItem first = m_model->item(modelRow(), rows.first());
+    DueDateDialog dialog(first.dueAt, first.repeatMinutes, this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    rows = sourceRows(indexes); //the dialog ran its own loop, rows may have moved meanwhile
+    m_model->beginBatch();
+    for (int row : rows) {
+        m_model->setItemSchedule(modelRow(), row, dialog.dueAt(), dialog.repeatMinutes());
+    }
+    m_model->endBatch();
+}
+
+void TodoColumn::contextMenuEvent(QContextMenuEvent *event)
+{
+    if (m_loading) {
+        return;
+    }
+
+    //sorting rewrites the order of the whole column, the search does not narrow it
+    QMenu menu(this);
+    QAction *textAction = menu.addAction("Sort by &Text");
+    QAction *checkedAction = menu.addAction("Sort &Done Last");
+    textAction->setEnabled(todoCount() > 1);
+    checkedAction->setEnabled(todoCount() > 1);
+    QAction *chosen = menu.exec(event->globalPos());
+    if (chosen == textAction) {
+        TRACE_SPAN("sort column");
+        m_model->sortItems(modelRow(), BoardModel::SortByText);
+    } else if (chosen == checkedAction) {
+        TRACE_SPAN("sort column");
+        m_model->sortItems(modelRow(), BoardModel::SortByChecked);
+    }
+}
+
+void TodoColumn::onDragTick()
+{
+    TRACE_SPAN("drag feedback");
+    //scroll while the todo is held near the top or bottom edge of the list
+    const int edge = 32;
+    QPoint viewPos = m_view->viewport()->mapFrom(this, m_dragPosition);
+    QScrollBar *scrollBar = m_view->verticalScrollBar();
+    if (viewPos.y() < edge) {
+        scrollBar->setValue(scrollBar->value() - (edge - qMax(viewPos.y(), 0)) / 2 - 1);
+    } else if (viewPos.y() > m_view->viewport()->height() - edge) {
+        scrollBar->setValue(scrollBar->value() + (viewPos.y() - m_view->viewport()->height() + edge) / 2 + 1);
+    }
+
+    m_view->setDropRow(viewDropRow(m_dragPosition));
+}
+
+void TodoColumn::stopDragFeedback()
+{
+    m_dragTimer.stop();
+    m_view->setDropRow(-1);
+}
+
 void TodoColumn::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton && event->position().y() < 50) { //only drag from header area
@@ -214,7 +395,12 @@ void TodoColumn::mouseMoveEvent(QMouseEvent *event)
     QDrag *drag = new QDrag(this);
     QMimeData *mimeData = new QMimeData;
     mimeData->setText(title());
-    mimeData->setData("application/x-todocolumn", QByteArray::number(reinterpret_cast<quintptr>(this)));
+    //the drop asks this widget for its row, which follows the column through moves
+    //made during the drag; the strip keeps it showing the column until the drag ends
+    mimeData->setData("application/x-todocolumn", title().toUtf8());
     drag->setMimeData(mimeData);
+    m_dragSource = true;
     drag->exec(Qt::MoveAction);
+    m_dragSource = false;
+    emit dragFinished();
 }
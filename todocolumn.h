@@ -6,51 +6,94 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QLineEdit>
-#include <QScrollArea>
 #include <QMouseEvent>
 #include <QDrag>
-#include "todoitem.h"
+#include <QPersistentModelIndex>
+#include <QTimer>
+#include "boardmodel.h"
+#include "boardfiltermodel.h"
+#include "todolistview.h"
+#include "todoitemdelegate.h"
 
 class TodoColumn : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit TodoColumn(const QString &title, QWidget *parent = nullptr);
+    static const int Width = 300; //every column, the board places them from it
+
+    //columnIndex is the column's index in the board model
+    explicit TodoColumn(BoardFilterModel *filter, const QModelIndex &columnIndex, QWidget *parent = nullptr);
+
+    //shows another column of the board, for a widget reused while the board scrolls
+    void setColumn(const QModelIndex &columnIndex);
 
     QString title() const;
     void setTitle(const QString &title);
 
-    void addTodoItem(const QString &text);
-    void addTodoItem(TodoItem *item);
-    void insertTodoItem(int index, TodoItem *item);
-    void removeTodoItem(TodoItem *item);
+    //row of this column inside the board model, todo rows taken and returned
+    //below are board model rows as well, whatever the search hides
+    int modelRow() const;
+
+    //a column still being filled by the loader takes no edits
+    void setLoading(bool loading);
+    bool isLoading() const;
+
+    //true while a drag started from this widget runs, it must not show another
+    //column or go away before that
+    bool isDragSource() const;
+
+    void addTodoItem(const QString &text, bool checked = false);
+    void addTodoItem(const TodoItem &item);
+    void insertTodoItem(int index, const TodoItem &item);
+    void removeTodoItem(int index);
+
+    int todoCount() const;
+    QList<TodoItem> todoItems() const;
 
-    QList<TodoItem*> todoItems() const;
+    //row a todo dropped at pos (in column coordinates) ends up at
+    int getDropIndex(const QPoint &pos) const;
 
 signals:
     void deleteRequested();
+    void archiveRequested(const QList<int> &rows); //rows of the todos inside the board model
+    void dragFinished();
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dragMoveEvent(QDragMoveEvent *event) override;
+    void dragLeaveEvent(QDragLeaveEvent *event) override;
     void dropEvent(QDropEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private slots:
     void onAddTodo();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onDragTick();
+    void editDueDate(const QList<QPersistentModelIndex> &indexes);
 
 private:
-    int getDropIndex(const QPoint &pos);
+    //row of the view (todos the search lets through) a drop at pos lands before
+    int viewDropRow(const QPoint &pos) const;
+    //board rows of todos the view hands out, ones removed in the meantime are left out
+    QList<int> sourceRows(const QList<QPersistentModelIndex> &indexes) const;
+    void stopDragFeedback();
 
+    BoardModel *m_model;
+    BoardFilterModel *m_filter;
     QLabel *m_titleLabel;
     QPushButton *m_addButton;
     QPushButton *m_deleteButton;
-    QVBoxLayout *m_itemsLayout;
-    QWidget *m_itemsWidget;
-    QScrollArea *m_scrollArea;
+    TodoListView *m_view;
+    TodoItemDelegate *m_delegate;
     QPoint m_dragStartPosition;
+    QPoint m_dragPosition; //last position of a todo dragged over this column
+    QTimer m_dragTimer;
+    bool m_loading = false;
+    bool m_dragSource = false;
 };
 
 #endif
@@ -1,47 +1,21 @@
 #ifndef TODOITEM_H
 #define TODOITEM_H
 
-#include <QWidget>
-#include <QLabel>
-#include <QCheckBox>
-#include <QPushButton>
-#include <QHBoxLayout>
-#include <QMouseEvent>
-#include <QEnterEvent>
-#include <QDrag>
-#include <QMimeData>
-#include <QResizeEvent>
+#include <QString>
+#include <QtGlobal>
 
-class TodoItem : public QWidget
+//plain value describing a single todo, the actual storage lives in BoardModel
+struct TodoItem
 {
-    Q_OBJECT
-
-public:
-    explicit TodoItem(const QString &text, QWidget *parent = nullptr);
-
-    QString text() const;
-    void setText(const QString &text);
-
-    bool isChecked() const;
-    void setChecked(bool checked);
-
-signals:
-    void deleteRequested();
-
-protected:
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
-    void enterEvent(QEnterEvent *event) override;
-    void leaveEvent(QEvent *event) override;
-    void resizeEvent(QResizeEvent *event) override;
-
-private:
-    void updateHeight();
-
-    QCheckBox *m_checkBox;
-    QLabel *m_label;
-    QPushButton *m_deleteButton;
-    QPoint m_dragStartPosition;
+    QString text;
+    bool checked = false;
+    quint64 id = 0; //stable while the board is open, handed out by BoardModel
+    qint64 checkedAt = 0; //msecs since epoch when it was checked, 0 while it is open
+    qint64 dueAt = 0; //msecs since epoch it is due, 0 without a due date
+    qint64 remindAt = 0; //msecs since epoch of the next reminder, 0 for none; starts at dueAt, snoozing moves it
+    qint32 repeatMinutes = 0; //reminds again this often until it is done, 0 reminds once
 };
 
+Q_DECLARE_TYPEINFO(TodoItem, Q_RELOCATABLE_TYPE);
+
 #endif
@@ -0,0 +1,212 @@
+#include "todoitemdelegate.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QFontMetrics>
+#include <QDateTime>
+#include "theme.h"
+#include "textlayoutcache.h"
+#include "boardfiltermodel.h"
+#include "boardmodel.h"
+
+namespace {
+const int RowSpacing = 4;     //gap between two todos
+const int CardMargin = 2;
+const int ContentMargin = 8;
+const int ButtonSize = 20;    //checkbox and delete button
+const int MinimumRowHeight = 40;
+const int DueMarkerWidth = 3; //along the left edge of todos with a due date
+
+//painting and measuring ask for every todo in view over and over, they read the
+//text where the model keeps it instead of having a copy made each time
+QString itemText(const QModelIndex &index)
+{
+    if (const BoardFilterModel *filter = qobject_cast<const BoardFilterModel*>(index.model())) {
+        const QStringView text = filter->boardModel()->itemTextView(filter->mapToSource(index));
+        return QString::fromRawData(text.data(), text.size());
+    }
+    return index.data(Qt::DisplayRole).toString();
+}
+}
+
+TodoItemDelegate::TodoItemDelegate(QAbstractItemView *view)
+    : QStyledItemDelegate(view)
+    , m_view(view)
+{
+    //colors are read at paint time, a theme switch is just a repaint
+    connect(ThemeManager::instance(), &ThemeManager::themeChanged, m_view->viewport(), qOverload<>(&QWidget::update));
+}
+
+QRect TodoItemDelegate::cardRect(const QRect &rowRect) const
+{
+    return rowRect.adjusted(CardMargin, CardMargin, -CardMargin, -CardMargin - RowSpacing);
+}
+
+QRect TodoItemDelegate::checkBoxRect(const QRect &rowRect) const
+{
+    QRect card = cardRect(rowRect);
+    return QRect(rowRect.left() + ContentMargin, card.center().y() - ButtonSize / 2, ButtonSize, ButtonSize);
+}
+
+QRect TodoItemDelegate::textRect(const QRect &rowRect) const
+{
+    QRect card = cardRect(rowRect);
+    int left = rowRect.left() + ContentMargin + ButtonSize + ContentMargin;
+    int right = rowRect.right() - ContentMargin - ButtonSize - ContentMargin;
+    return QRect(QPoint(left, card.top() + 4), QPoint(right, card.bottom() - 4));
+}
+
+QRect TodoItemDelegate::deleteButtonRect(const QRect &rowRect) const
+{
+    QRect card = cardRect(rowRect);
+    return QRect(rowRect.right() - ContentMargin - ButtonSize + 1, card.center().y() - ButtonSize / 2, ButtonSize, ButtonSize);
+}
+
+void TodoItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const bool hovered = option.state & QStyle::State_MouseOver;
+    const bool focused = (option.state & QStyle::State_HasFocus) && m_view->hasFocus();
+    const bool selected = option.state & QStyle::State_Selected;
+    const bool checked = index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+    const qint64 dueAt = checked ? 0 : index.data(BoardModel::DueAtRole).toLongLong();
+    const bool overdue = dueAt != 0 && dueAt <= QDateTime::currentMSecsSinceEpoch();
+    const Theme &theme = ThemeManager::instance()->theme();
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    //card background, tinted while selected and outlined in red once overdue
+    painter->setPen(overdue ? theme.danger : focused || selected ? theme.accent : theme.border);
+    painter->setBrush(selected ? theme.selection : hovered ? theme.cardHover : theme.card);
+    painter->drawRoundedRect(QRectF(cardRect(option.rect)).adjusted(0.5, 0.5, -0.5, -0.5), 4, 4);
+
+    //open todos with a due date carry a marker, red once it has passed
+    if (dueAt != 0) {
+        QRect card = cardRect(option.rect);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(overdue ? theme.danger : theme.accent);
+        painter->drawRoundedRect(QRectF(card.left() + 1, card.top() + 4, DueMarkerWidth, card.height() - 8), 1.5, 1.5);
+    }
+
+    //checkbox indicator
+    QRect box = checkBoxRect(option.rect).adjusted(3, 3, -3, -3);
+    painter->setPen(checked ? theme.accent : theme.checkBoxBorder);
+    painter->setBrush(checked ? theme.accent : theme.card);
+    painter->drawRect(box);
+
+    //text, struck through once done
+    QFont font = option.font;
+    font.setStrikeOut(checked);
+    painter->setFont(font);
+    painter->setPen(checked ? theme.mutedText : theme.text);
+    const BoardFilterModel *filter = qobject_cast<const BoardFilterModel*>(index.model());
+    drawText(painter, textRect(option.rect), option.font, itemText(index),
+             filter ? filter->searchText() : QString());
+
+    //delete button only shows up on hover or for the todo the keyboard is on
+    if (hovered || focused) {
+        QRect button = deleteButtonRect(option.rect);
+        QFont buttonFont = option.font;
+        buttonFont.setBold(true);
+        painter->setFont(buttonFont);
+        painter->setPen(theme.danger);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawText(button, Qt::AlignCenter, "×");
+    }
+
+    painter->restore();
+}
+
+QSize TodoItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    int width = m_view->viewport()->width();
+    int height = MinimumRowHeight;
+    if (textWidth(width) > 0) {
+        //cached, so relaying out a column only wraps todos it has not seen at this width
+        TextLayout layout = TextLayoutCache::instance()->layout(itemText(index),
+                                                                option.font, textWidth(width));
+        height = qMax(MinimumRowHeight, layout.height + 16); //16 for margins
+    }
+    return QSize(width, height + RowSpacing);
+}
+
+int TodoItemDelegate::textWidth(int rowWidth)
+{
+    return rowWidth - 2 * (ContentMargin + ButtonSize + ContentMargin);
+}
+
+void TodoItemDelegate::drawText(QPainter *painter, const QRect &rect, const QFont &font, const QString &text,
+                                const QString &highlight) const
+{
+    //the wrapping was done when the row was measured with font (the painter may
+    //hold a struck out copy), painting just draws the lines
+    TextLayout layout = TextLayoutCache::instance()->layout(text, font, rect.width());
+
+    QList<int> hits;
+    if (!highlight.isEmpty()) {
+        for (int at = text.indexOf(highlight, 0, Qt::CaseInsensitive); at >= 0;
+             at = text.indexOf(highlight, at + highlight.size(), Qt::CaseInsensitive)) {
+            hits.append(at);
+        }
+    }
+    QFontMetrics fm(font);
+    const QColor matchColor = ThemeManager::instance()->theme().match;
+
+    int y = rect.top() + qMax(0, (rect.height() - layout.height) / 2) + layout.ascent;
+    for (const TextLayout::Line &line : layout.lines) {
+        if (y - layout.ascent > rect.bottom()) {
+            break;
+        }
+        QString lineText = text.mid(line.start, line.length);
+        while (!lineText.isEmpty() && lineText.back().isSpace()) {
+            lineText.chop(1);
+        }
+
+        //search hits get a marker behind the part of them on this line
+        for (int hit : hits) {
+            int from = qMax(hit, line.start) - line.start;
+            int to = qMin(hit + int(highlight.size()), line.start + int(lineText.size())) - line.start;
+            if (from < to) {
+                int left = fm.horizontalAdvance(lineText.left(from));
+                int right = fm.horizontalAdvance(lineText.left(to));
+                painter->fillRect(QRect(rect.left() + left, y - layout.ascent, right - left, layout.lineSpacing), matchColor);
+            }
+        }
+
+        painter->drawText(QPoint(rect.left(), y), lineText);
+        y += layout.lineSpacing;
+    }
+}
+
+bool TodoItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                   const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() != QEvent::MouseButtonPress
+        && event->type() != QEvent::MouseButtonRelease
+        && event->type() != QEvent::MouseButtonDblClick) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
+    if (mouseEvent->button() != Qt::LeftButton) {
+        return false;
+    }
+
+    //only the painted buttons take clicks, anywhere else starts a drag
+    QPoint pos = mouseEvent->position().toPoint();
+    if (checkBoxRect(option.rect).contains(pos)) {
+        if (event->type() == QEvent::MouseButtonRelease) {
+            bool checked = index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+            model->setData(index, checked ? Qt::Unchecked : Qt::Checked, Qt::CheckStateRole);
+        }
+        return true;
+    }
+
+    if (deleteButtonRect(option.rect).contains(pos)) {
+        if (event->type() == QEvent::MouseButtonRelease) {
+            emit deleteRequested(QPersistentModelIndex(index));
+        }
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,41 @@
+#ifndef TODOITEMDELEGATE_H
+#define TODOITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QAbstractItemView>
+#include <QPersistentModelIndex>
+
+//paints a todo row (checkbox, wrapped text, hover delete button) so the
+//column never needs a widget per todo
+class TodoItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit TodoItemDelegate(QAbstractItemView *view);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    //width left for the text of a row that is rowWidth wide
+    static int textWidth(int rowWidth);
+
+signals:
+    void deleteRequested(const QPersistentModelIndex &index);
+
+protected:
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+private:
+    QRect cardRect(const QRect &rowRect) const;
+    QRect checkBoxRect(const QRect &rowRect) const;
+    QRect textRect(const QRect &rowRect) const;
+    QRect deleteButtonRect(const QRect &rowRect) const;
+    void drawText(QPainter *painter, const QRect &rect, const QFont &font, const QString &text,
+                  const QString &highlight) const;
+
+    QAbstractItemView *m_view;
+};
+
+#endif
@@ -0,0 +1,367 @@
+#include "todolistview.h"
+#include <algorithm>
+#include <QApplication>
+#include <QContextMenuEvent>
+#include <QDrag>
+#include <QMenu>
+#include <QMimeData>
+#include <QResizeEvent>
+#include <QAbstractProxyModel>
+#include <QPainter>
+#include "boardmodel.h"
+#include "theme.h"
+#include "textlayoutcache.h"
+#include "tracer.h"
+#include "todoitemdelegate.h"
+
+namespace {
+const int RelayoutDelay = 50; //ms without width changes before rows get rewrapped
+const int DropGapHeight = 40; //room for a one line todo
+}
+
+TodoListView::TodoListView(QWidget *parent)
+    : QListView(parent)
+{
+    //no frame and no background, the column panel shows through
+    setFrameShape(QFrame::NoFrame);
+    viewport()->setAutoFillBackground(false);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setSelectionRectVisible(true);
+    setFocusPolicy(Qt::TabFocus); //clicks go to the painted buttons, the keyboard still gets in
+    //rows only depend on the width, relayout is debounced in resizeEvent
+    setResizeMode(QListView::Fixed);
+    setUniformItemSizes(false);
+    //lay huge columns out in chunks instead of blocking the event loop
+    setLayoutMode(QListView::Batched);
+    setBatchSize(500);
+    setMouseTracking(true);
+    viewport()->setAttribute(Qt::WA_Hover);
+
+    m_relayoutTimer.setSingleShot(true);
+    m_relayoutTimer.setInterval(RelayoutDelay);
+    connect(&m_relayoutTimer, &QTimer::timeout, this, &TodoListView::relayout);
+}
+
+QList<QPersistentModelIndex> TodoListView::selectedTodos() const
+{
+    QModelIndexList indexes = selectionModel() ? selectionModel()->selectedIndexes() : QModelIndexList();
+    if (indexes.isEmpty() && currentIndex().isValid()) {
+        indexes.append(currentIndex());
+    }
+    std::sort(indexes.begin(), indexes.end(), [](const QModelIndex &a, const QModelIndex &b) {
+        return a.row() < b.row();
+    });
+
+    QList<QPersistentModelIndex> todos;
+    todos.reserve(indexes.size());
+    for (const QModelIndex &index : std::as_const(indexes)) {
+        todos.append(QPersistentModelIndex(index));
+    }
+    return todos;
+}
+
+void TodoListView::keyPressEvent(QKeyEvent *event)
+{
+    const QList<QPersistentModelIndex> todos = selectedTodos();
+    if (!todos.isEmpty()) {
+        if (event->key() == Qt::Key_Space) {
+            //all of them done, unless they already are
+            bool allChecked = true;
+            for (const QPersistentModelIndex &index : todos) {
+                allChecked = allChecked && index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+            }
+            emit checkRequested(todos, !allChecked);
+            return;
+        }
+        if (event->key() == Qt::Key_Delete) {
+            emit deleteRequested(todos);
+            return;
+        }
+    }
+    QListView::keyPressEvent(event);
+}
+
+void TodoListView::mousePressEvent(QMouseEvent *event)
+{
+    m_keepSelection = false;
+    if (event->button() == Qt::LeftButton) {
+        m_dragStartPosition = event->pos();
+        m_dragIndex = indexAt(event->pos());
+
+        //with shift held a press on a todo starts a rubber band instead of a drag
+        if (event->modifiers() & Qt::ShiftModifier) {
+            m_dragIndex = QPersistentModelIndex();
+        }
+
+        //a plain press on a selected todo leaves the selection alone until it is
+        //clear whether all of it gets dragged, the painted buttons still take it
+        if (m_dragIndex.isValid() && event->modifiers() == Qt::NoModifier
+            && selectionModel()->isSelected(m_dragIndex) && !edit(m_dragIndex, NoEditTriggers, event)) {
+            m_keepSelection = true;
+            return;
+        }
+    }
+    QListView::mousePressEvent(event);
+}
+
+void TodoListView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_keepSelection) {
+        //a click after all, it selects just that todo
+        m_keepSelection = false;
+        const QModelIndex index = indexAt(event->pos());
+        if (index.isValid() && index == m_dragIndex && !edit(index, NoEditTriggers, event)) {
+            selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
+        }
+        m_dragIndex = QPersistentModelIndex();
+        return;
+    }
+    QListView::mouseReleaseEvent(event);
+}
+
+void TodoListView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || !m_dragIndex.isValid()) {
+        QListView::mouseMoveEvent(event);
+        return;
+    }
+    if ((event->pos() - m_dragStartPosition).manhattanLength() < QApplication::startDragDistance())
+        return;
+
+    //a selected todo takes the rest of the selection along
+    QList<QPersistentModelIndex> todos;
+    if (selectionModel()->isSelected(m_dragIndex)) {
+        todos = selectedTodos();
+    } else {
+        todos.append(m_dragIndex);
+    }
+    m_dragIndex = QPersistentModelIndex();
+    m_keepSelection = false;
+
+    QByteArray ids;
+    QStringList texts;
+    for (const QPersistentModelIndex &todo : std::as_const(todos)) {
+        ids += (ids.isEmpty() ? "" : ",") + QByteArray::number(todo.data(BoardModel::ItemIdRole).toULongLong());
+        texts.append(todo.data(Qt::DisplayRole).toString());
+    }
+
+    QDrag *drag = new QDrag(this);
+    QMimeData *mimeData = new QMimeData;
+    mimeData->setText(texts.join('\n'));
+    //ids of the dragged todos, rows may shift while the drag runs its own event loop
+    mimeData->setData("application/x-todoitem", ids);
+    drag->setMimeData(mimeData);
+    emit dragStarted();
+    drag->exec(Qt::MoveAction);
+    emit dragFinished();
+}
+
+void TodoListView::contextMenuEvent(QContextMenuEvent *event)
+{
+    const QModelIndex index = indexAt(event->pos());
+    if (!index.isValid()) {
+        QListView::contextMenuEvent(event);
+        return;
+    }
+
+    //the menu acts on the selection when the todo is part of it, else on the todo alone
+    if (!selectionModel()->isSelected(index)) {
+        selectionModel()->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect);
+    }
+    const QList<QPersistentModelIndex> todos = selectedTodos();
+    const QString suffix = todos.size() > 1 ? QString(" %1 Todos").arg(todos.size()) : QString();
+
+    QMenu menu(this);
+    QAction *checkAction = menu.addAction("&Check" + suffix);
+    QAction *uncheckAction = menu.addAction("&Uncheck" + suffix);
+    QMenu *moveMenu = menu.addMenu("&Move To");
+    const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel*>(model());
+    for (int row = 0; row < model()->rowCount(); ++row) {
+        if (row == rootIndex().row()) {
+            continue;
+        }
+        const QModelIndex columnIndex = model()->index(row, 0);
+        QAction *action = moveMenu->addAction(columnIndex.data(Qt::DisplayRole).toString());
+        action->setData(proxy ? proxy->mapToSource(columnIndex).row() : row);
+    }
+    moveMenu->setEnabled(!moveMenu->isEmpty());
+    menu.addSeparator();
+    QAction *dueAction = menu.addAction("Due &Date...");
+    //only todos with a due date have reminders to put off
+    QMenu *snoozeMenu = menu.addMenu("S&nooze");
+    const QList<QPair<QString, int>> snoozes = {{"10 Minutes", 10}, {"1 Hour", 60}, {"1 Day", 24 * 60}};
+    for (const QPair<QString, int> &snooze : snoozes) {
+        snoozeMenu->addAction(snooze.first)->setData(snooze.second);
+    }
+    bool anyDue = false;
+    for (const QPersistentModelIndex &todo : todos) {
+        anyDue = anyDue || todo.data(BoardModel::DueAtRole).toLongLong() != 0;
+    }
+    snoozeMenu->setEnabled(anyDue);
+    menu.addSeparator();
+    QAction *archiveAction = menu.addAction("&Archive" + suffix);
+    QAction *deleteAction = menu.addAction("&Delete" + suffix);
+    //the menu runs its own loop, rows may be gone once it returns
+    QAction *chosen = menu.exec(event->globalPos());
+    if (!chosen) {
+        return;
+    } else if (chosen == checkAction || chosen == uncheckAction) {
+        emit checkRequested(todos, chosen == checkAction);
+    } else if (chosen == archiveAction) {
+        emit archiveRequested(todos);
+    } else if (chosen == deleteAction) {
+        emit deleteRequested(todos);
+    } else if (chosen == dueAction) {
+        emit dueDateRequested(todos);
+    } else if (chosen->parent() == moveMenu) {
+        emit moveRequested(todos, chosen->data().toInt());
+    } else if (chosen->parent() == snoozeMenu) {
+        emit snoozeRequested(todos, chosen->data().toInt());
+    }
+}
+
+void TodoListView::resizeEvent(QResizeEvent *event)
+{
+    QListView::resizeEvent(event);
+
+    //dragging the window edge only relayouts once it settles, a height change needs none
+    if (event->size().width() != event->oldSize().width()) {
+        m_relayoutTimer.start();
+    }
+}
+
+void TodoListView::relayout()
+{
+    if (!model()) {
+        return;
+    }
+
+    TRACE_SPAN("relayout column");
+    //wrap the whole column in one go (spread over threads when it is big),
+    //the layout pass below then only reads cached heights
+    QStringList texts;
+    const int rows = model()->rowCount(rootIndex());
+    texts.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        texts.append(model()->index(row, 0, rootIndex()).data(Qt::DisplayRole).toString());
+    }
+    TextLayoutCache::instance()->prepare(texts, font(), TodoItemDelegate::textWidth(viewport()->width()));
+
+    scheduleDelayedItemsLayout();
+}
+
+void TodoListView::doItemsLayout()
+{
+    TRACE_SPAN("layout rows");
+    QListView::doItemsLayout();
+}
+
+void TodoListView::setDropRow(int row)
+{
+    if (row == m_dropRow) {
+        return;
+    }
+    //every row below the old or the new gap moves
+    m_dropRow = row;
+    viewport()->update();
+}
+
+int TodoListView::dropRowAt(const QPoint &pos) const
+{
+    if (pos.y() < 0 || !model()) {
+        return 0;
+    }
+
+    //rows below the gap are painted lower than the view lays them out,
+    //and the gap itself keeps the row it was opened for
+    QPoint layoutPos = pos;
+    const QRect gap = dropGapRect();
+    if (gap.isValid() && pos.y() >= gap.top()) {
+        if (pos.y() <= gap.bottom()) {
+            return m_dropRow;
+        }
+        layoutPos.ry() -= DropGapHeight;
+    }
+
+    //indexAt is a binary search over the row offsets the view keeps,
+    //so this stays cheap in huge columns
+    const QModelIndex index = indexAt(layoutPos);
+    if (!index.isValid()) {
+        return model()->rowCount(rootIndex()); //below the last todo
+    }
+    const QRect rect = visualRect(index);
+    return layoutPos.y() < rect.center().y() ? index.row() : index.row() + 1;
+}
+
+QRect TodoListView::dropGapRect() const
+{
+    if (m_dropRow < 0 || !model()) {
+        return QRect();
+    }
+
+    //where the row is laid out, or below the last one
+    const int rows = model()->rowCount(rootIndex());
+    int y = 0;
+    if (m_dropRow < rows) {
+        y = visualRect(model()->index(m_dropRow, 0, rootIndex())).top();
+    } else if (rows > 0) {
+        y = visualRect(model()->index(rows - 1, 0, rootIndex())).bottom() + 1;
+    }
+    return QRect(0, y, viewport()->width(), DropGapHeight);
+}
+
+void TodoListView::paintEvent(QPaintEvent *event)
+{
+    const QRect gap = dropGapRect();
+    if (!gap.isValid()) {
+        QListView::paintEvent(event);
+        return;
+    }
+
+    //the rows above the gap are painted by the list as usual
+    const QRegion above = event->region() & QRect(0, 0, viewport()->width(), gap.top());
+    if (!above.isEmpty()) {
+        QPaintEvent aboveEvent(above);
+        QListView::paintEvent(&aboveEvent);
+    }
+
+    QPainter painter(viewport());
+    painter.setClipRegion(event->region());
+    const Theme &theme = ThemeManager::instance()->theme();
+
+    //the placeholder, outlined like a card
+    if (event->rect().intersects(gap)) {
+        painter.save();
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(theme.accent, 1, Qt::DashLine));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRoundedRect(QRectF(gap.adjusted(2, 2, -2, -6)).adjusted(0.5, 0.5, -0.5, -0.5), 4, 4);
+        painter.restore();
+    }
+
+    //the rows from the gap on, moved down by it; only those reaching into the
+    //update rect, found the same way as for a drop
+    const int rows = model()->rowCount(rootIndex());
+    const QModelIndex firstIndex = indexAt(QPoint(0, event->rect().top() - DropGapHeight));
+    int row = qMax(m_dropRow, firstIndex.isValid() ? firstIndex.row() : m_dropRow);
+    QStyleOptionViewItem option;
+    initViewItemOption(&option);
+    for (; row < rows; ++row) {
+        const QModelIndex index = model()->index(row, 0, rootIndex());
+        const QRect rect = visualRect(index).translated(0, DropGapHeight);
+        if (rect.top() > event->rect().bottom()) {
+            break;
+        }
+        QStyleOptionViewItem rowOption = option;
+        rowOption.rect = rect;
+        if (selectionModel() && selectionModel()->isSelected(index)) {
+            rowOption.state |= QStyle::State_Selected;
+        }
+        if (index == currentIndex() && hasFocus()) {
+            rowOption.state |= QStyle::State_HasFocus;
+        }
+        itemDelegateForIndex(index)->paint(&painter, rowOption, index);
+    }
+}
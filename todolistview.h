@@ -0,0 +1,62 @@
+#ifndef TODOLISTVIEW_H
+#define TODOLISTVIEW_H
+
+#include <QListView>
+#include <QMouseEvent>
+#include <QPersistentModelIndex>
+#include <QTimer>
+
+//list of todos of one column, only rows in the viewport are ever painted;
+//ctrl and shift clicks or a rubber band from empty space (or with shift held)
+//select several todos, space checks and delete removes all of them; the
+//context menu checks, moves, schedules, snoozes, archives or deletes the selection
+class TodoListView : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit TodoListView(QWidget *parent = nullptr);
+
+    //opens a gap before row where a dragged todo would land, the rows from there
+    //on are painted that much lower; -1 closes it
+    void setDropRow(int row);
+    //row a todo dropped at pos (viewport coordinates) lands before, with the gap accounted for
+    int dropRowAt(const QPoint &pos) const;
+
+    void doItemsLayout() override;
+
+    //selected todos, or the current one when nothing is selected, top to bottom
+    QList<QPersistentModelIndex> selectedTodos() const;
+
+signals:
+    void deleteRequested(const QList<QPersistentModelIndex> &indexes);
+    void archiveRequested(const QList<QPersistentModelIndex> &indexes);
+    void checkRequested(const QList<QPersistentModelIndex> &indexes, bool checked);
+    void moveRequested(const QList<QPersistentModelIndex> &indexes, int column); //column of the board model
+    void dueDateRequested(const QList<QPersistentModelIndex> &indexes);
+    void snoozeRequested(const QList<QPersistentModelIndex> &indexes, int minutes);
+    //around the nested event loop of a todo drag started here
+    void dragStarted();
+    void dragFinished();
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void relayout();
+    QRect dropGapRect() const;
+
+    QPoint m_dragStartPosition;
+    QPersistentModelIndex m_dragIndex;
+    bool m_keepSelection = false; //press on a selected todo, it may become a drag of all of them
+    QTimer m_relayoutTimer;
+    int m_dropRow = -1;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "tracer.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <memory>
+
+namespace {
+struct Event
+{
+    std::atomic<quint64> sequence{0}; //index of the write that filled the slot, plus one
+    const char *name = nullptr;
+    qint64 start = 0;
+    qint64 duration = 0;
+    quint32 thread = 0;
+};
+
+QElapsedTimer timer;
+QString outputFile;
+std::unique_ptr<Event[]> events;
+quint64 capacity = 0;
+std::atomic<quint64> nextEvent{0};
+std::atomic<quint32> nextThread{1};
+
+//names only show up once per thread, a lock there is fine
+QMutex threadNamesMutex;
+QHash<quint32, QString> threadNames;
+
+quint32 threadId()
+{
+    thread_local quint32 id = 0;
+    if (id == 0) {
+        id = nextThread.fetch_add(1, std::memory_order_relaxed);
+        QString name = QThread::currentThread()->objectName();
+        if (name.isEmpty()) {
+            name = id == 1 ? QStringLiteral("main") : QString("thread %1").arg(id);
+        }
+        QMutexLocker locker(&threadNamesMutex);
+        threadNames.insert(id, name);
+    }
+    return id;
+}
+
+QByteArray escape(const QByteArray &text)
+{
+    QByteArray out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        if (uchar(c) >= 0x20) {
+            out += c;
+        }
+    }
+    return out;
+}
+}
+
+void Tracer::enable(const QString &fileName, int size)
+{
+    if (isEnabled()) {
+        return;
+    }
+
+    capacity = 1;
+    while (capacity < quint64(qMax(size, 1))) {
+        capacity <<= 1;
+    }
+    events.reset(new Event[capacity]);
+    outputFile = fileName;
+    timer.start();
+    threadId(); //the thread enabling tracing shows up as main
+    s_enabled.store(true, std::memory_order_release);
+}
+
+qint64 Tracer::now()
+{
+    return timer.nsecsElapsed();
+}
+
+void Tracer::record(const char *name, qint64 startNs, qint64 durationNs)
+{
+    //each writer claims its own slot, the sequence tells readers a slot is complete
+    const quint64 index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+    Event &event = events[index & (capacity - 1)];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name = name;
+    event.start = startNs;
+    event.duration = durationNs;
+    event.thread = threadId();
+    event.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool Tracer::dump()
+{
+    return dump(outputFile);
+}
+
+bool Tracer::dump(const QString &fileName)
+{
+    if (!isEnabled() || fileName.isEmpty()) {
+        return false;
+    }
+
+    QByteArray json = "{\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&json, &first]() {
+        if (!first) {
+            json += ",\n";
+        }
+        first = false;
+    };
+
+    {
+        QMutexLocker locker(&threadNamesMutex);
+        for (auto it = threadNames.cbegin(); it != threadNames.cend(); ++it) {
+            separator();
+            json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(it.key())
+                  + ",\"args\":{\"name\":\"" + escape(it.value().toUtf8()) + "\"}}";
+        }
+    }
+
+    //only the last capacity spans survive, older slots were overwritten
+    const quint64 end = nextEvent.load(std::memory_order_acquire);
+    const quint64 begin = end > capacity ? end - capacity : 0;
+    for (quint64 index = begin; index < end; ++index) {
+        const Event &slot = events[index & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            continue; //still being written or already reused
+        }
+        const char *name = slot.name;
+        const qint64 start = slot.start;
+        const qint64 duration = slot.duration;
+        const quint32 thread = slot.thread;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+            continue; //overwritten while copying
+        }
+        separator();
+        json += "{\"name\":\"" + escape(name) + "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+              + QByteArray::number(thread)
+              + ",\"ts\":" + QByteArray::number(start / 1000.0, 'f', 3)
+              + ",\"dur\":" + QByteArray::number(duration / 1000.0, 'f', 3) + "}";
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(json);
+    return file.commit();
+}
@@ -0,0 +1,60 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <atomic>
+
+//timing spans written into a fixed ring buffer by any thread without locks,
+//dumped as a Chrome trace_event file that Perfetto or chrome://tracing open;
+//switched off it costs one relaxed atomic load per span
+class Tracer
+{
+public:
+    //capacity is rounded up to a power of two, the oldest spans get overwritten
+    static void enable(const QString &outputFile, int capacity = 1 << 16);
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static qint64 now();
+    //name has to outlive the tracer, string literals do
+    static void record(const char *name, qint64 startNs, qint64 durationNs);
+
+    //writes to the file given to enable()
+    static bool dump();
+    static bool dump(const QString &fileName);
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(Tracer::isEnabled() ? name : nullptr)
+        , m_start(m_name ? Tracer::now() : 0)
+    {
+    }
+    ~TraceSpan()
+    {
+        if (m_name) {
+            Tracer::record(m_name, m_start, Tracer::now() - m_start);
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+//times the rest of the enclosing scope
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#endif